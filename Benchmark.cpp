@@ -0,0 +1,1975 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <cstdlib>
+#include <numeric>
+#include <memory>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Kernels.hpp"
+#include "ProductQuantizer.hpp"
+#include "Graph.hpp"
+#include "SubgraphMaps.hpp"
+#include "SubgraphExtract.hpp"
+#include "GraphReader.hpp"
+#include "Graph2Vec.hpp"
+#include "GraphEmbedding.hpp"
+#include "WLKernel.hpp"
+#include "VertexOrder.hpp"
+#include "SharedEmbeddings.hpp"
+#include "ParameterSweep.hpp"
+#include "LabelTable.hpp"
+#include "Numa.hpp"
+#include "PerfCounters.hpp"
+
+bool checkKernels(double);
+
+bool benchmarkKernels();
+
+void benchmarkDimensions();
+
+void benchmarkUpdateBatch();
+
+void benchmarkExp();
+
+void benchmarkProductQuantization();
+
+void benchmarkNeighborSampling();
+
+void benchmarkIngestion();
+
+void benchmarkLabelInterning();
+
+void benchmarkVertexOrder();
+
+bool benchmarkQuality(double);
+
+void benchmarkKernelMatrix();
+
+void benchmarkExtractionCache();
+
+void benchmarkAdaptiveDegree();
+
+void benchmarkDeduplication();
+
+void benchmarkDynamicGraphs();
+
+void benchmarkAppend();
+
+bool benchmarkSharedEmbeddings();
+
+void benchmarkSweep();
+
+void benchmarkNuma();
+
+void benchmarkObjective();
+
+void benchmarkPerfCounters();
+
+void getPlantedGraph(Graph &, unsigned, unsigned, std::mt19937 &);
+
+void getRandomGraph(Graph &, unsigned, double, const std::vector<double> &, std::mt19937 &);
+
+void getSmallWorldGraph(Graph &, unsigned, unsigned, unsigned, std::mt19937 &);
+
+std::vector<std::vector<double>> getSubgraphHistograms(const Graph2Vec &);
+
+std::vector<unsigned> getSubgraphPartition(const Graph2Vec &);
+
+double getNearestNeighborsAccuracy(const std::vector<std::vector<double>> &, const std::vector<unsigned> &, unsigned);
+
+double getLogisticRegressionAccuracy(const std::vector<std::vector<double>> &, const std::vector<unsigned> &, unsigned);
+
+void resetPeakMemory();
+
+double getPeakMemory();
+
+std::size_t countEdges(const std::vector<Graph> &);
+
+void getRelabelingUpdates(std::vector<GraphUpdate> &, const Graph &, unsigned, unsigned, std::mt19937 &);
+
+void getPreferentialAttachmentGraph(Graph &, unsigned, unsigned, unsigned, std::mt19937 &);
+
+double getAdjustedRandIndex(const std::vector<unsigned> &, const std::vector<unsigned> &);
+
+double timeGraphEmbeddingUpdate(const Kernels &, unsigned, ExpMethod = exactExp);
+
+double maxDifference(const std::vector<double> &, const std::vector<double> &);
+
+double relativeDifference(const std::vector<double> &, const std::vector<double> &);
+
+// Snapshots seen by one reader process of the shared embeddings benchmark
+struct SharedReads
+{
+    unsigned long long snapshots = 0; // Valid snapshots read in place
+    unsigned long long overwritten = 0; // Snapshots overwritten while read, so dropped
+    unsigned long long torn = 0; // Valid snapshots of values of other generations
+    unsigned long long copies = 0;
+    double readTime = 0;
+    double copyTime = 0;
+};
+
+SharedReads readSharedEmbeddings(const char *, double);
+
+int main(int argc, char ** argv)
+{
+    if (argc < 2 || argc > 3 || std::strcmp(argv[1], "--help") == 0)
+    {
+        std::cout << "Usage:\ngraph2vec_bench <benchmark> [minimum accuracy of quality or tolerance of check]\n";
+        std::cout << "\tcheck (every supported kernel against scalar reference loops on odd and even lengths, fails above the tolerance, default 1e-12)\n";
+        std::cout << "\tkernels (check, then vector kernels of every supported instruction set, dimensions 8-512)\n";
+        std::cout << "\tdimensions (update of graph embedding, kernels of fixed against any dimension)\n";
+        std::cout << "\texp (exact, table and polynomial exp of softmax: error and time)\n";
+        std::cout << "\tupdate (updates of graph embedding by every subgraph against mini-batches of subgraphs)\n";
+        std::cout << "\tingest (reading of graphs from directory of JSON files, JSON lines file and binary records)\n";
+        std::cout << "\tlabels (reading of JSON lines of string labels interned by the label table, against mapping them to numbers first)\n";
+        std::cout << "\tsampling (extraction of subgraphs of power-law graphs, all adjacent vertices against a sample)\n";
+        std::cout << "\treorder (extraction of subgraphs and their context of large sparse graphs of shuffled vertices, every order of vertices)\n";
+        std::cout << "\tpq (product quantization of embeddings: compression, error, search on codes against exact search)\n";
+        std::cout << "\tdepth (fit of generated graph classes with fixed and adaptive degree: subgraphs, time and accuracy)\n";
+        std::cout << "\tdedup (fit of generated graph classes, every graph 4 times with shuffled vertices, with and without deduplication)\n";
+        std::cout << "\tdynamic (updates of a large graph of the fitted model by batches of edges, against fit of the updated graphs)\n";
+        std::cout << "\tappend (generated graph classes appended by 10% to the saved model, against fit of all graphs)\n";
+        std::cout << "\tsweep (grid of training parameters of generated graph classes, one extraction shared against a fit of every configuration)\n";
+        std::cout << "\tnuma (training of graph embeddings by 1-4 threads, with and without NUMA placement)\n";
+        std::cout << "\tobjective (fit of generated graph classes with full and hierarchical softmax of word2vec: time and accuracy)\n";
+        std::cout << "\tcounters (hardware events of the stages of fit of generated graph classes, both objectives of word2vec, n/a where not supported)\n";
+        std::cout << "\tshm (embeddings published to shared memory while reader processes check their snapshots, fails on a torn snapshot)\n";
+        std::cout << "\tcache (extraction without cache, to an empty cache, from the cache and with 10% of graphs changed)\n";
+        std::cout << "\tkernel (WL subtree kernel matrix of generated graph classes by 1-4 threads, accuracy of k-NN on it)\n";
+        std::cout << "\tquality (fit of generated graph classes: time and memory of stages against accuracy of classifiers, fails below the minimum)\n";
+        return 0;
+    }
+    if (std::strcmp(argv[1], "check") == 0)
+    {
+        if (! checkKernels(argc == 3 ? std::atof(argv[2]) : 1e-12))
+            return EXIT_FAILURE;
+    }
+    else if (std::strcmp(argv[1], "kernels") == 0)
+    {
+        if (! benchmarkKernels())
+            return EXIT_FAILURE;
+    }
+    else if (std::strcmp(argv[1], "dimensions") == 0)
+        benchmarkDimensions();
+    else if (std::strcmp(argv[1], "exp") == 0)
+        benchmarkExp();
+    else if (std::strcmp(argv[1], "update") == 0)
+        benchmarkUpdateBatch();
+    else if (std::strcmp(argv[1], "ingest") == 0)
+        benchmarkIngestion();
+    else if (std::strcmp(argv[1], "labels") == 0)
+        benchmarkLabelInterning();
+    else if (std::strcmp(argv[1], "sampling") == 0)
+        benchmarkNeighborSampling();
+    else if (std::strcmp(argv[1], "reorder") == 0)
+        benchmarkVertexOrder();
+    else if (std::strcmp(argv[1], "pq") == 0)
+        benchmarkProductQuantization();
+    else if (std::strcmp(argv[1], "kernel") == 0)
+        benchmarkKernelMatrix();
+    else if (std::strcmp(argv[1], "dynamic") == 0)
+        benchmarkDynamicGraphs();
+    else if (std::strcmp(argv[1], "append") == 0)
+        benchmarkAppend();
+    else if (std::strcmp(argv[1], "sweep") == 0)
+        benchmarkSweep();
+    else if (std::strcmp(argv[1], "numa") == 0)
+        benchmarkNuma();
+    else if (std::strcmp(argv[1], "objective") == 0)
+        benchmarkObjective();
+    else if (std::strcmp(argv[1], "counters") == 0)
+        benchmarkPerfCounters();
+    else if (std::strcmp(argv[1], "shm") == 0)
+    {
+        if (! benchmarkSharedEmbeddings())
+            return EXIT_FAILURE;
+    }
+    else if (std::strcmp(argv[1], "cache") == 0)
+        benchmarkExtractionCache();
+    else if (std::strcmp(argv[1], "depth") == 0)
+        benchmarkAdaptiveDegree();
+    else if (std::strcmp(argv[1], "dedup") == 0)
+        benchmarkDeduplication();
+    else if (std::strcmp(argv[1], "quality") == 0)
+    {
+        if (! benchmarkQuality(argc == 3 ? std::atof(argv[2]) : 0.0))
+            return EXIT_FAILURE;
+    }
+    else
+    {
+        std::cerr << "Unknown benchmark " << argv[1] << ".\n";
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+// Every supported kernel (of any length, and of fixed length where the length is fixed) against
+// plain scalar loops, on lengths and numbers of rows which leave tails of every vector width.
+// Difference is relative to 1 + |reference|, fails if any is above the tolerance
+bool checkKernels(double tolerance)
+{
+    const unsigned lengths[] = {1, 2, 3, 4, 5, 7, 8, 9, 13, 15, 16, 17, 31, 32, 33, 64, 100, 128, 255, 256, 257, 512};
+    const unsigned rowCounts[] = {1, 2, 3, 4, 5, 7, 20};
+    const char * kernelNames[] = {"dot", "axpy", "scaledAdd", "batchedDot", "softmaxWeightedSum"};
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    unsigned checked = 0, failed = 0;
+    for (unsigned n : lengths)
+    {
+        std::vector<const Kernels *> kernels = getSupportedKernels(), fixedKernels = getSupportedKernels(n);
+        if (fixedKernels[0] != kernels[0])
+            kernels.insert(kernels.end(), fixedKernels.begin(), fixedKernels.end());
+        for (unsigned k : rowCounts)
+        {
+            std::vector<double> x(n), y(n);
+            std::vector<std::vector<double>> rows(k, std::vector<double>(n));
+            std::vector<const double *> rowPointers(k);
+            for (unsigned i = 0; i < n; i++)
+            {
+                x[i] = unidist(generator);
+                y[i] = unidist(generator);
+            }
+            for (unsigned j = 0; j < k; j++)
+            {
+                for (unsigned i = 0; i < n; i++)
+                    rows[j][i] = unidist(generator);
+                rowPointers[j] = rows[j].data();
+            }
+            // Scalar reference of every kernel
+            std::vector<double> references[5];
+            references[0].assign(1, 0.0);
+            references[1] = y;
+            references[2] = y;
+            references[3].assign(k, 0.0);
+            references[4].assign(n, 0.0);
+            for (unsigned i = 0; i < n; i++)
+            {
+                references[0][0] += x[i] * y[i];
+                references[1][i] += 0.5 * x[i];
+                references[2][i] = 0.9 * y[i] - 0.5 * x[i];
+            }
+            for (unsigned j = 0; j < k; j++)
+                for (unsigned i = 0; i < n; i++)
+                    references[3][j] += x[i] * rows[j][i];
+            double maxScore = *std::max_element(references[3].begin(), references[3].end()), sum = 0.0;
+            std::vector<double> weights(k);
+            for (unsigned j = 0; j < k; j++)
+            {
+                weights[j] = references[3][j] - maxScore < expCutoff ? 0.0 : std::exp(references[3][j] - maxScore);
+                sum += weights[j];
+            }
+            for (unsigned j = 0; j < k; j++)
+                for (unsigned i = 0; i < n; i++)
+                    references[4][i] += weights[j] / sum * rows[j][i];
+            for (const Kernels * kernel : kernels)
+            {
+                std::vector<double> results[5];
+                results[0].assign(1, kernel->dot(x.data(), y.data(), n));
+                results[1] = y;
+                kernel->axpy(0.5, x.data(), results[1].data(), n);
+                results[2] = y;
+                kernel->scaledAdd(0.9, results[2].data(), -0.5, x.data(), n);
+                results[3].assign(k, 0.0);
+                kernel->batchedDot(x.data(), rowPointers.data(), results[3].data(), k, n);
+                std::vector<double> scores = references[3];
+                results[4].assign(n, 0.0);
+                kernel->softmaxWeightedSum(rowPointers.data(), scores.data(), results[4].data(), k, n, exactExp);
+                for (unsigned f = 0; f < 5; f++)
+                {
+                    double difference = relativeDifference(references[f], results[f]);
+                    checked++;
+                    if (difference > tolerance)
+                    {
+                        failed++;
+                        std::cerr << kernel->name << " " << kernelNames[f] << " of length " << n << " and " << k << " rows differs by " << difference << ".\n";
+                    }
+                }
+            }
+        }
+    }
+    std::cout << checked << " checks of kernels against the scalar reference, " << failed << " failed (tolerance " << tolerance << ")\n";
+    return failed == 0;
+}
+
+// Time of every kernel in nanoseconds per call, and its largest difference to the portable kernel,
+// after the check against the scalar reference. Returns false if the check fails
+bool benchmarkKernels()
+{
+    if (! checkKernels(1e-12))
+        return false;
+    const unsigned k = 20; // Number of rows of batched kernels, as many as default negative samples
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    std::cout << "Kernels chosen at run time: " << getKernels().name << "\n";
+    std::cout << std::left << std::setw(14) << "kernels" << std::setw(6) << "dim" << std::right;
+    std::cout << std::setw(10) << "dot" << std::setw(10) << "axpy" << std::setw(11) << "scaledAdd" << std::setw(12) << "batchedDot";
+    std::cout << std::setw(12) << "softmaxSum" << std::setw(12) << "max error" << "\n";
+    for (unsigned n = 8; n <= 512; n *= 2)
+    {
+        // Kernels of any length, followed by the ones of fixed length n, if there are such
+        std::vector<const Kernels *> kernels = getSupportedKernels(), fixedKernels = getSupportedKernels(n);
+        if (fixedKernels[0] != kernels[0])
+            kernels.insert(kernels.end(), fixedKernels.begin(), fixedKernels.end());
+        std::vector<double> x(n), y(n), out(n);
+        std::vector<std::vector<double>> rows(k, std::vector<double>(n));
+        std::vector<const double *> rowPointers(k);
+        for (unsigned i = 0; i < n; i++)
+        {
+            x[i] = unidist(generator);
+            y[i] = unidist(generator);
+        }
+        for (unsigned j = 0; j < k; j++)
+        {
+            for (unsigned i = 0; i < n; i++)
+                rows[j][i] = unidist(generator);
+            rowPointers[j] = rows[j].data();
+        }
+        unsigned repetitions = 20000000 / (n * k) + 1;
+        std::vector<double> referenceDot, referenceAxpy, referenceScaledAdd, referenceBatched, referenceSoftmax;
+        for (unsigned v = 0; v < kernels.size(); v++)
+        {
+            const Kernels & kernel = *kernels[v];
+            // Results for correctness check
+            std::vector<double> resultDot(1, kernel.dot(x.data(), y.data(), n)), resultAxpy = y, resultScaledAdd = y, resultBatched(k), resultSoftmax(n);
+            kernel.axpy(0.5, x.data(), resultAxpy.data(), n);
+            kernel.scaledAdd(0.9, resultScaledAdd.data(), -0.5, x.data(), n);
+            kernel.batchedDot(x.data(), rowPointers.data(), resultBatched.data(), k, n);
+            std::vector<double> scores = resultBatched;
+            kernel.softmaxWeightedSum(rowPointers.data(), scores.data(), resultSoftmax.data(), k, n, exactExp);
+            if (v == 0)
+            {
+                referenceDot = resultDot;
+                referenceAxpy = resultAxpy;
+                referenceScaledAdd = resultScaledAdd;
+                referenceBatched = resultBatched;
+                referenceSoftmax = resultSoftmax;
+            }
+            double error = std::max({maxDifference(referenceDot, resultDot), maxDifference(referenceAxpy, resultAxpy),
+                                     maxDifference(referenceScaledAdd, resultScaledAdd), maxDifference(referenceBatched, resultBatched),
+                                     maxDifference(referenceSoftmax, resultSoftmax)});
+            double times[5], sink = 0.0L;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned r = 0; r < repetitions * k; r++)
+                sink += kernel.dot(x.data(), rows[r % k].data(), n);
+            times[0] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * k);
+            start = std::chrono::steady_clock::now();
+            for (unsigned r = 0; r < repetitions * k; r++)
+                kernel.axpy(1e-9, rows[r % k].data(), out.data(), n);
+            times[1] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * k);
+            start = std::chrono::steady_clock::now();
+            for (unsigned r = 0; r < repetitions * k; r++)
+                kernel.scaledAdd(1.0L, out.data(), 1e-9, rows[r % k].data(), n);
+            times[2] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * k);
+            start = std::chrono::steady_clock::now();
+            for (unsigned r = 0; r < repetitions; r++)
+                kernel.batchedDot(x.data(), rowPointers.data(), scores.data(), k, n);
+            times[3] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repetitions;
+            start = std::chrono::steady_clock::now();
+            for (unsigned r = 0; r < repetitions; r++)
+            {
+                scores.assign(resultBatched.begin(), resultBatched.end());
+                kernel.softmaxWeightedSum(rowPointers.data(), scores.data(), out.data(), k, n, exactExp);
+            }
+            times[4] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repetitions;
+            std::cout << std::left << std::setw(14) << kernel.name << std::setw(6) << n << std::right << std::fixed << std::setprecision(1);
+            std::cout << std::setw(10) << times[0] << std::setw(10) << times[1] << std::setw(11) << times[2] << std::setw(12) << times[3];
+            std::cout << std::setw(12) << times[4] << std::setw(12) << std::scientific << std::setprecision(1) << error << std::defaultfloat;
+            std::cout << (sink == 0.123 ? " " : "") << "\n";
+        }
+    }
+    return true;
+}
+
+// Time of one update of graph embedding (as in updateGraphsEmbeddings, with 20 negative samples),
+// kernels of any dimension against kernels of fixed dimension
+void benchmarkDimensions()
+{
+    std::cout << std::left << std::setw(6) << "dim" << std::setw(10) << "kernels" << std::right << std::setw(12) << "any [ns]";
+    std::cout << std::setw(12) << "fixed [ns]" << std::setw(10) << "speedup" << "\n";
+    for (unsigned i = 0; i < fixedDimensionsCount; i++)
+    {
+        unsigned n = fixedDimensions[i];
+        std::vector<const Kernels *> kernels = getSupportedKernels(), fixedKernels = getSupportedKernels(n);
+        for (unsigned v = 0; v < kernels.size(); v++)
+        {
+            double anyTime = timeGraphEmbeddingUpdate(*kernels[v], n), fixedTime = timeGraphEmbeddingUpdate(*fixedKernels[v], n);
+            std::cout << std::left << std::setw(6) << n << std::setw(10) << kernels[v]->name << std::right << std::fixed << std::setprecision(1);
+            std::cout << std::setw(12) << anyTime << std::setw(12) << fixedTime << std::setw(9) << anyTime / fixedTime << "x" << std::defaultfloat << "\n";
+        }
+    }
+}
+
+// Largest relative error of every method of exp on 10^6 points of [expCutoff, 0], time per value
+// of exp of 1024 values, and time of softmax of 20 scores (as of negative samples) and of update
+// of graph embedding of 64 dimensions
+void benchmarkExp()
+{
+    const unsigned points = 1000000, n = 1024, repetitions = 20000, k = 20;
+    std::vector<double> grid(points), values(points);
+    for (unsigned i = 0; i < points; i++)
+        grid[i] = expCutoff * i / (points - 1);
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> unidist(expCutoff, 0.0), scoreDist(-3.0, 3.0);
+    std::vector<double> input(n), output(n), scoresInput(k), scores(k);
+    for (unsigned i = 0; i < n; i++)
+        input[i] = unidist(generator);
+    for (unsigned j = 0; j < k; j++)
+        scoresInput[j] = scoreDist(generator);
+    std::cout << std::left << std::setw(12) << "exp" << std::right << std::setw(16) << "max rel error" << std::setw(12) << "exp [ns]";
+    std::cout << std::setw(16) << "softmax [ns]" << std::setw(15) << "update [ns]" << "\n";
+    const ExpMethod methods[] = {exactExp, tableExp, polynomialExp};
+    for (unsigned m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+    {
+        values = grid;
+        expNegative(values.data(), points, methods[m]);
+        double error = 0;
+        for (unsigned i = 0; i < points; i++)
+            error = std::max(error, std::fabs(values[i] - std::exp(grid[i])) / std::exp(grid[i]));
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned r = 0; r < repetitions; r++)
+        {
+            output = input;
+            expNegative(output.data(), n, methods[m]);
+        }
+        double expTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ((double) repetitions * n);
+        start = std::chrono::steady_clock::now();
+        for (unsigned r = 0; r < repetitions * 10; r++)
+        {
+            scores = scoresInput;
+            softmaxWeights(scores.data(), k, methods[m]);
+        }
+        double softmaxTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * 10);
+        std::cout << std::left << std::setw(12) << getExpMethodName(methods[m]) << std::right << std::scientific << std::setprecision(2) << std::setw(16) << error;
+        std::cout << std::fixed << std::setprecision(2) << std::setw(12) << expTime << std::setw(16) << softmaxTime;
+        std::cout << std::setw(15) << timeGraphEmbeddingUpdate(getKernels(64), 64, methods[m]) << std::defaultfloat << "\n";
+    }
+}
+
+// Time per subgraph of training of one graph embedding on 500 subgraphs with 20 negative samples,
+// and the distance of the result of every mini-batch size to the update by every subgraph
+void benchmarkUpdateBatch()
+{
+    const unsigned subgraphsCount = 500, negSamples = 20, repetitions = 20;
+    const unsigned batches[] = {1, 4, 16, 64};
+    std::cout << std::setw(6) << "dim";
+    for (unsigned b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+        std::cout << std::setw(14) << "batch " + std::to_string(batches[b]) + " [ns]";
+    std::cout << std::setw(14) << "distance 64" << "\n";
+    for (unsigned i = 0; i < fixedDimensionsCount; i++)
+    {
+        unsigned n = fixedDimensions[i];
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+        std::vector<std::vector<double>> subgraphs(subgraphsCount, std::vector<double>(n)), negatives(negSamples, std::vector<double>(n));
+        std::vector<double> initial(n);
+        for (unsigned j = 0; j < subgraphsCount; j++)
+            for (unsigned d = 0; d < n; d++)
+                subgraphs[j][d] = unidist(generator);
+        for (unsigned j = 0; j < negSamples; j++)
+            for (unsigned d = 0; d < n; d++)
+                negatives[j][d] = unidist(generator);
+        for (unsigned d = 0; d < n; d++)
+            initial[d] = unidist(generator);
+        std::vector<const double *> rows(subgraphsCount);
+        for (unsigned j = 0; j < subgraphsCount; j++)
+            rows[j] = subgraphs[j].data();
+        std::vector<double> exact, embedding;
+        std::cout << std::setw(6) << n << std::fixed << std::setprecision(1);
+        for (unsigned b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned r = 0; r < repetitions; r++)
+            {
+                embedding = initial;
+                if (batches[b] == 1)
+                    for (unsigned j = 0; j < subgraphsCount; j++)
+                        updateGraphsEmbeddings(embedding, subgraphs[j], negatives, 0.025, exactExp);
+                else
+                    for (unsigned first = 0; first < subgraphsCount; first += batches[b])
+                        updateGraphsEmbeddingsBatch(embedding, rows.data() + first, std::min(batches[b], subgraphsCount - first), negatives, 0.025, exactExp);
+            }
+            double time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repetitions * subgraphsCount);
+            if (b == 0)
+                exact = embedding;
+            std::cout << std::setw(14) << time;
+        }
+        std::cout << std::setprecision(4) << std::setw(14) << maxDifference(exact, embedding) << std::defaultfloat << "\n";
+    }
+}
+
+// Embeddings drawn around 100 random centers, 128 dimensions. Time of one query of 10 nearest
+// rows, exact and by asymmetric distance on codes, and recall of the exact 10 nearest rows
+void benchmarkProductQuantization()
+{
+    const unsigned rows = 20000, n = 128, clusters = 100, queries = 50, k = 10;
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    std::normal_distribution<double> normdist(0.0, 0.3);
+    std::vector<std::vector<double>> centers(clusters, std::vector<double>(n)), matrix(rows, std::vector<double>(n));
+    for (unsigned c = 0; c < clusters; c++)
+        for (unsigned i = 0; i < n; i++)
+            centers[c][i] = unidist(generator);
+    for (unsigned r = 0; r < rows; r++)
+        for (unsigned i = 0; i < n; i++)
+            matrix[r][i] = centers[r % clusters][i] + normdist(generator);
+    std::vector<std::vector<unsigned>> exactNearest(queries);
+    std::vector<std::pair<double, unsigned>> distances(rows);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned q = 0; q < queries; q++)
+    {
+        const std::vector<double> & query = matrix[q * (rows / queries)];
+        for (unsigned r = 0; r < rows; r++)
+        {
+            double distance = 0;
+            for (unsigned i = 0; i < n; i++)
+                distance += (query[i] - matrix[r][i]) * (query[i] - matrix[r][i]);
+            distances[r] = std::make_pair(distance, r);
+        }
+        std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+        for (unsigned i = 0; i < k; i++)
+            exactNearest[q].push_back(distances[i].second);
+    }
+    double exactTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / queries;
+    std::cout << rows << " rows of " << n << " dimensions, exact search " << std::fixed << std::setprecision(1) << exactTime << " us per query\n";
+    std::cout << std::setw(10) << "subspaces" << std::setw(10) << "ratio" << std::setw(12) << "rel. error";
+    std::cout << std::setw(12) << "fit [ms]" << std::setw(14) << "search [us]" << std::setw(12) << "recall@10" << "\n";
+    for (unsigned subspaces = 8; subspaces <= 32; subspaces *= 2)
+    {
+        ProductQuantizer::Parameters parameters;
+        parameters.subspaces = subspaces;
+        ProductQuantizer quantizer(parameters);
+        start = std::chrono::steady_clock::now();
+        quantizer.fit(matrix, generator);
+        double fitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        unsigned found = 0;
+        start = std::chrono::steady_clock::now();
+        for (unsigned q = 0; q < queries; q++)
+        {
+            std::vector<unsigned> nearest = quantizer.search(matrix[q * (rows / queries)], k);
+            for (unsigned i = 0; i < k; i++)
+                found += std::count(exactNearest[q].begin(), exactNearest[q].end(), nearest[i]);
+        }
+        double searchTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / queries;
+        std::cout << std::setw(10) << subspaces << std::setw(9) << quantizer.getCompressionRatio() << "x" << std::setprecision(4);
+        std::cout << std::setw(12) << quantizer.getReconstructionError(matrix) << std::setprecision(1) << std::setw(12) << fitTime;
+        std::cout << std::setw(14) << searchTime << std::setw(12) << std::setprecision(2) << (double) found / (queries * k) << std::setprecision(1) << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
+
+// WL relabeling and radial context of preferential attachment graphs (power-law degrees) with
+// adjacent vertices capped at K. Size of context is the number of its entries (pairs of word2vec),
+// quality is the adjusted Rand index of the partitions of vertices by subgraphs of degrees 1 and 2
+// against the exact partitions
+void benchmarkNeighborSampling()
+{
+    const unsigned graphsCount = 4, vertices = 3000, edgesPerVertex = 3, labels = 2, degree = 3, dimensions = 16;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    unsigned maxDegree = 0;
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        getPreferentialAttachmentGraph(graphs[g], vertices, edgesPerVertex, labels, generator);
+        for (unsigned v = 0; v < vertices; v++)
+        {
+            unsigned count = 0;
+            for (unsigned i = 0; i < vertices; i++)
+                count += graphs[g].getEdge(v, i) != nullptr;
+            maxDegree = std::max(maxDegree, count);
+        }
+    }
+    std::cout << graphsCount << " graphs of " << vertices << " vertices, maximum degree of vertex " << maxDegree << ", WL degree " << degree << "\n";
+    std::cout << std::setw(6) << "K" << std::setw(15) << "extract [ms]" << std::setw(15) << "context [ms]" << std::setw(12) << "subgraphs";
+    std::cout << std::setw(12) << "sampled" << std::setw(12) << "context" << std::setw(10) << "ARI d=1" << std::setw(10) << "ARI d=2" << "\n";
+    std::vector<std::vector<unsigned>> exactPartitions;
+    const unsigned caps[] = {0, 256, 64, 16, 8};
+    for (unsigned c = 0; c < sizeof(caps) / sizeof(caps[0]); c++)
+    {
+        NeighborSampling sampling;
+        sampling.maxNeighbors = caps[c];
+        SubgraphVocabulary vocabulary;
+        SubgraphHashing hashing;
+        std::vector<std::vector<double>> embeddings;
+        std::vector<SubgraphMap> maps(graphsCount);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned g = 0; g < graphsCount; g++)
+        {
+            maps[g].graphID = g;
+            for (unsigned v = 0; v < vertices; v++)
+                for (unsigned d = 0; d <= degree; d++)
+                    getWLSubgraph(maps[g], vocabulary, hashing, embeddings, graphs[g], graphs[g].getVertex(v), d, dimensions, sampling, generator);
+        }
+        double extractTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        RadialContext context;
+        start = std::chrono::steady_clock::now();
+        radialSkipGram(context, maps, graphs, degree, sampling, generator);
+        double contextTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::vector<std::vector<unsigned>> partitions(3);
+        std::vector<unsigned> adjacent;
+        unsigned sampled = 0;
+        std::size_t contextSize = 0;
+        for (RadialContext::const_iterator it = context.cbegin(); it != context.cend(); it++)
+            contextSize += it->second.size();
+        for (unsigned g = 0; g < graphsCount; g++)
+        {
+            for (unsigned v = 0; v < vertices; v++)
+            {
+                for (unsigned d = 1; d <= 2; d++)
+                    partitions[d].push_back(maps[g].rootVertices[v][d]);
+                sampled += getAdjacentVertices(adjacent, graphs[g], v, sampling) > adjacent.size();
+            }
+        }
+        if (c == 0)
+            exactPartitions = partitions;
+        std::cout << std::setw(6) << caps[c] << std::fixed << std::setprecision(1) << std::setw(15) << extractTime << std::setw(15) << contextTime;
+        std::cout << std::setw(12) << embeddings.size() << std::setw(12) << sampled << std::setw(12) << contextSize << std::setprecision(3);
+        std::cout << std::setw(10) << getAdjustedRandIndex(exactPartitions[1], partitions[1]);
+        std::cout << std::setw(10) << getAdjustedRandIndex(exactPartitions[2], partitions[2]) << std::defaultfloat << "\n";
+    }
+}
+
+// Rewired ring lattices of 4000 vertices with vertex numbers shuffled (like arbitrary numbers of
+// input files), renumbered by every order. Subgraphs must be the same for every order
+void benchmarkVertexOrder()
+{
+    const unsigned graphsCount = 2, vertices = 4000, neighbors = 3, labels = 4, degree = 3, dimensions = 16;
+    std::mt19937 generator(1);
+    std::vector<Graph> shuffled(graphsCount);
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        Graph graph;
+        getSmallWorldGraph(graph, vertices, neighbors, labels, generator);
+        std::vector<unsigned> order(vertices);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), generator);
+        reorderGraph(shuffled[g], graph, order);
+    }
+    std::cout << graphsCount << " graphs of " << vertices << " vertices, " << countEdges(shuffled) << " edges, WL degree " << degree << "\n";
+    std::cout << std::left << std::setw(10) << "order" << std::right << std::setw(14) << "reorder [ms]" << std::setw(12) << "bandwidth";
+    std::cout << std::setw(15) << "extract [ms]" << std::setw(15) << "context [ms]" << std::setw(12) << "subgraphs" << "\n";
+    const VertexOrder orders[] = {originalOrder, degreeOrder, bfsOrder, rcmOrder};
+    for (unsigned o = 0; o < sizeof(orders) / sizeof(orders[0]); o++)
+    {
+        std::vector<Graph> graphs(graphsCount);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned g = 0; g < graphsCount; g++)
+        {
+            std::vector<unsigned> order;
+            getVertexOrder(order, shuffled[g], orders[o]);
+            reorderGraph(graphs[g], shuffled[g], order);
+        }
+        double reorderTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        NeighborSampling sampling;
+        SubgraphVocabulary vocabulary;
+        SubgraphHashing hashing;
+        std::vector<std::vector<double>> embeddings;
+        std::vector<SubgraphMap> maps(graphsCount);
+        start = std::chrono::steady_clock::now();
+        for (unsigned g = 0; g < graphsCount; g++)
+        {
+            maps[g].graphID = g;
+            for (unsigned v = 0; v < vertices; v++)
+                for (unsigned d = 0; d <= degree; d++)
+                    getWLSubgraph(maps[g], vocabulary, hashing, embeddings, graphs[g], graphs[g].getVertex(v), d, dimensions, sampling, generator);
+        }
+        double extractTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        RadialContext context;
+        start = std::chrono::steady_clock::now();
+        radialSkipGram(context, maps, graphs, degree, sampling, generator);
+        double contextTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::left << std::setw(10) << getVertexOrderName(orders[o]) << std::right << std::fixed << std::setprecision(1) << std::setw(14) << reorderTime;
+        std::cout << std::setw(12) << getBandwidth(graphs[0]) << std::setw(15) << extractTime << std::setw(15) << contextTime << std::setw(12) << embeddings.size() << std::defaultfloat << "\n";
+    }
+}
+
+// 20000 random graphs of 20 vertices written in every format to a temporary directory, then read
+// whole (with 1 and 4 threads of chunks) and streamed graph by graph
+void benchmarkIngestion()
+{
+    const unsigned graphsCount = 20000, vertices = 20, edgesPerVertex = 2, labels = 8;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    for (unsigned g = 0; g < graphsCount; g++)
+        getPreferentialAttachmentGraph(graphs[g], vertices, edgesPerVertex, labels, generator);
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "graph2vec_bench_ingest";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "json");
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        std::vector<Graph> one(1);
+        one[0] = graphs[g];
+        std::filesystem::path fileName = dir / "graph.jsonl";
+        writeGraphsJSONL(fileName, one);
+        // JSON file of the directory is the line without "id"
+        std::ifstream lineFile(fileName);
+        std::string line;
+        std::getline(lineFile, line);
+        std::ofstream(dir / "json" / (std::to_string(g) + ".json")) << line;
+    }
+    writeGraphsJSONL(dir / "graphs.jsonl", graphs);
+    writeGraphsBinary(dir / "graphs.bin", graphs);
+    std::size_t edges = countEdges(graphs);
+    std::cout << graphsCount << " graphs, " << edges << " edges\n";
+    std::cout << std::left << std::setw(28) << "input" << std::right << std::setw(12) << "size [MB]" << std::setw(12) << "time [ms]" << std::setw(14) << "graphs/s" << std::setw(8) << "same" << "\n";
+    const char * names[3] = {"json", "graphs.jsonl", "graphs.bin"};
+    for (unsigned f = 0; f < 3; f++)
+    {
+        std::filesystem::path dataset = dir / names[f];
+        double size = 0;
+        if (f == 0)
+            for (const std::filesystem::directory_entry & entry : std::filesystem::directory_iterator(dataset))
+                size += entry.file_size();
+        else
+            size = std::filesystem::file_size(dataset);
+        for (unsigned mode = 0; mode < 3; mode++)
+        {
+            if (f == 0 && mode == 2)
+                continue;
+            std::vector<Graph> read;
+            std::size_t readEdges = 0;
+            unsigned readGraphsCount = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::string name = std::string(names[f]);
+            if (mode == 0)
+            {
+                streamGraphs(dataset, [&](unsigned, Graph & graph)
+                {
+                    std::vector<Graph> one(1);
+                    one[0] = std::move(graph);
+                    readEdges += countEdges(one);
+                    readGraphsCount++;
+                    return true;
+                });
+                name += " stream";
+            }
+            else
+            {
+                unsigned threads = mode == 1 ? 1 : 4;
+                if (f == 0)
+                    readGraphs(dataset, read);
+                else if (f == 1)
+                    readGraphsJSONL(dataset, read, threads);
+                else
+                    readGraphsBinary(dataset, read, threads);
+                readEdges = countEdges(read);
+                readGraphsCount = read.size();
+                if (f > 0)
+                    name += " " + std::to_string(threads) + " threads";
+            }
+            double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1) << std::setw(12) << size / 1e6;
+            std::cout << std::setw(12) << time << std::setprecision(0) << std::setw(14) << readGraphsCount / time * 1000 << std::defaultfloat;
+            std::cout << std::setw(8) << (readGraphsCount == graphsCount && readEdges == edges ? "yes" : "no") << "\n";
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// 20000 random graphs of 20 vertices of 256 string labels in a JSON lines file, read with labels interned
+// by the table (by 1 and 4 threads of chunks), against a pass mapping the labels to numbers into
+// another file, which is read then. Same tells, whether every vertex has its string label again
+void benchmarkLabelInterning()
+{
+    const unsigned graphsCount = 20000, vertices = 20, edgesPerVertex = 2, labels = 256;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    LabelTable names;
+    for (unsigned l = 0; l < labels; l++)
+        names.intern("atom:" + std::to_string(l) + ":aromatic");
+    for (unsigned g = 0; g < graphsCount; g++)
+        getPreferentialAttachmentGraph(graphs[g], vertices, edgesPerVertex, labels, generator);
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "graph2vec_bench_labels";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    writeGraphsJSONL(dir / "strings.jsonl", graphs, &names);
+    std::cout << graphsCount << " graphs, " << labels << " string labels, " << std::fixed << std::setprecision(1);
+    std::cout << std::filesystem::file_size(dir / "strings.jsonl") / 1e6 << " MB" << std::defaultfloat << "\n";
+    std::cout << std::left << std::setw(24) << "ingestion" << std::right << std::setw(12) << "time [ms]" << std::setw(14) << "graphs/s" << std::setw(10) << "labels" << std::setw(8) << "same" << "\n";
+    for (unsigned mode = 0; mode < 3; mode++)
+    {
+        std::vector<Graph> read;
+        LabelTable table;
+        std::string name;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (mode < 2)
+        {
+            unsigned threads = mode == 0 ? 1 : 4;
+            readGraphsJSONL(dir / "strings.jsonl", read, threads, &table);
+            name = "interned, " + std::to_string(threads) + " threads";
+        }
+        else
+        {
+            // Mapping pass rewrites labels by an ordered map, as a script before graph2vec would
+            std::map<std::string, unsigned> numbers;
+            std::ifstream inputFile(dir / "strings.jsonl");
+            std::ofstream outputFile(dir / "numbers.jsonl");
+            std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            std::string line, errors;
+            while (std::getline(inputFile, line))
+            {
+                Json::Value graphJSON;
+                reader->parse(line.data(), line.data() + line.size(), &graphJSON, &errors);
+                for (const std::string & vertex : graphJSON["features"].getMemberNames())
+                {
+                    std::string label = graphJSON["features"][vertex].asString();
+                    std::map<std::string, unsigned>::iterator it = numbers.emplace(label, numbers.size()).first;
+                    graphJSON["features"][vertex] = std::to_string(it->second);
+                }
+                outputFile << Json::writeString(builder, graphJSON) << "\n";
+            }
+            outputFile.close();
+            std::vector<std::string> labelsOfNumbers(numbers.size());
+            for (std::map<std::string, unsigned>::const_iterator it = numbers.cbegin(); it != numbers.cend(); it++)
+                labelsOfNumbers[it->second] = it->first;
+            table.assign(labelsOfNumbers);
+            readGraphsJSONL(dir / "numbers.jsonl", read, 1);
+            name = "mapped first, 1 thread";
+        }
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bool same = read.size() == graphs.size();
+        for (unsigned g = 0; same && g < graphs.size(); g++)
+        {
+            for (unsigned i = 0; same && i < graphs[g].getMaxVertex(); i++)
+            {
+                if (graphs[g].getVertex(i) != nullptr)
+                    same = read[g].getVertex(i) != nullptr && table.getLabel(read[g].getVertex(i)->getLabel()) == names.getLabel(graphs[g].getVertex(i)->getLabel());
+            }
+        }
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1) << std::setw(12) << time << std::setprecision(0);
+        std::cout << std::setw(14) << graphsCount / time * 1000 << std::defaultfloat << std::setw(10) << table.size() << std::setw(8) << (same ? "yes" : "no") << "\n";
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Graphs of 4 classes planted by their generator, fitted from a binary dataset file by every
+// configuration of the model. Time of stages, throughput and peak resident memory of the fit are
+// printed with accuracy of k-NN (leave one out) and logistic regression (half of every class for
+// training) on graph embeddings. Returns false if accuracy of any configuration is below minimum
+bool benchmarkQuality(double minAccuracy)
+{
+    const unsigned classes = 4, graphsPerClass = 40, minVertices = 10, maxVertices = 20;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(classes * graphsPerClass);
+    std::vector<unsigned> graphClasses(graphs.size());
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphs.size(); g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "graph2vec_bench_quality";
+    std::filesystem::create_directories(dir);
+    writeGraphsBinary(dir / "graphs.bin", graphs);
+    std::cout << graphs.size() << " graphs of " << classes << " classes, " << minVertices << "-" << maxVertices << " vertices, " << countEdges(graphs) << " edges\n";
+    std::cout << std::left << std::setw(16) << "model" << std::right << std::setw(9) << "read" << std::setw(9) << "extract" << std::setw(9) << "context";
+    std::cout << std::setw(9) << "word2vec" << std::setw(9) << "graphs" << std::setw(9) << "total" << std::setw(10) << "graphs/s";
+    std::cout << std::setw(11) << "peak [MB]" << std::setw(8) << "k-NN" << std::setw(8) << "logreg" << "\n";
+    const char * names[] = {"default", "batch 64", "pipeline 4", "hash 1024", "neighbors 4", "degree 1", "update batch 16"};
+    bool passed = true;
+    for (unsigned c = 0; c < sizeof(names) / sizeof(names[0]); c++)
+    {
+        Graph2Vec::Parameters parameters;
+        parameters.degree = 2;
+        parameters.dimensions = 32;
+        parameters.epochs = 10;
+        if (c == 1)
+            parameters.batchSize = 64;
+        else if (c == 2)
+            parameters.queueCapacity = 4;
+        else if (c == 3)
+            parameters.hashBuckets = 1024;
+        else if (c == 4)
+            parameters.sampling.maxNeighbors = 4;
+        else if (c == 5)
+            parameters.degree = 1;
+        else if (c == 6)
+            parameters.updateBatch = 16;
+        Graph2Vec model(parameters);
+        resetPeakMemory();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (! model.fit(dir / "graphs.bin"))
+        {
+            std::filesystem::remove_all(dir);
+            return false;
+        }
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double peakMemory = getPeakMemory();
+        const Graph2Vec::Metrics & metrics = model.getMetrics();
+        double nearestNeighbors = getNearestNeighborsAccuracy(model.getGraphsEmbeddings(), graphClasses, 5);
+        double logisticRegression = getLogisticRegressionAccuracy(model.getGraphsEmbeddings(), graphClasses, classes);
+        std::cout << std::left << std::setw(16) << names[c] << std::right << std::fixed << std::setprecision(3) << std::setw(9) << metrics.readingTime;
+        std::cout << std::setw(9) << metrics.extractionTime << std::setw(9) << metrics.contextTime << std::setw(9) << metrics.word2vecTime;
+        std::cout << std::setw(9) << metrics.trainingTime << std::setw(9) << time << std::setprecision(0) << std::setw(10) << graphs.size() / time;
+        std::cout << std::setprecision(1) << std::setw(11) << peakMemory << std::setprecision(3) << std::setw(8) << nearestNeighbors;
+        std::cout << std::setw(8) << logisticRegression << std::defaultfloat << "\n";
+        if (nearestNeighbors < minAccuracy && logisticRegression < minAccuracy)
+            passed = false;
+        // Counts of rooted subgraphs are what embeddings of the default model are learned from
+        if (c == 0)
+        {
+            std::vector<std::vector<double>> histograms = getSubgraphHistograms(model);
+            std::cout << std::left << std::setw(16) << "WL histogram" << std::right << std::setw(83) << std::fixed << std::setprecision(3);
+            std::cout << getNearestNeighborsAccuracy(histograms, graphClasses, 5) << std::setw(8);
+            std::cout << getLogisticRegressionAccuracy(histograms, graphClasses, classes) << std::defaultfloat << "\n";
+        }
+    }
+    std::cout << "Time of stages in seconds, chance accuracy " << 1.0 / classes << "\n";
+    std::filesystem::remove_all(dir);
+    if (! passed)
+        std::cerr << "Accuracy is below " << minAccuracy << ".\n";
+    return passed;
+}
+
+// Normalized WL subtree kernel of 2000 graphs of the classes of the quality benchmark, computed
+// whole by 1, 2 and 4 threads, and written by blocks. Accuracy is of 5-NN by the kernel (leave one out)
+void benchmarkKernelMatrix()
+{
+    const unsigned classes = 4, graphsCount = 2000, minVertices = 10, maxVertices = 20, k = 5;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    std::vector<unsigned> graphClasses(graphsCount);
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    Graph2Vec::Parameters parameters;
+    parameters.degree = 3;
+    Graph2Vec model(parameters);
+    model.extract(graphs);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SubgraphCounts counts, transposed;
+    getSubgraphCounts(counts, model.getSubgraphMaps(), model.getSubgraphsEmbeddings().size());
+    transposeSubgraphCounts(transposed, counts);
+    double countTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << graphsCount << " graphs, WL degree " << parameters.degree << ", " << counts.columns << " subgraphs, " << counts.subgraphs.size() << " nonzero counts\n";
+    std::cout << std::fixed << std::setprecision(1) << "extraction " << model.getMetrics().extractionTime * 1000 << " ms, counts " << countTime << " ms\n";
+    std::vector<double> kernel;
+    const unsigned threads[] = {1, 2, 4};
+    for (unsigned t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        start = std::chrono::steady_clock::now();
+        getKernelBlock(kernel, counts, transposed, 0, graphsCount, true, threads[t]);
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "kernel by " << threads[t] << " threads " << time << " ms, " << (double) graphsCount * graphsCount / time / 1000 << " M entries/s\n";
+    }
+    std::filesystem::path fileName = std::filesystem::temp_directory_path() / "graph2vec_bench_kernel.txt";
+    start = std::chrono::steady_clock::now();
+    writeKernelMatrix(fileName, counts, true, 4);
+    double writeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "written by blocks of 256 rows " << writeTime << " ms, " << std::filesystem::file_size(fileName) / 1e6 << " MB\n";
+    std::filesystem::remove(fileName);
+    unsigned correct = 0;
+    std::vector<std::pair<double, unsigned>> similarities;
+    for (unsigned i = 0; i < graphsCount; i++)
+    {
+        similarities.clear();
+        for (unsigned j = 0; j < graphsCount; j++)
+            if (j != i)
+                similarities.push_back(std::make_pair(-kernel[(std::size_t) i * graphsCount + j], j));
+        std::partial_sort(similarities.begin(), similarities.begin() + k, similarities.end());
+        std::vector<unsigned> votes(classes, 0);
+        for (unsigned j = 0; j < k; j++)
+            votes[graphClasses[similarities[j].second]]++;
+        correct += std::max_element(votes.cbegin(), votes.cend()) - votes.cbegin() == graphClasses[i];
+    }
+    std::cout << std::setprecision(3) << "5-NN accuracy " << (double) correct / graphsCount << ", chance " << 1.0 / classes << std::defaultfloat << "\n";
+}
+
+// Graphs of the quality benchmark fitted with fixed degree and with adaptive degree, for several
+// maximum degrees. Rooted subgraphs and radial context shrink, once WL relabeling of graphs is stable
+void benchmarkAdaptiveDegree()
+{
+    const unsigned classes = 4, graphsPerClass = 20, minVertices = 10, maxVertices = 20;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(classes * graphsPerClass);
+    std::vector<unsigned> graphClasses(graphs.size());
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphs.size(); g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    std::cout << graphs.size() << " graphs of " << classes << " classes, " << minVertices << "-" << maxVertices << " vertices, " << countEdges(graphs) << " edges\n";
+    std::cout << std::setw(7) << "degree" << std::setw(10) << "adaptive" << std::setw(9) << "stopped" << std::setw(9) << "rooted" << std::setw(11) << "subgraphs";
+    std::cout << std::setw(9) << "extract" << std::setw(9) << "context" << std::setw(10) << "word2vec" << std::setw(8) << "k-NN" << std::setw(8) << "logreg" << "\n";
+    const unsigned degrees[] = {2, 4, 8};
+    for (unsigned d = 0; d < sizeof(degrees) / sizeof(degrees[0]); d++)
+    {
+        for (unsigned adaptive = 0; adaptive < 2; adaptive++)
+        {
+            Graph2Vec::Parameters parameters;
+            parameters.degree = degrees[d];
+            parameters.adaptiveDegree = adaptive;
+            parameters.dimensions = 32;
+            parameters.epochs = 10;
+            Graph2Vec model(parameters);
+            model.fit(graphs);
+            const Graph2Vec::Metrics & metrics = model.getMetrics();
+            std::cout << std::setw(7) << degrees[d] << std::setw(10) << (adaptive ? "yes" : "no") << std::setw(9) << metrics.adaptedGraphs << std::setw(9) << metrics.rootedSubgraphs;
+            std::cout << std::setw(11) << model.getSubgraphsEmbeddings().size() << std::fixed << std::setprecision(3) << std::setw(9) << metrics.extractionTime;
+            std::cout << std::setw(9) << metrics.contextTime << std::setw(10) << metrics.word2vecTime;
+            std::cout << std::setw(8) << getNearestNeighborsAccuracy(model.getGraphsEmbeddings(), graphClasses, 5);
+            std::cout << std::setw(8) << getLogisticRegressionAccuracy(model.getGraphsEmbeddings(), graphClasses, classes) << std::defaultfloat << "\n";
+        }
+    }
+    std::cout << "Time of stages in seconds, chance accuracy " << 1.0 / classes << "\n";
+}
+
+// Every generated graph is in the dataset 4 times with vertices shuffled, so copies are WL-equivalent
+// but not identical. Time of stages and accuracy are compared with and without deduplication
+void benchmarkDeduplication()
+{
+    const unsigned classes = 4, graphsPerClass = 10, copies = 4, minVertices = 10, maxVertices = 20;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs;
+    std::vector<unsigned> graphClasses;
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < classes * graphsPerClass; g++)
+    {
+        Graph graph;
+        getPlantedGraph(graph, g % classes, verticesDist(generator), generator);
+        for (unsigned c = 0; c < copies; c++)
+        {
+            std::vector<unsigned> order(graph.getMaxVertex());
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), generator);
+            graphs.push_back(Graph());
+            reorderGraph(graphs.back(), graph, order);
+            graphClasses.push_back(g % classes);
+        }
+    }
+    std::shuffle(graphs.begin(), graphs.end(), std::mt19937(2));
+    std::shuffle(graphClasses.begin(), graphClasses.end(), std::mt19937(2));
+    std::cout << graphs.size() << " graphs (" << classes * graphsPerClass << " different) of " << classes << " classes, " << minVertices << "-" << maxVertices << " vertices\n";
+    std::cout << std::left << std::setw(16) << "model" << std::right << std::setw(11) << "duplicates" << std::setw(9) << "context" << std::setw(10) << "word2vec";
+    std::cout << std::setw(9) << "graphs" << std::setw(9) << "total" << std::setw(8) << "k-NN" << std::setw(8) << "logreg" << "\n";
+    const char * names[] = {"no dedup", "dedup", "dedup, tune 2"};
+    for (unsigned c = 0; c < sizeof(names) / sizeof(names[0]); c++)
+    {
+        Graph2Vec::Parameters parameters;
+        parameters.degree = 2;
+        parameters.dimensions = 32;
+        parameters.epochs = 10;
+        parameters.deduplicate = c > 0;
+        parameters.fineTuneEpochs = c == 2 ? 2 : 0;
+        Graph2Vec model(parameters);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        model.fit(graphs);
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const Graph2Vec::Metrics & metrics = model.getMetrics();
+        std::cout << std::left << std::setw(16) << names[c] << std::right << std::setw(11) << metrics.duplicateGraphs << std::fixed << std::setprecision(3);
+        std::cout << std::setw(9) << metrics.contextTime << std::setw(10) << metrics.word2vecTime << std::setw(9) << metrics.trainingTime << std::setw(9) << time;
+        std::cout << std::setw(8) << getNearestNeighborsAccuracy(model.getGraphsEmbeddings(), graphClasses, 5);
+        std::cout << std::setw(8) << getLogisticRegressionAccuracy(model.getGraphsEmbeddings(), graphClasses, classes) << std::defaultfloat << "\n";
+    }
+    std::cout << "Time of stages in seconds, chance accuracy " << 1.0 / classes << "\n";
+}
+
+// Rewired ring lattice updated by batches of random insertions and deletions of edges after fit.
+// Time of the update (relabeling, radial context, word2vec of new subgraphs and training of the
+// graph embedding) is compared to fit of the updated graphs from scratch, whose partition of rooted
+// subgraphs must be the same as of the updated maps. The last batch removes vertices (with the last
+// one) and adds them again with other labels and their edges
+void benchmarkDynamicGraphs()
+{
+    const unsigned vertices = 1000, neighbors = 2, labels = 4;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(2);
+    getSmallWorldGraph(graphs[0], vertices, neighbors, labels, generator);
+    getSmallWorldGraph(graphs[1], 100, neighbors, labels, generator);
+    Graph2Vec::Parameters parameters;
+    parameters.degree = 3;
+    parameters.dimensions = 16;
+    parameters.epochs = 1;
+    parameters.dynamicGraphs = true;
+    Graph2Vec model(parameters);
+    model.fit(graphs);
+    const Graph2Vec::Metrics & metrics = model.getMetrics();
+    std::cout << "Graph of " << vertices << " vertices, WL degree " << parameters.degree << ", fit in " << metrics.extractionTime + metrics.contextTime + metrics.word2vecTime + metrics.trainingTime;
+    std::cout << " s (extraction " << metrics.extractionTime * 1000 << " ms)\n";
+    std::cout << std::left << std::setw(10) << "updates" << std::right << std::setw(12) << "relabeled" << std::setw(14) << "update [ms]" << std::setw(15) << "extract [ms]" << std::setw(12) << "refit [ms]";
+    std::cout << std::setw(8) << "ARI" << "\n";
+    std::uniform_int_distribution<unsigned> vertexDist(0, vertices - 1);
+    const unsigned batches[] = {1, 10, 100, 1000}, relabeledVertices = 10;
+    const unsigned batchesCount = sizeof(batches) / sizeof(batches[0]);
+    for (unsigned b = 0; b <= batchesCount; b++)
+    {
+        std::vector<GraphUpdate> updates;
+        std::set<std::pair<unsigned, unsigned>> edges;
+        if (b == batchesCount)
+            getRelabelingUpdates(updates, graphs[0], relabeledVertices, labels, generator);
+        while (b < batchesCount && updates.size() < batches[b])
+        {
+            unsigned u = vertexDist(generator), v = vertexDist(generator);
+            if (u == v || ! edges.emplace(u, v).second)
+                continue;
+            GraphUpdate update;
+            update.type = graphs[0].getEdge(u, v) != nullptr ? removeEdgeUpdate : addEdgeUpdate;
+            update.vertex = u;
+            update.target = v;
+            updates.push_back(update);
+        }
+        unsigned long long relabeled = metrics.relabeledSubgraphs;
+        double updateTime = metrics.updateTime;
+        model.update(0, graphs[0], updates);
+        Graph2Vec exactModel(parameters);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        exactModel.fit(graphs);
+        double refitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::left << std::setw(10) << (b < batchesCount ? std::to_string(batches[b]) : std::to_string(relabeledVertices) + " v") << std::right;
+        std::cout << std::setw(12) << metrics.relabeledSubgraphs - relabeled << std::fixed << std::setprecision(2);
+        std::cout << std::setw(14) << (metrics.updateTime - updateTime) * 1000 << std::setw(15) << exactModel.getMetrics().extractionTime * 1000;
+        std::cout << std::setw(12) << refitTime * 1000 << std::setprecision(3);
+        std::cout << std::setw(8) << getAdjustedRandIndex(getSubgraphPartition(exactModel), getSubgraphPartition(model)) << std::defaultfloat << "\n";
+    }
+}
+
+// Model of generated graphs saved, loaded and appended by 10% of new graphs (new graph classes are
+// the same), against fit of all graphs. Accuracy of the classifiers is on all graph embeddings
+void benchmarkAppend()
+{
+    const unsigned classes = 4, graphsCount = 200, appendedCount = 20, minVertices = 10, maxVertices = 20;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount + appendedCount);
+    std::vector<unsigned> graphClasses(graphs.size());
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphs.size(); g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    Graph2Vec::Parameters parameters;
+    parameters.degree = 2;
+    parameters.dimensions = 32;
+    parameters.epochs = 10;
+    std::filesystem::path modelFile = std::filesystem::temp_directory_path() / "graph2vec_bench_append.json";
+    Graph2Vec fittedModel(parameters);
+    fittedModel.fit(std::vector<Graph>(graphs.cbegin(), graphs.cbegin() + graphsCount));
+    fittedModel.save(modelFile);
+    std::cout << graphsCount << " fitted graphs + " << appendedCount << " appended graphs of " << classes << " classes, " << minVertices << "-" << maxVertices << " vertices\n";
+    std::cout << std::left << std::setw(18) << "model" << std::right << std::setw(10) << "time [s]" << std::setw(12) << "subgraphs" << std::setw(8) << "k-NN";
+    std::cout << std::setw(8) << "logreg" << "\n";
+    const char * names[] = {"fit of all", "append", "append, 100 old"};
+    for (unsigned c = 0; c < sizeof(names) / sizeof(names[0]); c++)
+    {
+        parameters.appendSamples = c == 2 ? 100 : 0;
+        Graph2Vec model(parameters);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (c == 0)
+            model.fit(graphs);
+        else if (model.load(modelFile))
+            model.append(std::vector<Graph>(graphs.cbegin() + graphsCount, graphs.cend()));
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::left << std::setw(18) << names[c] << std::right << std::fixed << std::setprecision(3) << std::setw(10) << time;
+        std::cout << std::setw(12) << model.getSubgraphsEmbeddings().size() << std::setw(8) << getNearestNeighborsAccuracy(model.getGraphsEmbeddings(), graphClasses, 5);
+        std::cout << std::setw(8) << getLogisticRegressionAccuracy(model.getGraphsEmbeddings(), graphClasses, classes) << std::defaultfloat << "\n";
+    }
+    std::filesystem::remove(modelFile);
+}
+
+// Grid of 8 configurations of generated graphs of large degree, fitted one by one (every fit extracts
+// the graphs and makes their context) and by one sweep of 1 and 4 threads. Accuracy of every
+// configuration of the sweep is printed, so the sweep also tunes the model
+void benchmarkSweep()
+{
+    const unsigned classes = 4, graphsCount = 80, minVertices = 40, maxVertices = 80;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    std::vector<unsigned> graphClasses(graphsCount);
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    Graph2Vec::Parameters base;
+    base.degree = 2;
+    base.epochs = 1;
+    base.hashBuckets = 256;
+    std::vector<Graph2Vec::Parameters> grid;
+    parseSweepGrid(grid, "dim=8,32;alpha=0.025,0.1;neg=5,20", base);
+    std::cout << graphsCount << " graphs of " << minVertices << "-" << maxVertices << " vertices, " << grid.size() << " configurations\n";
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double extractionTime = 0, contextTime = 0;
+    for (unsigned i = 0; i < grid.size(); i++)
+    {
+        Graph2Vec model(grid[i]);
+        model.fit(graphs);
+        extractionTime += model.getMetrics().extractionTime;
+        contextTime += model.getMetrics().contextTime;
+    }
+    double separateTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(3) << "fit of every configuration: " << separateTime << " s (extraction " << extractionTime << " s, context " << contextTime << " s)\n";
+    std::vector<Graph2Vec> models;
+    SweepMetrics metrics;
+    const unsigned threads[] = {1, 4};
+    for (unsigned t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        start = std::chrono::steady_clock::now();
+        sweepParameters(models, metrics, graphs, grid, threads[t]);
+        double sweepTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "sweep of " << threads[t] << " threads: " << sweepTime << " s (extraction " << metrics.extractionTime << " s, context " << metrics.contextTime << " s)\n";
+    }
+    std::cout << std::left << std::setw(30) << "configuration" << std::right << std::setw(8) << "k-NN" << std::setw(8) << "logreg" << "\n";
+    for (unsigned i = 0; i < models.size(); i++)
+    {
+        std::cout << std::left << std::setw(30) << getSweepName(models[i].getParameters()) << std::right << std::setw(8);
+        std::cout << getNearestNeighborsAccuracy(models[i].getGraphsEmbeddings(), graphClasses, 5);
+        std::cout << std::setw(8) << getLogisticRegressionAccuracy(models[i].getGraphsEmbeddings(), graphClasses, classes) << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Graph embeddings of generated graph classes trained by 1, 2 and 4 threads, with and without NUMA
+// placement. The model is fitted on a few graphs and loaded by every configuration, which transforms
+// all graphs: subgraphs are hashed into buckets of the model, so nothing is trained by word2vec, and
+// extraction and context take the same time in every configuration. Speedup is against 1 thread
+// without placement, on one node placement falls back to unpinned threads
+void benchmarkNuma()
+{
+    const unsigned classes = 4, graphsCount = 400, fittedGraphs = 8, minVertices = 20, maxVertices = 40;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    std::vector<unsigned> graphClasses(graphsCount);
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    NumaTopology topology;
+    if (getNumaTopology(topology))
+        std::cout << topology.nodes.size() << " NUMA nodes, " << std::thread::hardware_concurrency() << " hardware threads\n";
+    else
+        std::cout << "NUMA topology unknown\n";
+    Graph2Vec::Parameters base;
+    base.degree = 2;
+    base.dimensions = 32;
+    base.epochs = 10;
+    base.hashBuckets = 64;
+    std::filesystem::path modelFile = std::filesystem::temp_directory_path() / "graph2vec_bench_numa.json";
+    Graph2Vec fitted(base);
+    fitted.fit(std::vector<Graph>(graphs.begin(), graphs.begin() + fittedGraphs));
+    fitted.save(modelFile);
+    std::cout << graphsCount << " graphs of " << minVertices << "-" << maxVertices << " vertices transformed by the model of " << fittedGraphs << " of them, ";
+    std::cout << base.epochs << " epochs\n";
+    std::cout << std::setw(8) << "threads" << std::setw(6) << "numa" << std::setw(7) << "nodes" << std::setw(15) << "transform [s]" << std::setw(9) << "speedup" << std::setw(8) << "k-NN" << "\n";
+    double baseTime = 0;
+    for (unsigned numa = 0; numa < 2; numa++)
+    {
+        for (unsigned threads = 1; threads <= 4; threads *= 2)
+        {
+            Graph2Vec::Parameters parameters = base;
+            parameters.threads = threads;
+            parameters.numa = numa == 1;
+            Graph2Vec model(parameters);
+            model.load(modelFile);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::vector<std::vector<double>> embeddings = model.transform(graphs);
+            double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (baseTime == 0)
+                baseTime = time;
+            std::cout << std::setw(8) << threads << std::setw(6) << (parameters.numa ? "yes" : "no") << std::setw(7) << model.getMetrics().numaNodes << std::fixed << std::setprecision(3);
+            std::cout << std::setw(15) << time << std::setprecision(2) << std::setw(9) << baseTime / time;
+            std::cout << std::setw(8) << getNearestNeighborsAccuracy(embeddings, graphClasses, 5) << std::defaultfloat << std::endl;
+        }
+    }
+    std::filesystem::remove(modelFile);
+}
+
+// Fit of graphs of 4 classes planted by their generator with full softmax and hierarchical softmax
+// of word2vec, with a row of every subgraph and with subgraphs hashed into buckets: time of word2vec
+// and accuracy of k-NN (leave one out) and logistic regression on graph embeddings
+void benchmarkObjective()
+{
+    const unsigned classes = 4, graphsCount = 80, minVertices = 40, maxVertices = 80;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    std::vector<unsigned> graphClasses(graphsCount);
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphsCount; g++)
+    {
+        graphClasses[g] = g % classes;
+        getPlantedGraph(graphs[g], graphClasses[g], verticesDist(generator), generator);
+    }
+    const unsigned buckets[] = {0, 256};
+    const Word2VecObjective objectives[] = {fullSoftmax, hierarchicalSoftmax};
+    std::cout << graphsCount << " graphs of " << minVertices << "-" << maxVertices << " vertices\n";
+    std::cout << std::left << std::setw(11) << "objective" << std::right << std::setw(9) << "buckets" << std::setw(11) << "subgraphs";
+    std::cout << std::setw(14) << "word2vec [s]" << std::setw(8) << "k-NN" << std::setw(8) << "logreg" << "\n";
+    for (unsigned b = 0; b < sizeof(buckets) / sizeof(buckets[0]); b++)
+    {
+        for (unsigned o = 0; o < sizeof(objectives) / sizeof(objectives[0]); o++)
+        {
+            Graph2Vec::Parameters parameters;
+            parameters.degree = 2;
+            parameters.dimensions = 16;
+            parameters.epochs = 3;
+            parameters.hashBuckets = buckets[b];
+            parameters.objective = objectives[o];
+            Graph2Vec model(parameters);
+            model.fit(graphs);
+            std::cout << std::left << std::setw(11) << getWord2VecObjectiveName(objectives[o]) << std::right << std::setw(9) << buckets[b];
+            std::cout << std::setw(11) << model.getSubgraphsEmbeddings().size() << std::fixed << std::setprecision(3) << std::setw(14) << model.getMetrics().word2vecTime;
+            std::cout << std::setprecision(2) << std::setw(8) << getNearestNeighborsAccuracy(model.getGraphsEmbeddings(), graphClasses, 5);
+            std::cout << std::setw(8) << getLogisticRegressionAccuracy(model.getGraphsEmbeddings(), graphClasses, classes) << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+// Events of every stage of fit, both objectives on hashed subgraphs. Fit without counters is timed
+// for the cost of counting
+void benchmarkPerfCounters()
+{
+    const unsigned classes = 4, graphsCount = 80, minVertices = 40, maxVertices = 80;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphsCount; g++)
+        getPlantedGraph(graphs[g], g % classes, verticesDist(generator), generator);
+    PerfCounters probe;
+    std::cout << graphsCount << " graphs of " << minVertices << "-" << maxVertices << " vertices, counters ";
+    std::cout << (probe.open() ? "available, n/a where the host does not support the event" : "not available (perf_event_open failed, see /proc/sys/kernel/perf_event_paranoid)") << "\n";
+    probe.close();
+    const Word2VecObjective objectives[] = {fullSoftmax, hierarchicalSoftmax};
+    const char * stages[] = {"extraction", "context", "word2vec", "embeddings"};
+    for (unsigned o = 0; o < sizeof(objectives) / sizeof(objectives[0]); o++)
+    {
+        Graph2Vec::Parameters parameters;
+        parameters.degree = 2;
+        parameters.dimensions = 16;
+        parameters.epochs = 3;
+        parameters.hashBuckets = 256;
+        parameters.objective = objectives[o];
+        Graph2Vec uncounted(parameters);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uncounted.fit(graphs);
+        double uncountedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        parameters.perfCounters = true;
+        Graph2Vec model(parameters);
+        start = std::chrono::steady_clock::now();
+        model.fit(graphs);
+        double countedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nobjective " << getWord2VecObjectiveName(objectives[o]) << ", fit " << std::fixed << std::setprecision(3) << uncountedTime;
+        std::cout << " s, counted " << countedTime << " s" << std::defaultfloat << "\n";
+        std::cout << std::left << std::setw(12) << "stage" << std::right << std::setw(10) << "time [s]";
+        for (unsigned e = 0; e < perfEventsCount; e++)
+            std::cout << std::setw(15) << getPerfEventName((PerfEvent) e);
+        std::cout << std::setw(7) << "IPC" << "\n";
+        const Graph2Vec::Metrics & metrics = model.getMetrics();
+        const double times[] = {metrics.extractionTime, metrics.contextTime, metrics.word2vecTime, metrics.trainingTime};
+        const PerfCounts * counts[] = {&metrics.extractionCounts, &metrics.contextCounts, &metrics.word2vecCounts, &metrics.trainingCounts};
+        for (unsigned s = 0; s < sizeof(stages) / sizeof(stages[0]); s++)
+        {
+            const long long * c = counts[s]->counts;
+            std::cout << std::left << std::setw(12) << stages[s] << std::right << std::fixed << std::setprecision(3) << std::setw(10) << times[s];
+            for (unsigned e = 0; e < perfEventsCount; e++)
+            {
+                if (c[e] < 0)
+                    std::cout << std::setw(15) << "n/a";
+                else
+                    std::cout << std::setw(15) << c[e];
+            }
+            if (c[cyclesEvent] > 0 && c[instructionsEvent] >= 0)
+                std::cout << std::setprecision(2) << std::setw(7) << (double) c[instructionsEvent] / c[cyclesEvent];
+            else
+                std::cout << std::setw(7) << "n/a";
+            std::cout << std::defaultfloat << "\n";
+        }
+    }
+}
+
+// Writer publishes a matrix as often as it can for a second, while reader processes map the segment
+// and check every snapshot in place. Every value of the snapshot of generation g is g, so a snapshot
+// mixing generations is torn. Reading of the same matrix from the output text file is timed for
+// comparison. Returns false if any reader saw a torn snapshot, which was valid
+bool benchmarkSharedEmbeddings()
+{
+    const unsigned rows = 2000, dimensions = 64, readers = 4;
+    const double seconds = 1.0;
+    const char * name = "/graph2vec_bench_shm";
+    SharedEmbeddingsWriter writer;
+    std::vector<std::vector<double>> embeddings(rows, std::vector<double>(dimensions, 2.0));
+    if (! writer.open(name, rows, dimensions) || ! writer.publish(embeddings))
+        return false;
+    int results[2];
+    if (pipe(results) != 0)
+        return false;
+    std::vector<pid_t> children;
+    for (unsigned r = 0; r < readers; r++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(results[0]);
+            SharedReads reads = readSharedEmbeddings(name, seconds);
+            ssize_t written = write(results[1], &reads, sizeof(reads));
+            _exit(written == sizeof(reads) ? 0 : 1);
+        }
+        if (pid > 0)
+            children.push_back(pid);
+    }
+    close(results[1]);
+    unsigned long long published = 0;
+    double publishTime = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+    {
+        double value = writer.getGeneration() + 2;
+        for (unsigned i = 0; i < rows; i++)
+            std::fill(embeddings[i].begin(), embeddings[i].end(), value);
+        std::chrono::steady_clock::time_point publishStart = std::chrono::steady_clock::now();
+        writer.publish(embeddings);
+        publishTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - publishStart).count();
+        published++;
+    }
+    std::vector<SharedReads> reads;
+    SharedReads childReads;
+    while (read(results[0], &childReads, sizeof(childReads)) == sizeof(childReads))
+        reads.push_back(childReads);
+    close(results[0]);
+    for (unsigned r = 0; r < children.size(); r++)
+        waitpid(children[r], nullptr, 0);
+    writer.unlink();
+    std::cout << rows << " x " << dimensions << " embeddings (" << rows * dimensions * sizeof(double) / 1e6 << " MB), " << published << " snapshots published in ";
+    std::cout << seconds << " s, " << publishTime / published * 1e6 << " us per snapshot\n";
+    std::cout << std::left << std::setw(8) << "reader" << std::right << std::setw(11) << "snapshots" << std::setw(13) << "overwritten" << std::setw(7) << "torn";
+    std::cout << std::setw(17) << "in place [us]" << std::setw(12) << "copy [us]" << "\n";
+    unsigned long long torn = 0;
+    for (unsigned r = 0; r < reads.size(); r++)
+    {
+        torn += reads[r].torn;
+        std::cout << std::left << std::setw(8) << r << std::right << std::setw(11) << reads[r].snapshots << std::setw(13) << reads[r].overwritten << std::setw(7) << reads[r].torn;
+        std::cout << std::fixed << std::setprecision(1) << std::setw(17) << reads[r].readTime / std::max(1ULL, reads[r].snapshots + reads[r].overwritten) * 1e6;
+        std::cout << std::setw(12) << reads[r].copyTime / std::max(1ULL, reads[r].copies) * 1e6 << std::defaultfloat << "\n";
+    }
+    // The same matrix through the text file of graph2vec
+    std::filesystem::path textFile = std::filesystem::temp_directory_path() / "graph2vec_bench_shm.txt";
+    start = std::chrono::steady_clock::now();
+    std::ofstream output(textFile);
+    for (unsigned i = 0; i < rows; i++)
+    {
+        output << "Graph no " << i << std::endl;
+        for (unsigned j = 0; j < dimensions; j++)
+            output << "\tx_" << j + 1 << ": " << embeddings[i][j] << std::endl;
+    }
+    output.close();
+    double writeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    std::ifstream input(textFile);
+    std::vector<std::vector<double>> parsed;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::size_t colon = line.find(": ");
+        if (colon == std::string::npos)
+            parsed.push_back(std::vector<double>());
+        else if (! parsed.empty())
+            parsed.back().push_back(std::strtod(line.c_str() + colon + 2, nullptr));
+    }
+    double parseTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::filesystem::remove(textFile);
+    std::cout << std::fixed << std::setprecision(1) << "Text file: written in " << writeTime * 1e3 << " ms, parsed in " << parseTime * 1e3 << " ms (";
+    std::cout << parsed.size() << " rows)" << std::defaultfloat << "\n";
+    std::cout << (reads.size() == readers && torn == 0 ? "No torn snapshots" : "FAILED: torn snapshots or lost readers") << "\n";
+    return reads.size() == readers && torn == 0;
+}
+
+// Reader process of the shared embeddings benchmark, every tenth snapshot is copied too
+SharedReads readSharedEmbeddings(const char * name, double seconds)
+{
+    SharedReads reads;
+    SharedEmbeddingsReader reader;
+    if (! reader.open(name))
+        return reads;
+    SharedEmbeddingsSnapshot snapshot;
+    std::vector<std::vector<double>> copy;
+    std::uint64_t generation;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+    {
+        if (! reader.getSnapshot(snapshot))
+            continue;
+        std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
+        bool uniform = true;
+        for (std::size_t i = 0; i < (std::size_t) snapshot.rows * snapshot.dimensions; i++)
+            uniform = uniform && snapshot.data[i] == snapshot.generation;
+        reads.readTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+        if (! reader.isValid(snapshot))
+        {
+            reads.overwritten++;
+            continue;
+        }
+        reads.snapshots++;
+        reads.torn += ! uniform;
+        if (reads.snapshots % 10 == 0)
+        {
+            readStart = std::chrono::steady_clock::now();
+            if (! reader.copySnapshot(copy, generation))
+                continue;
+            reads.copyTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+            reads.copies++;
+            for (unsigned i = 0; i < copy.size(); i++)
+                reads.torn += std::count(copy[i].cbegin(), copy[i].cend(), (double) generation) != (long) copy[i].size();
+        }
+    }
+    return reads;
+}
+
+// Generated graphs extracted into a temporary cache directory, then from the cache, then with 10% of
+// graphs generated again. Then labels are strings of a label table, first in the order of their
+// numbers and then read in the reverse order (so every label has another number), which must come
+// from the cache too. Subgraphs of every run must be the same as by extraction without cache (up to
+// numbering of IDs, so the partition of rooted subgraphs is compared)
+void benchmarkExtractionCache()
+{
+    const unsigned classes = 4, graphsCount = 1000, minVertices = 50, maxVertices = 100;
+    std::mt19937 generator(1);
+    std::vector<Graph> graphs(graphsCount);
+    std::uniform_int_distribution<unsigned> verticesDist(minVertices, maxVertices);
+    for (unsigned g = 0; g < graphsCount; g++)
+        getPlantedGraph(graphs[g], g % classes, verticesDist(generator), generator);
+    Graph2Vec::Parameters parameters;
+    parameters.degree = 4;
+    std::filesystem::path cache = std::filesystem::temp_directory_path() / "graph2vec_bench_cache";
+    std::filesystem::remove_all(cache);
+    std::cout << graphsCount << " graphs of " << minVertices << "-" << maxVertices << " vertices, WL degree " << parameters.degree << "\n";
+    std::cout << std::left << std::setw(12) << "run" << std::right << std::setw(15) << "extract [ms]" << std::setw(10) << "cached" << std::setw(12) << "subgraphs";
+    std::cout << std::setw(8) << "ARI" << "\n";
+    const char * runs[] = {"no cache", "cold", "warm", "10% changed", "strings", "reordered"};
+    const unsigned labels = 4;
+    std::vector<unsigned> exactPartition;
+    for (unsigned r = 0; r < sizeof(runs) / sizeof(runs[0]); r++)
+    {
+        if (r == 3)
+        {
+            for (unsigned g = 0; g < graphsCount; g += 10)
+            {
+                graphs[g] = Graph();
+                getPlantedGraph(graphs[g], g % classes, verticesDist(generator), generator);
+            }
+            Graph2Vec::Parameters exactParameters = parameters;
+            exactParameters.cache.clear();
+            Graph2Vec model(exactParameters);
+            model.extract(graphs);
+            exactPartition = getSubgraphPartition(model);
+        }
+        if (r > 0)
+            parameters.cache = cache;
+        LabelTable table;
+        if (r == 5)
+        {
+            // Label l of the graphs becomes labels - 1 - l, the table keeps its string "l<l>"
+            for (unsigned g = 0; g < graphsCount; g++)
+            {
+                Graph relabeled;
+                for (unsigned v = 0; v < graphs[g].getMaxVertex(); v++)
+                    if (graphs[g].getVertex(v) != nullptr)
+                        relabeled.addVertex(v, labels - 1 - graphs[g].getVertex(v)->getLabel());
+                for (unsigned v = 0; v < graphs[g].getMaxVertex(); v++)
+                    for (unsigned u = 0; u < graphs[g].getMaxVertex(); u++)
+                        if (graphs[g].getVertex(v) != nullptr && graphs[g].getVertex(u) != nullptr && graphs[g].getEdge(v, u) != nullptr)
+                            relabeled.addEdge(v, u);
+                graphs[g] = relabeled;
+            }
+        }
+        for (unsigned l = 0; l < labels; l++)
+            table.intern("l" + std::to_string(r == 5 ? labels - 1 - l : l));
+        parameters.stringLabels = r >= 4;
+        Graph2Vec model(parameters);
+        model.setLabelTable(table);
+        model.extract(graphs);
+        if (r == 0)
+            exactPartition = getSubgraphPartition(model);
+        std::cout << std::left << std::setw(12) << runs[r] << std::right << std::fixed << std::setprecision(1) << std::setw(15) << model.getMetrics().extractionTime * 1000;
+        std::cout << std::setw(10) << model.getMetrics().cachedGraphs << std::setw(12) << model.getSubgraphsEmbeddings().size() << std::setprecision(3);
+        std::cout << std::setw(8) << getAdjustedRandIndex(exactPartition, getSubgraphPartition(model)) << std::defaultfloat << "\n";
+    }
+    std::size_t files = 0, bytes = 0;
+    for (const std::filesystem::directory_entry & entry : std::filesystem::recursive_directory_iterator(cache))
+    {
+        if (entry.is_regular_file())
+        {
+            files++;
+            bytes += entry.file_size();
+        }
+    }
+    std::cout << "cache of " << files << " files, " << bytes / 1e6 << " MB\n";
+    std::filesystem::remove_all(cache);
+}
+
+// Class 0: preferential attachment, 1: random graph of the same mean degree, 2: ring lattice
+// with rewired edges, all of 4 uniform labels. 3: random graph, label 0 is 5 times more likely
+void getPlantedGraph(Graph & graph, unsigned graphClass, unsigned vertices, std::mt19937 & generator)
+{
+    if (graphClass == 0)
+        getPreferentialAttachmentGraph(graph, vertices, 2, 4, generator);
+    else if (graphClass == 1)
+        getRandomGraph(graph, vertices, 4.0 / (vertices - 1), {1, 1, 1, 1}, generator);
+    else if (graphClass == 2)
+        getSmallWorldGraph(graph, vertices, 2, 4, generator);
+    else
+        getRandomGraph(graph, vertices, 4.0 / (vertices - 1), {5, 1, 1, 1}, generator);
+}
+
+// Undirected graph, every pair of vertices is joined with the probability, label l is drawn with
+// probability proportional to its weight
+void getRandomGraph(Graph & graph, unsigned vertices, double probability, const std::vector<double> & labelWeights, std::mt19937 & generator)
+{
+    std::discrete_distribution<unsigned> labelDist(labelWeights.cbegin(), labelWeights.cend());
+    std::bernoulli_distribution edgeDist(probability);
+    for (unsigned v = 0; v < vertices; v++)
+        graph.addVertex(v, labelDist(generator));
+    for (unsigned v = 0; v < vertices; v++)
+    {
+        for (unsigned u = v + 1; u < vertices; u++)
+        {
+            if (edgeDist(generator))
+            {
+                graph.addEdge(v, u);
+                graph.addEdge(u, v);
+            }
+        }
+    }
+}
+
+// Undirected ring, every vertex joined to the next neighbors vertices, one tenth of the edges is
+// moved to a random vertex
+void getSmallWorldGraph(Graph & graph, unsigned vertices, unsigned neighbors, unsigned labels, std::mt19937 & generator)
+{
+    std::uniform_int_distribution<unsigned> labelDist(0, labels - 1), vertexDist(0, vertices - 1);
+    std::bernoulli_distribution rewire(0.1);
+    for (unsigned v = 0; v < vertices; v++)
+        graph.addVertex(v, labelDist(generator));
+    for (unsigned v = 0; v < vertices; v++)
+    {
+        for (unsigned n = 1; n <= neighbors; n++)
+        {
+            unsigned u = (v + n) % vertices;
+            if (rewire(generator))
+                u = vertexDist(generator);
+            if (u == v || graph.getEdge(v, u) != nullptr)
+                continue;
+            graph.addEdge(v, u);
+            graph.addEdge(u, v);
+        }
+    }
+}
+
+// Row of every fitted graph, number of its rooted subgraphs of every ID
+std::vector<std::vector<double>> getSubgraphHistograms(const Graph2Vec & model)
+{
+    const std::vector<SubgraphMap> & maps = model.getSubgraphMaps();
+    std::vector<std::vector<double>> histograms(maps.size(), std::vector<double>(model.getSubgraphsEmbeddings().size(), 0.0));
+    for (unsigned g = 0; g < maps.size(); g++)
+        for (unsigned v = 0; v < maps[g].rootVertices.size(); v++)
+            for (unsigned d = 0; d < maps[g].rootVertices[v].size(); d++)
+                histograms[g][maps[g].rootVertices[v][d]]++;
+    return histograms;
+}
+
+// Updates removing the vertices (random ones and the last one) and adding them again with the next
+// label and all of their edges, in one batch
+void getRelabelingUpdates(std::vector<GraphUpdate> & updates, const Graph & graph, unsigned count, unsigned labels, std::mt19937 & generator)
+{
+    std::set<unsigned> vertices;
+    vertices.insert(graph.getMaxVertex() - 1);
+    std::uniform_int_distribution<unsigned> vertexDist(0, graph.getMaxVertex() - 1);
+    while (vertices.size() < count)
+    {
+        unsigned v = vertexDist(generator);
+        if (graph.getVertex(v) != nullptr)
+            vertices.insert(v);
+    }
+    GraphUpdate update;
+    for (unsigned v : vertices)
+    {
+        update.type = removeVertexUpdate;
+        update.vertex = v;
+        updates.push_back(update);
+    }
+    for (unsigned v : vertices)
+    {
+        update.type = addVertexUpdate;
+        update.vertex = v;
+        update.label = (graph.getVertex(v)->getLabel() + 1) % labels;
+        updates.push_back(update);
+    }
+    // Edges between two removed vertices are added once
+    std::set<std::pair<unsigned, unsigned>> edges;
+    for (unsigned v : vertices)
+    {
+        for (unsigned u = 0; u < graph.getMaxVertex(); u++)
+        {
+            if (graph.getVertex(u) == nullptr)
+                continue;
+            if (graph.getEdge(v, u) != nullptr)
+                edges.emplace(v, u);
+            if (graph.getEdge(u, v) != nullptr)
+                edges.emplace(u, v);
+        }
+    }
+    for (const std::pair<unsigned, unsigned> & edge : edges)
+    {
+        update.type = addEdgeUpdate;
+        update.vertex = edge.first;
+        update.target = edge.second;
+        updates.push_back(update);
+    }
+}
+
+// Subgraph ID of every degree of every vertex of every graph
+std::vector<unsigned> getSubgraphPartition(const Graph2Vec & model)
+{
+    std::vector<unsigned> partition;
+    const std::vector<SubgraphMap> & maps = model.getSubgraphMaps();
+    for (unsigned g = 0; g < maps.size(); g++)
+        for (unsigned v = 0; v < maps[g].rootVertices.size(); v++)
+            partition.insert(partition.end(), maps[g].rootVertices[v].cbegin(), maps[g].rootVertices[v].cend());
+    return partition;
+}
+
+// Leave one out accuracy of majority vote of k nearest rows by cosine similarity
+double getNearestNeighborsAccuracy(const std::vector<std::vector<double>> & rows, const std::vector<unsigned> & classes, unsigned k)
+{
+    std::vector<double> norms(rows.size());
+    for (unsigned i = 0; i < rows.size(); i++)
+        norms[i] = std::sqrt(std::inner_product(rows[i].cbegin(), rows[i].cend(), rows[i].cbegin(), 0.0)) + 1e-12;
+    unsigned correct = 0;
+    std::vector<std::pair<double, unsigned>> similarities;
+    for (unsigned i = 0; i < rows.size(); i++)
+    {
+        similarities.clear();
+        for (unsigned j = 0; j < rows.size(); j++)
+            if (j != i)
+                similarities.push_back(std::make_pair(-std::inner_product(rows[i].cbegin(), rows[i].cend(), rows[j].cbegin(), 0.0) / (norms[i] * norms[j]), j));
+        unsigned n = std::min<std::size_t>(k, similarities.size());
+        std::partial_sort(similarities.begin(), similarities.begin() + n, similarities.end());
+        std::map<unsigned, unsigned> votes;
+        for (unsigned j = 0; j < n; j++)
+            votes[classes[similarities[j].second]]++;
+        unsigned predicted = 0, maxVotes = 0;
+        for (std::map<unsigned, unsigned>::const_iterator it = votes.cbegin(); it != votes.cend(); it++)
+        {
+            if (it->second > maxVotes)
+            {
+                maxVotes = it->second;
+                predicted = it->first;
+            }
+        }
+        correct += predicted == classes[i];
+    }
+    return (double) correct / rows.size();
+}
+
+// Softmax regression on standardized rows trained by gradient descent on every other row of each
+// class, accuracy on the remaining rows
+double getLogisticRegressionAccuracy(const std::vector<std::vector<double>> & rows, const std::vector<unsigned> & classes, unsigned classesCount)
+{
+    const unsigned iterations = 500;
+    const double rate = 0.5, l2 = 1e-3;
+    unsigned n = rows[0].size();
+    std::vector<double> means(n, 0.0), deviations(n, 0.0);
+    for (unsigned i = 0; i < rows.size(); i++)
+        for (unsigned j = 0; j < n; j++)
+            means[j] += rows[i][j] / rows.size();
+    for (unsigned i = 0; i < rows.size(); i++)
+        for (unsigned j = 0; j < n; j++)
+            deviations[j] += (rows[i][j] - means[j]) * (rows[i][j] - means[j]) / rows.size();
+    std::vector<std::vector<double>> x(rows.size(), std::vector<double>(n + 1, 1.0));
+    for (unsigned i = 0; i < rows.size(); i++)
+        for (unsigned j = 0; j < n; j++)
+            x[i][j] = (rows[i][j] - means[j]) / (std::sqrt(deviations[j]) + 1e-12);
+    std::vector<unsigned> training, testing, seen(classesCount, 0);
+    for (unsigned i = 0; i < rows.size(); i++)
+        (seen[classes[i]]++ % 2 == 0 ? training : testing).push_back(i);
+    std::vector<std::vector<double>> weights(classesCount, std::vector<double>(n + 1, 0.0)), gradient(weights);
+    std::vector<double> scores(classesCount);
+    for (unsigned it = 0; it < iterations; it++)
+    {
+        for (unsigned c = 0; c < classesCount; c++)
+            for (unsigned j = 0; j <= n; j++)
+                gradient[c][j] = l2 * weights[c][j];
+        for (unsigned t = 0; t < training.size(); t++)
+        {
+            const std::vector<double> & row = x[training[t]];
+            double maxScore = -INFINITY, sum = 0;
+            for (unsigned c = 0; c < classesCount; c++)
+            {
+                scores[c] = std::inner_product(row.cbegin(), row.cend(), weights[c].cbegin(), 0.0);
+                maxScore = std::max(maxScore, scores[c]);
+            }
+            for (unsigned c = 0; c < classesCount; c++)
+            {
+                scores[c] = std::exp(scores[c] - maxScore);
+                sum += scores[c];
+            }
+            for (unsigned c = 0; c < classesCount; c++)
+            {
+                double error = scores[c] / sum - (c == classes[training[t]]);
+                for (unsigned j = 0; j <= n; j++)
+                    gradient[c][j] += error * row[j] / training.size();
+            }
+        }
+        for (unsigned c = 0; c < classesCount; c++)
+            for (unsigned j = 0; j <= n; j++)
+                weights[c][j] -= rate * gradient[c][j];
+    }
+    unsigned correct = 0;
+    for (unsigned t = 0; t < testing.size(); t++)
+    {
+        const std::vector<double> & row = x[testing[t]];
+        unsigned predicted = 0;
+        for (unsigned c = 0; c < classesCount; c++)
+        {
+            scores[c] = std::inner_product(row.cbegin(), row.cend(), weights[c].cbegin(), 0.0);
+            if (scores[c] > scores[predicted])
+                predicted = c;
+        }
+        correct += predicted == classes[testing[t]];
+    }
+    return (double) correct / testing.size();
+}
+
+// Peak resident memory of the process is reset on Linux, elsewhere it is the peak since the start
+void resetPeakMemory()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// Peak resident memory in megabytes, since the last reset where available
+double getPeakMemory()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::atof(line.c_str() + 6) / 1024;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+std::size_t countEdges(const std::vector<Graph> & graphs)
+{
+    std::size_t edges = 0;
+    for (unsigned g = 0; g < graphs.size(); g++)
+        for (unsigned i = 0; i < graphs[g].getMaxVertex(); i++)
+            for (unsigned j = 0; j < graphs[g].getMaxVertex(); j++)
+                edges += graphs[g].getEdge(i, j) != nullptr;
+    return edges;
+}
+
+// Undirected graph, every new vertex is joined to edgesPerVertex vertices chosen with probability
+// proportional to their degree
+void getPreferentialAttachmentGraph(Graph & graph, unsigned vertices, unsigned edgesPerVertex, unsigned labels, std::mt19937 & generator)
+{
+    std::uniform_int_distribution<unsigned> labelDist(0, labels - 1);
+    std::vector<unsigned> endpoints; // Every vertex as many times as its degree
+    for (unsigned v = 0; v < vertices; v++)
+        graph.addVertex(v, labelDist(generator));
+    for (unsigned v = 1; v < vertices; v++)
+    {
+        for (unsigned e = 0; e < edgesPerVertex; e++)
+        {
+            unsigned u = endpoints.empty() ? 0 : endpoints[std::uniform_int_distribution<unsigned>(0, endpoints.size() - 1)(generator)];
+            if (u == v || graph.getEdge(v, u) != nullptr)
+                continue;
+            graph.addEdge(v, u);
+            graph.addEdge(u, v);
+            endpoints.push_back(u);
+            endpoints.push_back(v);
+        }
+    }
+}
+
+// Rand index adjusted for chance: 1 for the same partitions, around 0 for independent ones
+double getAdjustedRandIndex(const std::vector<unsigned> & partition1, const std::vector<unsigned> & partition2)
+{
+    std::map<unsigned, double> sizes1, sizes2;
+    std::map<std::pair<unsigned, unsigned>, double> sizes;
+    for (unsigned i = 0; i < partition1.size(); i++)
+    {
+        sizes1[partition1[i]]++;
+        sizes2[partition2[i]]++;
+        sizes[std::make_pair(partition1[i], partition2[i])]++;
+    }
+    double pairs1 = 0, pairs2 = 0, pairsBoth = 0, n = partition1.size();
+    for (std::map<unsigned, double>::const_iterator it = sizes1.cbegin(); it != sizes1.cend(); it++)
+        pairs1 += it->second * (it->second - 1) / 2;
+    for (std::map<unsigned, double>::const_iterator it = sizes2.cbegin(); it != sizes2.cend(); it++)
+        pairs2 += it->second * (it->second - 1) / 2;
+    for (std::map<std::pair<unsigned, unsigned>, double>::const_iterator it = sizes.cbegin(); it != sizes.cend(); it++)
+        pairsBoth += it->second * (it->second - 1) / 2;
+    double expected = pairs1 * pairs2 / (n * (n - 1) / 2), maximum = (pairs1 + pairs2) / 2;
+    if (maximum == expected)
+        return 1;
+    return (pairsBoth - expected) / (maximum - expected);
+}
+
+double timeGraphEmbeddingUpdate(const Kernels & kernels, unsigned n, ExpMethod method)
+{
+    const unsigned k = 20;
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    std::vector<double> embedding(n), subgraph(n), weightedSum(n), scores(k);
+    std::vector<std::vector<double>> rows(k, std::vector<double>(n));
+    std::vector<const double *> rowPointers(k);
+    for (unsigned i = 0; i < n; i++)
+    {
+        embedding[i] = unidist(generator) * 0.1;
+        subgraph[i] = unidist(generator) * 0.1;
+    }
+    for (unsigned j = 0; j < k; j++)
+    {
+        for (unsigned i = 0; i < n; i++)
+            rows[j][i] = unidist(generator) * 0.1;
+        rowPointers[j] = rows[j].data();
+    }
+    unsigned repetitions = 20000000 / (n * k) + 1;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < repetitions; r++)
+    {
+        kernels.batchedDot(embedding.data(), rowPointers.data(), scores.data(), k, n);
+        kernels.softmaxWeightedSum(rowPointers.data(), scores.data(), weightedSum.data(), k, n, method);
+        kernels.scaledAdd(1.0L, embedding.data(), -1e-6, weightedSum.data(), n);
+        kernels.axpy(1e-6, subgraph.data(), embedding.data(), n);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / repetitions;
+}
+
+// Largest difference relative to 1 + |reference|, so values near 0 are compared absolutely
+double relativeDifference(const std::vector<double> & reference, const std::vector<double> & v)
+{
+    double result = 0.0L;
+    for (unsigned i = 0; i < reference.size(); i++)
+        result = std::max(result, std::fabs(reference[i] - v[i]) / (1.0 + std::fabs(reference[i])));
+    return result;
+}
+
+double maxDifference(const std::vector<double> & v1, const std::vector<double> & v2)
+{
+    double result = 0.0L;
+    for (unsigned i = 0; i < v1.size(); i++)
+        result = std::max(result, std::fabs(v1[i] - v2[i]));
+    return result;
+}
@@ -0,0 +1,94 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <condition_variable>
+
+// Occupancy of the queue between two stages of the pipeline: mean and maximum number of items
+// seen by push, and how many times the producer waited for the full queue and the consumer
+// waited for the empty one. A queue full most of the time means the consumer is the bottleneck
+struct QueueStatistics
+{
+    std::string name;
+    unsigned capacity = 0;
+    double meanOccupancy = 0;
+    unsigned maxOccupancy = 0;
+    unsigned items = 0;
+    unsigned fullWaits = 0;
+    unsigned emptyWaits = 0;
+};
+
+// Queue of at most capacity items, push blocks while it is full and pop while it is empty.
+// After close, push fails and pop fails as soon as the queue is empty
+template <typename T> class BoundedQueue
+{
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notFull, notEmpty;
+    bool closed = false;
+    QueueStatistics statistics;
+    double occupancySum = 0;
+public:
+    BoundedQueue(const std::string & name, unsigned capacity)
+    {
+        statistics.name = name;
+        statistics.capacity = capacity > 0 ? capacity : 1;
+    }
+
+    bool push(T && item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.size() >= statistics.capacity && ! closed)
+        {
+            statistics.fullWaits++;
+            notFull.wait(lock, [this]() { return items.size() < statistics.capacity || closed; });
+        }
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        statistics.items++;
+        occupancySum += items.size();
+        if (items.size() > statistics.maxOccupancy)
+            statistics.maxOccupancy = items.size();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T & item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (items.empty() && ! closed)
+        {
+            statistics.emptyWaits++;
+            notEmpty.wait(lock, [this]() { return ! items.empty() || closed; });
+        }
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    QueueStatistics getStatistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        QueueStatistics result = statistics;
+        if (statistics.items > 0)
+            result.meanOccupancy = occupancySum / statistics.items;
+        return result;
+    }
+};
+
+#endif
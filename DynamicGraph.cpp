@@ -0,0 +1,267 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include "DynamicGraph.hpp"
+#include "SubgraphExtract.hpp"
+
+bool parseGraphUpdate(const std::string &, unsigned &, GraphUpdate &, LabelTable *);
+
+bool hasVertex(const Graph &, unsigned);
+
+void touchVertex(unsigned, const Graph &, const NeighborSampling &, std::vector<unsigned> &, std::map<unsigned, std::vector<unsigned>> &);
+
+// Text stream of updates, a line of every update: number of the graph, then "+v <vertex> <label>",
+// "-v <vertex>", "+e <source> <target>" or "-e <source> <target>". Consecutive lines of the same
+// graph are passed to the consumer together. Labels are numbers, or any strings interned by the table
+// if one is given
+bool streamGraphUpdates(const std::filesystem::path & fileName, const GraphUpdateConsumer & consumer, LabelTable * labels)
+{
+    std::ifstream inputFile(fileName);
+    if (! inputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << ".\n";
+        return false;
+    }
+    std::string line;
+    unsigned lineNumber = 0, graphNumber, lastGraphNumber = 0;
+    GraphUpdate update;
+    std::vector<GraphUpdate> updates;
+    while (std::getline(inputFile, line))
+    {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        if (! parseGraphUpdate(line, graphNumber, update, labels))
+        {
+            std::cerr << "Invalid update in line " << lineNumber << " of " << fileName << ".\n";
+            return false;
+        }
+        if (! updates.empty() && graphNumber != lastGraphNumber)
+        {
+            if (! consumer(lastGraphNumber, updates))
+                return true;
+            updates.clear();
+        }
+        lastGraphNumber = graphNumber;
+        updates.push_back(update);
+    }
+    if (! updates.empty())
+        consumer(lastGraphNumber, updates);
+    return true;
+}
+
+// Apply updates to the graph, updates of missing vertices and edges or of existing ones are skipped.
+// touched gets vertices, whose adjacent vertices changed (with added and removed vertices), and
+// adjacent get their adjacent vertices before the first change. Returns the number of updates applied
+unsigned applyGraphUpdates(Graph & graph, const std::vector<GraphUpdate> & updates, const NeighborSampling & sampling, std::vector<unsigned> & touched,
+                           std::map<unsigned, std::vector<unsigned>> & adjacent)
+{
+    touched.clear();
+    adjacent.clear();
+    unsigned applied = 0;
+    std::vector<unsigned> sources;
+    for (unsigned i = 0; i < updates.size(); i++)
+    {
+        const GraphUpdate & update = updates[i];
+        if (update.type == addVertexUpdate)
+        {
+            if (hasVertex(graph, update.vertex))
+            {
+                std::cerr << "Vertex " << update.vertex << " already exists.\n";
+                continue;
+            }
+            touchVertex(update.vertex, graph, sampling, touched, adjacent);
+            graph.addVertex(update.vertex, update.label);
+        }
+        else if (update.type == removeVertexUpdate)
+        {
+            if (! hasVertex(graph, update.vertex))
+            {
+                std::cerr << "Vertex " << update.vertex << " doesn't exist.\n";
+                continue;
+            }
+            // Vertices of edges to the removed vertex lose it from their adjacent vertices
+            getSourceVertices(sources, graph, update.vertex);
+            for (unsigned j = 0; j < sources.size(); j++)
+                touchVertex(sources[j], graph, sampling, touched, adjacent);
+            touchVertex(update.vertex, graph, sampling, touched, adjacent);
+            graph.removeVertex(update.vertex);
+        }
+        else
+        {
+            bool exists = hasVertex(graph, update.vertex) && hasVertex(graph, update.target) && graph.getEdge(update.vertex, update.target) != nullptr;
+            if (! hasVertex(graph, update.vertex) || ! hasVertex(graph, update.target) || exists != (update.type == removeEdgeUpdate))
+            {
+                std::cerr << "Edge (" << update.vertex << " " << update.target << ") cannot be " << (update.type == addEdgeUpdate ? "added" : "removed") << ".\n";
+                continue;
+            }
+            touchVertex(update.vertex, graph, sampling, touched, adjacent);
+            if (update.type == addEdgeUpdate)
+                graph.addEdge(update.vertex, update.target);
+            else
+                graph.removeEdge(update.vertex, update.target);
+        }
+        applied++;
+    }
+    return applied;
+}
+
+// Vertices of edges to the vertex, their subgraphs contain subgraphs of the vertex
+void getSourceVertices(std::vector<unsigned> & sources, const Graph & graph, unsigned vertex)
+{
+    sources.clear();
+    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    {
+        if (graph.getVertex(i) != nullptr && graph.getEdge(i, vertex) != nullptr)
+            sources.push_back(i);
+    }
+}
+
+// Relabel the map after updates of the graph degree by degree. Subgraph of degree d changes only in
+// touched vertices, and in vertices of changed subgraphs of degree d - 1 or of edges to them, so only
+// these vertices get their signatures again (inside the d-hop neighborhood of the updates). changed
+// gets vertices of any subgraph changed. Returns the number of rooted subgraphs relabeled
+unsigned relabelDynamicGraph(SubgraphMap & subgraphMap, std::vector<bool> & changed, SubgraphVocabulary & vocabulary, SubgraphHashing & hashing,
+                             std::vector<std::vector<double>> & subgraphsEmbeddings, const Graph & graph, const std::vector<unsigned> & touched, unsigned degree,
+                             unsigned dimensions, const NeighborSampling & sampling, std::mt19937 & generator)
+{
+    unsigned n = graph.getMaxVertex();
+    subgraphMap.rootVertices.resize(n);
+    changed.assign(n, false);
+    for (unsigned v = 0; v < n; v++)
+    {
+        if (graph.getVertex(v) == nullptr)
+            subgraphMap.rootVertices[v].clear();
+    }
+    unsigned relabeled = 0;
+    std::vector<unsigned> candidates, changedVertices, sources, adjacent, signature;
+    std::vector<bool> candidate(n, false);
+    for (unsigned d = 0; d <= degree; d++)
+    {
+        candidates.clear();
+        for (unsigned i = 0; i < touched.size(); i++)
+        {
+            // A touched vertex may be removed and added again with another label, so even its subgraph of
+            // degree 0 is made again
+            if (touched[i] < n && graph.getVertex(touched[i]) != nullptr && ! candidate[touched[i]])
+            {
+                candidate[touched[i]] = true;
+                candidates.push_back(touched[i]);
+            }
+        }
+        for (unsigned i = 0; i < changedVertices.size(); i++)
+        {
+            getSourceVertices(sources, graph, changedVertices[i]);
+            sources.push_back(changedVertices[i]);
+            for (unsigned j = 0; j < sources.size(); j++)
+            {
+                if (! candidate[sources[j]])
+                {
+                    candidate[sources[j]] = true;
+                    candidates.push_back(sources[j]);
+                }
+            }
+        }
+        // Touched vertices are candidates of every degree above 0, so no more subgraphs change
+        if (candidates.empty() && d > 0)
+            break;
+        changedVertices.clear();
+        for (unsigned i = 0; i < candidates.size(); i++)
+        {
+            unsigned v = candidates[i];
+            candidate[v] = false;
+            getAdjacentVertices(adjacent, graph, v, sampling);
+            getSubgraphSignature(signature, subgraphMap, graph, v, adjacent, d);
+            unsigned subgraphID = getSubgraphID(vocabulary, hashing, subgraphsEmbeddings, signature, d, dimensions, generator);
+            relabeled++;
+            std::vector<unsigned> & degrees = subgraphMap.rootVertices[v];
+            if (degrees.size() > d && degrees[d] == subgraphID)
+                continue;
+            if (degrees.size() > d)
+                degrees[d] = subgraphID;
+            else
+                degrees.push_back(subgraphID);
+            changed[v] = true;
+            changedVertices.push_back(v);
+        }
+    }
+    return relabeled;
+}
+
+// Remove the context, which the subgraphs rooted in the vertex added (look to the radialSkipGramCore),
+// given the map and adjacent vertices at that time. Random context of vertex without adjacent
+// vertices isn't known, so it stays
+void removeRadialContext(RadialContext & context, const SubgraphMap & subgraphMap, unsigned vertex, const std::vector<unsigned> & adjacent, unsigned degree)
+{
+    const std::vector<unsigned> & degrees = subgraphMap.rootVertices[vertex];
+    if (degrees.empty())
+        return;
+    unsigned graphDegree = std::min<unsigned>(degree, degrees.size() - 1);
+    for (unsigned d = 0; d <= graphDegree; d++)
+    {
+        RadialContext::iterator subgraphContext = context.find(degrees[d]);
+        if (subgraphContext == context.end())
+            continue;
+        for (unsigned i = 0; i < adjacent.size(); i++)
+        {
+            if (adjacent[i] == vertex)
+                continue;
+            for (unsigned delta = (d > 0 ? d - 1 : 0); delta <= (d + 1 < graphDegree ? d + 1 : graphDegree); delta++)
+            {
+                std::multiset<unsigned>::iterator it = subgraphContext->second.find(subgraphMap.rootVertices[adjacent[i]][delta]);
+                if (it != subgraphContext->second.end())
+                    subgraphContext->second.erase(it);
+            }
+        }
+    }
+}
+
+bool parseGraphUpdate(const std::string & line, unsigned & graphNumber, GraphUpdate & update, LabelTable * labels)
+{
+    std::istringstream stream(line);
+    std::string type;
+    if (! (stream >> graphNumber >> type >> update.vertex))
+        return false;
+    update.target = 0;
+    update.label = 0;
+    if (type == "+v")
+    {
+        update.type = addVertexUpdate;
+        if (labels == nullptr)
+            return (bool) (stream >> update.label);
+        std::string label;
+        if (! (stream >> label))
+            return false;
+        update.label = labels->intern(label);
+        return true;
+    }
+    if (type == "-v")
+    {
+        update.type = removeVertexUpdate;
+        return true;
+    }
+    if (type == "+e" || type == "-e")
+    {
+        update.type = type == "+e" ? addEdgeUpdate : removeEdgeUpdate;
+        return (bool) (stream >> update.target);
+    }
+    return false;
+}
+
+bool hasVertex(const Graph & graph, unsigned vertex)
+{
+    return vertex < graph.getMaxVertex() && graph.getVertex(vertex) != nullptr;
+}
+
+// Add the vertex to touched vertices, with its adjacent vertices before the first update
+void touchVertex(unsigned vertex, const Graph & graph, const NeighborSampling & sampling, std::vector<unsigned> & touched, std::map<unsigned, std::vector<unsigned>> & adjacent)
+{
+    if (adjacent.count(vertex) > 0)
+        return;
+    std::vector<unsigned> & vertexAdjacent = adjacent[vertex];
+    if (hasVertex(graph, vertex))
+        getAdjacentVertices(vertexAdjacent, graph, vertex, sampling);
+    touched.push_back(vertex);
+}
@@ -0,0 +1,45 @@
+#ifndef DYNAMICGRAPH_HPP
+#define DYNAMICGRAPH_HPP
+
+#include <map>
+#include <vector>
+#include <random>
+#include <functional>
+#include <filesystem>
+#include "Graph.hpp"
+#include "SubgraphMaps.hpp"
+#include "LabelTable.hpp"
+
+enum GraphUpdateType
+{
+    addVertexUpdate,
+    removeVertexUpdate, // Edges of the vertex are removed with it
+    addEdgeUpdate,
+    removeEdgeUpdate
+};
+
+// Insertion or deletion of a vertex or of a directed edge of a dynamic graph
+struct GraphUpdate
+{
+    GraphUpdateType type;
+    unsigned vertex; // Added or removed vertex, source of the edge
+    unsigned target = 0; // Target of the edge
+    unsigned label = 0; // Label of added vertex
+};
+
+// Receives updates of one graph (consecutive lines of the stream of the same graph): number of the
+// graph and its updates. Returns false to stop reading
+typedef std::function<bool(unsigned, const std::vector<GraphUpdate> &)> GraphUpdateConsumer;
+
+bool streamGraphUpdates(const std::filesystem::path &, const GraphUpdateConsumer &, LabelTable * = nullptr);
+
+unsigned applyGraphUpdates(Graph &, const std::vector<GraphUpdate> &, const NeighborSampling &, std::vector<unsigned> &, std::map<unsigned, std::vector<unsigned>> &);
+
+void getSourceVertices(std::vector<unsigned> &, const Graph &, unsigned);
+
+unsigned relabelDynamicGraph(SubgraphMap &, std::vector<bool> &, SubgraphVocabulary &, SubgraphHashing &, std::vector<std::vector<double>> &, const Graph &,
+                             const std::vector<unsigned> &, unsigned, unsigned, const NeighborSampling &, std::mt19937 &);
+
+void removeRadialContext(RadialContext &, const SubgraphMap &, unsigned, const std::vector<unsigned> &, unsigned);
+
+#endif
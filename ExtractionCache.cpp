@@ -0,0 +1,227 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <unordered_map>
+#include <algorithm>
+#include "ExtractionCache.hpp"
+#include "SubgraphExtract.hpp"
+
+std::uint64_t mixHash(std::uint64_t, std::uint64_t);
+
+std::uint64_t getLabelHash(const Graph &, unsigned, const LabelTable *);
+
+const std::uint32_t cacheMagic = 0x43325647; // "GV2C" in little endian
+
+const std::uint32_t cacheVersion = 1;
+
+// Hash of numbers and labels of vertices and of edges, equal graphs have equal hashes. Labels of the
+// table are hashed by their strings, so the hash doesn't depend on their numbers in the dataset
+std::uint64_t getGraphHash(const Graph & graph, const LabelTable * labels)
+{
+    std::uint64_t h = mixHash(0, graph.getMaxVertex());
+    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    {
+        if (graph.getVertex(i) == nullptr)
+            continue;
+        h = mixHash(mixHash(h, i), getLabelHash(graph, i, labels));
+        for (unsigned j = 0; j < graph.getMaxVertex(); j++)
+        {
+            if (graph.getEdge(i, j) != nullptr)
+                h = mixHash(h, (std::uint64_t) i << 32 | j);
+        }
+    }
+    return h;
+}
+
+// Hash of the parameters, which change maps of subgraphs (dimensions only change embeddings)
+std::uint64_t getExtractionKey(unsigned degree, bool adaptiveDegree, unsigned hashBuckets, const NeighborSampling & sampling)
+{
+    std::uint64_t h = mixHash(cacheVersion, degree);
+    h = mixHash(h, adaptiveDegree);
+    h = mixHash(h, hashBuckets);
+    h = mixHash(h, sampling.maxNeighbors);
+    return mixHash(h, sampling.maxNeighbors > 0 ? sampling.seed : 0);
+}
+
+// File of the graph is <cache>/<key of parameters>/<hash of graph>.bin
+std::filesystem::path getCachePath(const std::filesystem::path & cache, std::uint64_t key, std::uint64_t graphHash)
+{
+    std::ostringstream keyName, graphName;
+    keyName << std::hex << std::setw(16) << std::setfill('0') << key;
+    graphName << std::hex << std::setw(16) << std::setfill('0') << graphHash << ".bin";
+    return cache / keyName.str() / graphName.str();
+}
+
+// Subgraphs of the map numbered by degree and first occurrence, with signatures of these numbers
+void getCachedSubgraphs(CachedSubgraphs & cached, const SubgraphMap & subgraphMap, const Graph & graph, unsigned degree, const NeighborSampling & sampling)
+{
+    cached.degrees.clear();
+    cached.signatures.clear();
+    cached.rootVertices.assign(subgraphMap.rootVertices.size(), std::vector<unsigned>());
+    // Local number of (degree, subgraph ID), IDs of hashed subgraphs are the same at different degrees
+    std::unordered_map<std::uint64_t, unsigned> numbers;
+    std::vector<unsigned> adjacent, signature;
+    for (unsigned d = 0; d <= degree; d++)
+    {
+        for (unsigned v = 0; v < subgraphMap.rootVertices.size(); v++)
+        {
+            if (subgraphMap.rootVertices[v].size() <= d)
+                continue;
+            std::uint64_t key = (std::uint64_t) d << 32 | subgraphMap.rootVertices[v][d];
+            std::unordered_map<std::uint64_t, unsigned>::const_iterator it = numbers.find(key);
+            if (it == numbers.cend())
+            {
+                getAdjacentVertices(adjacent, graph, v, sampling);
+                getSubgraphSignature(signature, subgraphMap, graph, v, adjacent, d);
+                if (d > 0)
+                {
+                    for (unsigned i = 0; i < signature.size(); i++)
+                        signature[i] = numbers[(std::uint64_t) (d - 1) << 32 | signature[i]];
+                }
+                it = numbers.emplace(key, cached.degrees.size()).first;
+                cached.degrees.push_back(d);
+                cached.signatures.push_back(signature);
+            }
+            cached.rootVertices[v].push_back(it->second);
+        }
+    }
+}
+
+// Map of subgraphs of the cached graph with IDs of the vocabulary. Subgraphs go by degree, so IDs of
+// subgraphs of signature are known, and new subgraphs are added to the vocabulary as by extraction
+void replayCachedSubgraphs(SubgraphMap & subgraphMap, const CachedSubgraphs & cached, const Graph & graph, SubgraphVocabulary & vocabulary,
+                           SubgraphHashing & hashing, std::vector<std::vector<double>> & subgraphsEmbeddings, unsigned dimensions, std::mt19937 & generator)
+{
+    std::vector<unsigned> ids(cached.degrees.size()), signature;
+    // Subgraph of degree 0 is the label of its vertices in the graph
+    std::vector<unsigned> labels(cached.degrees.size());
+    for (unsigned v = 0; v < cached.rootVertices.size(); v++)
+    {
+        if (! cached.rootVertices[v].empty() && v < graph.getMaxVertex() && graph.getVertex(v) != nullptr)
+            labels[cached.rootVertices[v][0]] = graph.getVertex(v)->getLabel();
+    }
+    for (unsigned i = 0; i < cached.degrees.size(); i++)
+    {
+        signature = cached.signatures[i];
+        if (cached.degrees[i] == 0)
+            signature.assign(1, labels[i]);
+        else
+        {
+            for (unsigned j = 0; j < signature.size(); j++)
+                signature[j] = ids[signature[j]];
+            // IDs of adjacent subgraphs are sorted, as in getSubgraphSignature
+            std::sort(signature.begin() + 1, signature.end());
+        }
+        ids[i] = getSubgraphID(vocabulary, hashing, subgraphsEmbeddings, signature, cached.degrees[i], dimensions, generator);
+    }
+    subgraphMap.rootVertices.assign(cached.rootVertices.size(), std::vector<unsigned>());
+    for (unsigned v = 0; v < cached.rootVertices.size(); v++)
+    {
+        for (unsigned d = 0; d < cached.rootVertices[v].size(); d++)
+            subgraphMap.rootVertices[v].push_back(ids[cached.rootVertices[v][d]]);
+    }
+}
+
+// Written to a temporary file first and renamed, so that a file of the cache is always complete
+bool writeCachedSubgraphs(const std::filesystem::path & fileName, const CachedSubgraphs & cached)
+{
+    std::vector<std::uint32_t> data = {cacheMagic, cacheVersion, (std::uint32_t) cached.degrees.size(), (std::uint32_t) cached.rootVertices.size()};
+    for (unsigned i = 0; i < cached.degrees.size(); i++)
+    {
+        data.push_back(cached.degrees[i]);
+        data.push_back(cached.signatures[i].size());
+        data.insert(data.end(), cached.signatures[i].cbegin(), cached.signatures[i].cend());
+    }
+    for (unsigned v = 0; v < cached.rootVertices.size(); v++)
+    {
+        data.push_back(cached.rootVertices[v].size());
+        data.insert(data.end(), cached.rootVertices[v].cbegin(), cached.rootVertices[v].cend());
+    }
+    std::error_code error;
+    std::filesystem::create_directories(fileName.parent_path(), error);
+    std::filesystem::path temporaryName = fileName;
+    temporaryName += ".tmp";
+    std::ofstream file(temporaryName, std::ios::binary);
+    if (! file.is_open())
+    {
+        std::cerr << "Cannot open " << temporaryName << " for writing.\n";
+        return false;
+    }
+    file.write((const char *) data.data(), data.size() * sizeof(std::uint32_t));
+    file.close();
+    if (! file.good())
+    {
+        std::cerr << "Failed to write " << temporaryName << ".\n";
+        return false;
+    }
+    std::filesystem::rename(temporaryName, fileName, error);
+    return ! error;
+}
+
+bool readCachedSubgraphs(const std::filesystem::path & fileName, CachedSubgraphs & cached)
+{
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (! file.is_open())
+        return false;
+    std::vector<std::uint32_t> data(file.tellg() / sizeof(std::uint32_t));
+    file.seekg(0);
+    if (data.size() < 4 || ! file.read((char *) data.data(), data.size() * sizeof(std::uint32_t)) || data[0] != cacheMagic || data[1] != cacheVersion)
+        return false;
+    std::size_t position = 4;
+    cached.degrees.assign(data[2], 0);
+    cached.signatures.assign(data[2], std::vector<unsigned>());
+    cached.rootVertices.assign(data[3], std::vector<unsigned>());
+    for (unsigned i = 0; i < cached.degrees.size(); i++)
+    {
+        if (position + 2 > data.size() || position + 2 + data[position + 1] > data.size())
+            return false;
+        cached.degrees[i] = data[position];
+        cached.signatures[i].assign(data.cbegin() + position + 2, data.cbegin() + position + 2 + data[position + 1]);
+        position += 2 + data[position + 1];
+        // Subgraphs of signature must be cached before
+        if (cached.degrees[i] > 0)
+        {
+            for (unsigned j = 0; j < cached.signatures[i].size(); j++)
+                if (cached.signatures[i][j] >= i)
+                    return false;
+        }
+    }
+    for (unsigned v = 0; v < cached.rootVertices.size(); v++)
+    {
+        if (position + 1 > data.size() || position + 1 + data[position] > data.size())
+            return false;
+        cached.rootVertices[v].assign(data.cbegin() + position + 1, data.cbegin() + position + 1 + data[position]);
+        position += 1 + data[position];
+        for (unsigned d = 0; d < cached.rootVertices[v].size(); d++)
+            if (cached.rootVertices[v][d] >= cached.degrees.size())
+                return false;
+    }
+    return position == data.size();
+}
+
+// Label of the vertex, by its string if the table has it, 8 characters at a time
+std::uint64_t getLabelHash(const Graph & graph, unsigned vertex, const LabelTable * labels)
+{
+    unsigned number = graph.getVertex(vertex)->getLabel();
+    std::string label;
+    if (labels == nullptr || ! labels->copyLabel(number, label))
+        return number;
+    std::uint64_t h = mixHash(1, label.size());
+    for (std::size_t i = 0; i < label.size(); i += 8)
+    {
+        std::uint64_t chunk = 0;
+        for (std::size_t j = i; j < std::min(i + 8, label.size()); j++)
+            chunk |= (std::uint64_t) (unsigned char) label[j] << 8 * (j - i);
+        h = mixHash(h, chunk);
+    }
+    return h;
+}
+
+std::uint64_t mixHash(std::uint64_t h, std::uint64_t value)
+{
+    h = (h ^ value) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
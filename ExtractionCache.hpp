@@ -0,0 +1,37 @@
+#ifndef EXTRACTIONCACHE_HPP
+#define EXTRACTIONCACHE_HPP
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <filesystem>
+#include "Graph.hpp"
+#include "SubgraphMaps.hpp"
+#include "LabelTable.hpp"
+
+// Rooted subgraphs of one graph independent of the vocabulary: subgraph i of the graph has degree
+// degrees[i] and signature signatures[i], in which IDs of subgraphs are replaced by their numbers
+// in the graph (label stays for degree 0, it's taken from the graph again when replayed, as numbers
+// of string labels depend on the dataset). rootVertices are maps of subgraphs by these numbers
+struct CachedSubgraphs
+{
+    std::vector<unsigned> degrees;
+    std::vector<std::vector<unsigned>> signatures;
+    std::vector<std::vector<unsigned>> rootVertices;
+};
+
+std::uint64_t getGraphHash(const Graph &, const LabelTable * = nullptr);
+
+std::uint64_t getExtractionKey(unsigned, bool, unsigned, const NeighborSampling &);
+
+std::filesystem::path getCachePath(const std::filesystem::path &, std::uint64_t, std::uint64_t);
+
+void getCachedSubgraphs(CachedSubgraphs &, const SubgraphMap &, const Graph &, unsigned, const NeighborSampling &);
+
+void replayCachedSubgraphs(SubgraphMap &, const CachedSubgraphs &, const Graph &, SubgraphVocabulary &, SubgraphHashing &, std::vector<std::vector<double>> &, unsigned, std::mt19937 &);
+
+bool writeCachedSubgraphs(const std::filesystem::path &, const CachedSubgraphs &);
+
+bool readCachedSubgraphs(const std::filesystem::path &, CachedSubgraphs &);
+
+#endif
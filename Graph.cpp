@@ -1,4 +1,5 @@
 #include <vector>
+#include <utility>
 #include <iostream>
 #include "Graph.hpp"
 
@@ -71,7 +72,7 @@ Graph::Graph(const Graph & g) : numberOfVertices(g.numberOfVertices), numberOfEd
     }
 }
 
-Graph::Graph(Graph && temp)
+Graph::Graph(Graph && temp) : numberOfVertices(temp.numberOfVertices), numberOfEdges(temp.numberOfEdges)
 {
     for (unsigned i = 0; i < temp.vertices.size(); i++)
     {
@@ -102,6 +103,15 @@ Graph::~Graph()
         delete vertices[i];
 }
 
+Graph & Graph::operator=(Graph && temp)
+{
+    std::swap(vertices, temp.vertices);
+    std::swap(adjacencyMatrix, temp.adjacencyMatrix);
+    std::swap(numberOfVertices, temp.numberOfVertices);
+    std::swap(numberOfEdges, temp.numberOfEdges);
+    return *this;
+}
+
 Graph & Graph::operator=(const Graph & g)
 {
     if (this == &g)
@@ -256,23 +266,20 @@ void Graph::removeVertex(unsigned n)
     numberOfVertices--;
     if (n == getMaxVertex() - 1)
     {
-        unsigned i = n;
-        while (vertices[i] == nullptr)
-        {
+        // Trailing removed vertices are dropped, all of them if the graph has no vertex left
+        while (! vertices.empty() && vertices.back() == nullptr)
             vertices.pop_back();
-            i--;
-        }
-        for (unsigned j = n; j > i; j--)
+        while (adjacencyMatrix.size() > vertices.size())
         {
-            for (unsigned k = 0; k < adjacencyMatrix.size(); k++)
-                delete adjacencyMatrix[j][k];
+            for (unsigned k = 0; k < adjacencyMatrix.back().size(); k++)
+                delete adjacencyMatrix.back()[k];
             adjacencyMatrix.pop_back();
         }
-        for (unsigned j = n; j > i; j--)
+        for (unsigned k = 0; k < adjacencyMatrix.size(); k++)
         {
-            for (unsigned k = 0; k < adjacencyMatrix.size(); k++)
+            while (adjacencyMatrix[k].size() > vertices.size())
             {
-                delete adjacencyMatrix[k][j];
+                delete adjacencyMatrix[k].back();
                 adjacencyMatrix[k].pop_back();
             }
         }
@@ -37,6 +37,7 @@ public:
     Graph(Graph &&);
     ~Graph();
     Graph & operator=(const Graph &);
+    Graph & operator=(Graph &&);
     unsigned getNumberOfVertices() const;
     unsigned getNumberOfEdges() const;
     unsigned getMaxVertex() const;
@@ -0,0 +1,1535 @@
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <filesystem>
+#include <json/json.h>
+#include "Graph.hpp"
+#include "Graph2Vec.hpp"
+#include "GraphBatch.hpp"
+#include "GraphReader.hpp"
+#include "BoundedQueue.hpp"
+#include "word2vec.hpp"
+#include "SubgraphMaps.hpp"
+#include "SubgraphExtract.hpp"
+#include "GraphEmbedding.hpp"
+#include "ExtractionCache.hpp"
+#include "WLKernel.hpp"
+#include "Numa.hpp"
+
+Json::Value subgraphMapToJSON(const SubgraphMap &, const std::vector<std::vector<double>> *);
+
+bool subgraphMapFromJSON(const Json::Value &, SubgraphMap &, std::vector<std::vector<double>> *);
+
+std::vector<unsigned> getNewSubgraphs(const SubgraphMap &, std::vector<bool> &);
+
+double getSeconds(std::chrono::steady_clock::time_point);
+
+// Graph passing through the stages of pipelined fit, with its map of subgraphs and the
+// embeddings of subgraphs, which got their IDs in this graph
+struct PipelineItem
+{
+    unsigned graphNumber;
+    std::unique_ptr<Graph> graph;
+    std::vector<unsigned> vertexNumbers;
+    SubgraphMap subgraphMap;
+    std::vector<std::vector<double>> newSubgraphs;
+};
+
+Graph2Vec::Graph2Vec() : generator(std::random_device()()) {}
+
+Graph2Vec::Graph2Vec(const Parameters & p) : parameters(p), generator(std::random_device()()) {}
+
+const Graph2Vec::Parameters & Graph2Vec::getParameters() const
+{
+    return parameters;
+}
+
+const std::vector<SubgraphMap> & Graph2Vec::getSubgraphMaps() const
+{
+    return subgraphMaps;
+}
+
+const SubgraphVocabulary & Graph2Vec::getSubgraphVocabulary() const
+{
+    return subgraphVocabulary;
+}
+
+const std::vector<std::vector<double>> & Graph2Vec::getSubgraphsEmbeddings() const
+{
+    return subgraphsEmbeddings;
+}
+
+const std::vector<std::vector<double>> & Graph2Vec::getGraphsEmbeddings() const
+{
+    return graphsEmbeddings;
+}
+
+const std::vector<QueueStatistics> & Graph2Vec::getPipelineStatistics() const
+{
+    return pipelineStatistics;
+}
+
+const Graph2Vec::Metrics & Graph2Vec::getMetrics() const
+{
+    return metrics;
+}
+
+// With vertexOrder, vertex j of maps of subgraphs of graph i is vertex vertexNumbers[i][j] of the dataset
+const std::vector<std::vector<unsigned>> & Graph2Vec::getVertexNumbers() const
+{
+    return vertexNumbers;
+}
+
+// With deduplication graph i got the embedding of graph representatives[i], which was trained
+const std::vector<unsigned> & Graph2Vec::getRepresentatives() const
+{
+    return representatives;
+}
+
+// With dynamic graphs number of rooted subgraphs of every ID in maps of the fitted graphs
+const std::vector<unsigned> & Graph2Vec::getSubgraphOccurrences() const
+{
+    return subgraphOccurrences;
+}
+
+// Numbers of string labels of graphs read from dataset (the table is kept by clear, graphs are read before it)
+const LabelTable & Graph2Vec::getLabelTable() const
+{
+    return labelTable;
+}
+
+// Table of graphs read by the caller with string labels, for transform and for the saved model
+void Graph2Vec::setLabelTable(const LabelTable & table)
+{
+    labelTable = table;
+}
+
+// Forget fitted graphs. With feature hashing all rows of subgraph embeddings are made at once
+void Graph2Vec::clear()
+{
+    subgraphMaps.clear();
+    subgraphVocabulary.clear();
+    subgraphsEmbeddings.clear();
+    graphsEmbeddings.clear();
+    vertexNumbers.clear();
+    representatives.clear();
+    radialContext.clear();
+    subgraphOccurrences.clear();
+    metrics = Metrics();
+    subgraphHashing = SubgraphHashing();
+    subgraphHashing.buckets = parameters.hashBuckets;
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    subgraphsEmbeddings.resize(parameters.hashBuckets, std::vector<double>(parameters.dimensions));
+    for (unsigned i = 0; i < subgraphsEmbeddings.size(); i++)
+    {
+        for (unsigned j = 0; j < parameters.dimensions; j++)
+            subgraphsEmbeddings[i][j] = unidist(generator);
+    }
+}
+
+// Table interning labels of graphs read from dataset, none for labels of numbers
+LabelTable * Graph2Vec::getReadLabels()
+{
+    return parameters.stringLabels ? &labelTable : nullptr;
+}
+
+bool Graph2Vec::fit(const std::vector<Graph> & graphs)
+{
+    if (graphs.size() < 2)
+    {
+        std::cerr << "Too few graphs to fit the model (at least 2).\n";
+        return false;
+    }
+    extract(graphs);
+    deduplicateGraphs();
+    RadialContext subgraphContext; // Look to the SubgraphMaps.hpp
+    // Now radial context of every rooted subgraph is being set, like in subgraph2vec algorithm
+    // Duplicate graphs add nothing to context and have no new subgraphs
+    PerfCounters counters;
+    bool counting = parameters.perfCounters && counters.open();
+    if (counting)
+        counters.start();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        if (representatives.empty() || representatives[i] == i)
+            radialSkipGramGraph(subgraphContext, subgraphMaps[i], graphs[i], parameters.degree, parameters.sampling, generator);
+    }
+    metrics.contextTime = getSeconds(start);
+    if (counting)
+        metrics.contextCounts = counters.stop();
+    keepDynamicState(subgraphContext);
+    trainModel(parameters.dynamicGraphs ? radialContext : subgraphContext);
+    return true;
+}
+
+// Fit from subgraphs extracted by another model (by extract) and their radial context, so that models
+// of different training parameters (dimensions, epochs, alpha, negSamples, updateBatch) share one
+// extraction and context. Maps, vocabulary and labels are copied, subgraphs get random rows of the
+// dimensions of this model. Parameters of extraction must be the same, dynamicGraphs isn't supported
+bool Graph2Vec::fit(const Graph2Vec & extracted, const RadialContext & context)
+{
+    const Parameters & p = extracted.parameters;
+    if (extracted.subgraphMaps.size() < 2)
+    {
+        std::cerr << "Too few extracted graphs to fit the model (at least 2).\n";
+        return false;
+    }
+    if (p.degree != parameters.degree || p.adaptiveDegree != parameters.adaptiveDegree || p.hashBuckets != parameters.hashBuckets
+        || p.sampling.maxNeighbors != parameters.sampling.maxNeighbors || p.sampling.seed != parameters.sampling.seed || p.stringLabels != parameters.stringLabels
+        || p.vertexOrder != parameters.vertexOrder || parameters.dynamicGraphs)
+    {
+        std::cerr << "Parameters of extraction differ from the extracted model.\n";
+        return false;
+    }
+    clear();
+    subgraphMaps = extracted.subgraphMaps;
+    subgraphVocabulary = extracted.subgraphVocabulary;
+    subgraphHashing = extracted.subgraphHashing;
+    vertexNumbers = extracted.vertexNumbers;
+    labelTable = extracted.labelTable;
+    metrics = extracted.metrics;
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    subgraphsEmbeddings.assign(extracted.subgraphsEmbeddings.size(), std::vector<double>(parameters.dimensions));
+    for (unsigned i = 0; i < subgraphsEmbeddings.size(); i++)
+    {
+        for (unsigned j = 0; j < parameters.dimensions; j++)
+            subgraphsEmbeddings[i][j] = unidist(generator);
+    }
+    deduplicateGraphs();
+    trainModel(context);
+    return true;
+}
+
+// word2vec of subgraphs and training of graph embeddings of extracted graphs with the context
+void Graph2Vec::trainModel(const RadialContext & context)
+{
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    // Initialization of embeddings matrix by random real values
+    graphsEmbeddings.assign(subgraphMaps.size(), std::vector<double>(parameters.dimensions));
+    for (unsigned i = 0; i < graphsEmbeddings.size(); i++)
+    {
+        for (unsigned j = 0; j < parameters.dimensions; j++)
+            graphsEmbeddings[i][j] = unidist(generator);
+    }
+    std::vector<bool> trainedGraphs(subgraphMaps.size());
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+        trainedGraphs[i] = representatives.empty() || representatives[i] == i;
+    // Now we call word2vec algorithm in order to make vector representations of rooted subgraphs,
+    // every subgraph is trained together with the subgraphs of the first graph it appears in
+    PerfCounters counters;
+    bool counting = parameters.perfCounters && counters.open();
+    if (counting)
+        counters.start();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<bool> trained(subgraphsEmbeddings.size(), false);
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+    {
+        if (! trainedGraphs[i])
+            continue;
+        if (parameters.verbose)
+            std::cout << "word2vec for subgraphs of Graph no " << i << std::endl;
+        word2vec(subgraphsEmbeddings, getNewSubgraphs(subgraphMaps[i], trained), context, parameters.dimensions,
+                 parameters.epochs, parameters.alpha, generator, parameters.objective, parameters.expMethod);
+    }
+    metrics.word2vecTime = getSeconds(start);
+    if (counting)
+        metrics.word2vecCounts = counters.stop();
+    writeWorkspace(0);
+    if (counting)
+        counters.start();
+    start = std::chrono::steady_clock::now();
+    trainGraphsEmbeddings(subgraphMaps, graphsEmbeddings, trainedGraphs, parameters.epochs);
+    shareGraphsEmbeddings();
+    metrics.trainingTime = getSeconds(start);
+    if (counting)
+        metrics.trainingCounts = counters.stop();
+    if (parameters.verbose)
+        printMetrics();
+}
+
+// Only extract rooted subgraphs and assign to them ID, unless maps of the previous run are in workspace.
+// Nothing is trained, maps of subgraphs are the counts of WL features of graphs (WLKernel.hpp)
+void Graph2Vec::extract(const std::vector<Graph> & graphs)
+{
+    clear();
+    PerfCounters counters;
+    bool counting = parameters.perfCounters && counters.open();
+    if (counting)
+        counters.start();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (! readWorkspace(graphs))
+        extractSubgraphs(graphs, subgraphMaps, 0);
+    collectHashingMetrics();
+    metrics.extractionTime = getSeconds(start);
+    if (counting)
+        metrics.extractionCounts = counters.stop();
+}
+
+bool Graph2Vec::extract(const std::filesystem::path & dataset)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Graph> graphs;
+    labelTable.clear();
+    if (! readGraphs(dataset, graphs, getReadLabels()))
+        return false;
+    double readingTime = getSeconds(start);
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<unsigned>> numbers(graphs.size());
+    for (unsigned i = 0; i < graphs.size(); i++)
+        reorderVertices(graphs[i], numbers[i]);
+    double reorderingTime = getSeconds(start);
+    extract(graphs);
+    metrics.readingTime = readingTime;
+    metrics.reorderingTime = reorderingTime;
+    if (parameters.vertexOrder != originalOrder)
+        vertexNumbers = numbers;
+    return true;
+}
+
+// Fit the graphs of the dataset in any format of readGraphs (GraphReader.hpp). With queueCapacity > 0
+// reading, extraction of subgraphs and their training run at once, otherwise all graphs are read first
+bool Graph2Vec::fit(const std::filesystem::path & dataset)
+{
+    if (parameters.queueCapacity > 0)
+        return fitPipelined(dataset);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Graph> graphs;
+    labelTable.clear();
+    if (! readGraphs(dataset, graphs, getReadLabels()))
+        return false;
+    double readingTime = getSeconds(start);
+    if (parameters.verbose)
+        std::cout << graphs.size() << " graphs read in " << readingTime << " s" << std::endl;
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<unsigned>> numbers(graphs.size());
+    for (unsigned i = 0; i < graphs.size(); i++)
+        reorderVertices(graphs[i], numbers[i]);
+    double reorderingTime = getSeconds(start);
+    // Metrics are reset by the fit of graphs
+    bool result = fit(graphs);
+    metrics.readingTime = readingTime;
+    metrics.reorderingTime = reorderingTime;
+    if (parameters.vertexOrder != originalOrder)
+        vertexNumbers = numbers;
+    return result;
+}
+
+// Reading of graphs, WL relabeling and radial context with word2vec are stages running in
+// their own threads, graphs flow between them through bounded queues, so graph i + 2 is read
+// while graph i + 1 is relabeled and subgraphs of graph i are trained. Graphs are dropped after
+// the last stage, only maps of subgraphs are kept for training of graph embeddings. Context of
+// subgraphs trained in graph i contains only graphs up to i. Maps of workspace aren't read and
+// graphs are relabeled one by one (batchSize is ignored)
+bool Graph2Vec::fitPipelined(const std::filesystem::path & dataset)
+{
+    clear();
+    labelTable.clear();
+    BoundedQueue<PipelineItem> readQueue("read -> extract", parameters.queueCapacity);
+    BoundedQueue<PipelineItem> extractQueue("extract -> train", parameters.queueCapacity);
+    std::atomic<bool> failed(false);
+    // Time of stages excludes waiting for the queues
+    double readingTime = 0, reorderingTime = 0, extractionTime = 0;
+    std::thread reader([&]()
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        failed = ! streamGraphs(dataset, [&](unsigned graphNumber, Graph & graph)
+        {
+            readingTime += getSeconds(start);
+            PipelineItem item;
+            item.graphNumber = graphNumber;
+            start = std::chrono::steady_clock::now();
+            reorderVertices(graph, item.vertexNumbers);
+            reorderingTime += getSeconds(start);
+            item.graph = std::make_unique<Graph>(std::move(graph));
+            bool pushed = readQueue.push(std::move(item));
+            start = std::chrono::steady_clock::now();
+            return pushed;
+        }, getReadLabels());
+        readingTime += getSeconds(start);
+        readQueue.close();
+    });
+    // Extraction thread has its own generator and matrix of new embeddings, rows of IDs already
+    // passed to the training stage are left empty
+    std::mt19937 extractGenerator(generator());
+    std::thread extractor([&]()
+    {
+        std::vector<std::vector<double>> embeddings;
+        PipelineItem item;
+        while (readQueue.pop(item))
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            unsigned firstNewID = embeddings.size();
+            item.subgraphMap.graphID = item.graphNumber;
+            item.subgraphMap.rootVertices.clear();
+            extractGraphSubgraphs(*item.graph, item.subgraphMap, embeddings, extractGenerator);
+            item.newSubgraphs.clear();
+            for (unsigned i = firstNewID; i < embeddings.size(); i++)
+                item.newSubgraphs.push_back(std::move(embeddings[i]));
+            extractionTime += getSeconds(start);
+            if (! extractQueue.push(std::move(item)))
+                break;
+        }
+        extractQueue.close();
+    });
+    RadialContext subgraphContext;
+    std::vector<bool> trained;
+    // Signatures of graphs passed to word2vec, for deduplication in the order of arrival
+    std::unordered_map<std::vector<unsigned>, unsigned, SignatureHash> graphSignatures;
+    std::vector<unsigned> signature;
+    PipelineItem item;
+    while (extractQueue.pop(item))
+    {
+        for (unsigned i = 0; i < item.newSubgraphs.size(); i++)
+            subgraphsEmbeddings.push_back(std::move(item.newSubgraphs[i]));
+        trained.resize(subgraphsEmbeddings.size(), false);
+        bool duplicate = false;
+        if (parameters.deduplicate)
+        {
+            getGraphSignature(signature, item.subgraphMap, parameters.degree);
+            duplicate = ! graphSignatures.emplace(signature, item.graphNumber).second;
+        }
+        if (parameters.verbose && ! duplicate)
+            std::cout << "word2vec for subgraphs of Graph no " << item.graphNumber << std::endl;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (! duplicate)
+            radialSkipGramGraph(subgraphContext, item.subgraphMap, *item.graph, parameters.degree, parameters.sampling, generator);
+        metrics.contextTime += getSeconds(start);
+        start = std::chrono::steady_clock::now();
+        if (! duplicate)
+            word2vec(subgraphsEmbeddings, getNewSubgraphs(item.subgraphMap, trained), subgraphContext, parameters.dimensions,
+                     parameters.epochs, parameters.alpha, generator, parameters.objective, parameters.expMethod);
+        metrics.word2vecTime += getSeconds(start);
+        if (item.graphNumber >= subgraphMaps.size())
+            subgraphMaps.resize(item.graphNumber + 1);
+        subgraphMaps[item.graphNumber] = std::move(item.subgraphMap);
+        if (parameters.vertexOrder != originalOrder)
+        {
+            if (item.graphNumber >= vertexNumbers.size())
+                vertexNumbers.resize(item.graphNumber + 1);
+            vertexNumbers[item.graphNumber] = std::move(item.vertexNumbers);
+        }
+    }
+    if (parameters.vertexOrder != originalOrder)
+        vertexNumbers.resize(subgraphMaps.size());
+    // Numbers missing in the dataset are empty graphs, as in readGraphs
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+        subgraphMaps[i].graphID = i;
+    reader.join();
+    extractor.join();
+    metrics.readingTime = readingTime;
+    metrics.reorderingTime = reorderingTime;
+    metrics.extractionTime = extractionTime;
+    pipelineStatistics.clear();
+    pipelineStatistics.push_back(readQueue.getStatistics());
+    pipelineStatistics.push_back(extractQueue.getStatistics());
+    if (parameters.verbose)
+    {
+        for (unsigned i = 0; i < pipelineStatistics.size(); i++)
+        {
+            const QueueStatistics & queue = pipelineStatistics[i];
+            std::cout << "Queue " << queue.name << ": mean occupancy " << queue.meanOccupancy << "/" << queue.capacity << ", max " << queue.maxOccupancy;
+            std::cout << ", producer waited " << queue.fullWaits << " times, consumer waited " << queue.emptyWaits << " times" << std::endl;
+        }
+    }
+    collectHashingMetrics();
+    if (failed)
+        return false;
+    if (subgraphMaps.size() < 2)
+    {
+        std::cerr << "Too few graphs to fit the model (at least 2).\n";
+        return false;
+    }
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    graphsEmbeddings.assign(subgraphMaps.size(), std::vector<double>(parameters.dimensions));
+    for (unsigned i = 0; i < graphsEmbeddings.size(); i++)
+    {
+        for (unsigned j = 0; j < parameters.dimensions; j++)
+            graphsEmbeddings[i][j] = unidist(generator);
+    }
+    keepDynamicState(subgraphContext);
+    writeWorkspace(0);
+    // Graphs are grouped again by graph number, so the trained graph of every group is its first one
+    deduplicateGraphs();
+    std::vector<bool> trainedGraphs(subgraphMaps.size());
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+        trainedGraphs[i] = representatives.empty() || representatives[i] == i;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    trainGraphsEmbeddings(subgraphMaps, graphsEmbeddings, trainedGraphs, parameters.epochs);
+    shareGraphsEmbeddings();
+    metrics.trainingTime = getSeconds(start);
+    if (parameters.verbose)
+        printMetrics();
+    return true;
+}
+
+// Embed graphs, which were not fitted, against subgraphs of the fitted ones. The model isn't changed:
+// extraction adds the new subgraphs to the hashing and to the metrics, so both are restored after it
+std::vector<std::vector<double>> Graph2Vec::transform(const std::vector<Graph> & graphs)
+{
+    std::vector<std::vector<double>> result;
+    if (subgraphMaps.empty())
+    {
+        std::cerr << "Model is not fitted.\n";
+        return result;
+    }
+    unsigned fittedSubgraphs = subgraphsEmbeddings.size();
+    SubgraphHashing fittedHashing = subgraphHashing;
+    Metrics fittedMetrics = metrics;
+    std::vector<SubgraphMap> maps;
+    extractSubgraphs(graphs, maps, subgraphMaps.size());
+    RadialContext subgraphContext;
+    radialSkipGram(subgraphContext, maps, graphs, parameters.degree, parameters.sampling, generator);
+    // Only subgraphs, which aren't in vocabulary of the fitted graphs, are trained
+    std::vector<bool> trained(subgraphsEmbeddings.size(), false);
+    std::fill(trained.begin(), trained.begin() + fittedSubgraphs, true);
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        word2vec(subgraphsEmbeddings, getNewSubgraphs(maps[i], trained), subgraphContext, parameters.dimensions,
+                 parameters.epochs, parameters.alpha, generator, parameters.objective, parameters.expMethod);
+    }
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        result.push_back(std::vector<double>());
+        for (unsigned j = 0; j < parameters.dimensions; j++)
+        {
+            result[i].push_back(unidist(generator));
+        }
+    }
+    trainGraphsEmbeddings(maps, result);
+    // Subgraphs of transformed graphs got IDs after the fitted ones, so they are simply dropped
+    truncateVocabulary(subgraphVocabulary, fittedSubgraphs);
+    subgraphsEmbeddings.resize(fittedSubgraphs);
+    subgraphHashing = fittedHashing;
+    metrics = fittedMetrics;
+    return result;
+}
+
+// Add graphs to the fitted (or loaded) model as graphs subgraphMaps.size() on, without fitting it again.
+// Only the new graphs are extracted, their new subgraphs get IDs in the vocabulary and are trained by
+// word2vec. The new graphs with appendSamples of the fitted ones are trained for appendEpochs, the other
+// embeddings stay. Metrics are of the appended graphs
+bool Graph2Vec::append(const std::vector<Graph> & graphs)
+{
+    if (subgraphMaps.empty())
+    {
+        std::cerr << "Model is not fitted.\n";
+        return false;
+    }
+    unsigned firstGraph = subgraphMaps.size(), fittedSubgraphs = subgraphsEmbeddings.size();
+    metrics = Metrics();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<SubgraphMap> maps;
+    extractSubgraphs(graphs, maps, firstGraph);
+    collectHashingMetrics();
+    metrics.extractionTime = getSeconds(start);
+    subgraphMaps.insert(subgraphMaps.end(), maps.cbegin(), maps.cend());
+    start = std::chrono::steady_clock::now();
+    RadialContext subgraphContext;
+    radialSkipGram(subgraphContext, maps, graphs, parameters.degree, parameters.sampling, generator);
+    metrics.contextTime = getSeconds(start);
+    // Only subgraphs, which aren't in vocabulary of the fitted graphs, are trained
+    start = std::chrono::steady_clock::now();
+    std::vector<bool> trained(subgraphsEmbeddings.size(), false);
+    std::fill(trained.begin(), trained.begin() + fittedSubgraphs, true);
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        if (parameters.verbose)
+            std::cout << "word2vec for subgraphs of Graph no " << firstGraph + i << std::endl;
+        word2vec(subgraphsEmbeddings, getNewSubgraphs(maps[i], trained), subgraphContext, parameters.dimensions,
+                 parameters.epochs, parameters.alpha, generator, parameters.objective, parameters.expMethod);
+    }
+    metrics.word2vecTime = getSeconds(start);
+    if (parameters.dynamicGraphs && ! subgraphOccurrences.empty())
+    {
+        for (RadialContext::iterator it = subgraphContext.begin(); it != subgraphContext.end(); it++)
+            radialContext[it->first].insert(it->second.cbegin(), it->second.cend());
+        subgraphOccurrences.resize(subgraphsEmbeddings.size(), 0);
+        for (unsigned i = 0; i < maps.size(); i++)
+            for (unsigned j = 0; j < maps[i].rootVertices.size(); j++)
+                for (unsigned k = 0; k < maps[i].rootVertices[j].size(); k++)
+                    subgraphOccurrences[maps[i].rootVertices[j][k]]++;
+    }
+    // Appended graphs aren't grouped with the fitted ones, every one is trained
+    if (! representatives.empty())
+    {
+        for (unsigned i = 0; i < graphs.size(); i++)
+            representatives.push_back(firstGraph + i);
+    }
+    writeWorkspace(firstGraph);
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        graphsEmbeddings.push_back(std::vector<double>(parameters.dimensions));
+        for (unsigned j = 0; j < parameters.dimensions; j++)
+            graphsEmbeddings.back()[j] = unidist(generator);
+    }
+    // Fitted graphs are trained again with them, so that the new subgraphs don't pull the new graphs
+    // away from the old ones
+    start = std::chrono::steady_clock::now();
+    std::vector<bool> trainedGraphs(subgraphMaps.size(), false);
+    std::fill(trainedGraphs.begin() + firstGraph, trainedGraphs.end(), true);
+    unsigned samples = std::min<unsigned>(parameters.appendSamples > 0 ? parameters.appendSamples : graphs.size(), firstGraph);
+    std::uniform_int_distribution<unsigned> graphDist(0, firstGraph - 1);
+    for (unsigned i = 0; i < samples; )
+    {
+        unsigned graphNumber = graphDist(generator);
+        if (! trainedGraphs[graphNumber])
+        {
+            trainedGraphs[graphNumber] = true;
+            i++;
+        }
+    }
+    trainGraphsEmbeddings(subgraphMaps, graphsEmbeddings, trainedGraphs, parameters.appendEpochs > 0 ? parameters.appendEpochs : parameters.epochs);
+    metrics.trainingTime = getSeconds(start);
+    metrics.appendedGraphs = graphs.size();
+    metrics.sampledGraphs = samples;
+    if (parameters.verbose)
+        printMetrics();
+    return true;
+}
+
+// Append graphs of the dataset (any format of readGraphs) of numbers from the number of fitted graphs on
+bool Graph2Vec::append(const std::filesystem::path & dataset)
+{
+    if (subgraphMaps.empty())
+    {
+        std::cerr << "Model is not fitted.\n";
+        return false;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Graph> graphs;
+    if (! readNewGraphs(dataset, graphs, subgraphMaps.size(), getReadLabels()))
+        return false;
+    double readingTime = getSeconds(start);
+    if (graphs.empty())
+    {
+        if (parameters.verbose)
+            std::cout << "No graphs to append, the dataset has " << subgraphMaps.size() << " fitted graphs" << std::endl;
+        return true;
+    }
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<unsigned>> numbers(graphs.size());
+    for (unsigned i = 0; i < graphs.size(); i++)
+        reorderVertices(graphs[i], numbers[i]);
+    double reorderingTime = getSeconds(start);
+    if (parameters.vertexOrder != originalOrder)
+    {
+        vertexNumbers.resize(subgraphMaps.size());
+        vertexNumbers.insert(vertexNumbers.end(), numbers.cbegin(), numbers.cend());
+    }
+    bool result = append(graphs);
+    metrics.readingTime = readingTime;
+    metrics.reorderingTime = reorderingTime;
+    return result;
+}
+
+// Apply insertions and deletions of vertices and edges to the fitted graph of the number and refresh
+// the model (DynamicGraph.hpp). Subgraphs are relabeled, and their radial context and counts changed,
+// only around the updates. New subgraphs are trained by word2vec, then the embedding of the graph
+// by refreshEpochs epochs. Model has to be fitted with dynamicGraphs in this process
+bool Graph2Vec::update(unsigned graphNumber, Graph & graph, const std::vector<GraphUpdate> & updates)
+{
+    if (! parameters.dynamicGraphs || subgraphOccurrences.empty())
+    {
+        std::cerr << "Model is not fitted with dynamic graphs.\n";
+        return false;
+    }
+    if (graphNumber >= subgraphMaps.size() || subgraphMaps[graphNumber].rootVertices.size() != graph.getMaxVertex())
+    {
+        std::cerr << "Graph " << graphNumber << " isn't the fitted one.\n";
+        return false;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SubgraphMap & subgraphMap = subgraphMaps[graphNumber];
+    SubgraphMap oldMap = subgraphMap;
+    std::vector<unsigned> touched;
+    std::map<unsigned, std::vector<unsigned>> oldAdjacent;
+    metrics.appliedUpdates += applyGraphUpdates(graph, updates, parameters.sampling, touched, oldAdjacent);
+    unsigned firstNewID = subgraphsEmbeddings.size();
+    std::vector<bool> changed;
+    if (parameters.adaptiveDegree)
+    {
+        // Degree of stable partition may change anywhere in the graph, so it's extracted whole
+        getWLSubgraphsAdaptive(subgraphMap, subgraphVocabulary, subgraphHashing, subgraphsEmbeddings, graph, parameters.degree, parameters.dimensions,
+                               parameters.sampling, generator);
+        changed.assign(graph.getMaxVertex(), true);
+        for (unsigned j = 0; j < subgraphMap.rootVertices.size(); j++)
+            metrics.relabeledSubgraphs += subgraphMap.rootVertices[j].size();
+    }
+    else
+        metrics.relabeledSubgraphs += relabelDynamicGraph(subgraphMap, changed, subgraphVocabulary, subgraphHashing, subgraphsEmbeddings, graph, touched,
+                                                          parameters.degree, parameters.dimensions, parameters.sampling, generator);
+    subgraphOccurrences.resize(subgraphsEmbeddings.size(), 0);
+    // Context of subgraphs of a vertex changes with them, with its adjacent vertices and their subgraphs.
+    // Duplicate graph of deduplication added no context, so all of its context is new
+    bool hadContext = representatives.empty() || representatives[graphNumber] == graphNumber;
+    std::vector<bool> affected(std::max<std::size_t>(oldMap.rootVertices.size(), graph.getMaxVertex()), ! hadContext);
+    std::vector<unsigned> sources, adjacent;
+    for (unsigned i = 0; i < touched.size(); i++)
+        affected[touched[i]] = true;
+    for (unsigned v = 0; v < changed.size(); v++)
+    {
+        if (! changed[v])
+            continue;
+        affected[v] = true;
+        getSourceVertices(sources, graph, v);
+        for (unsigned i = 0; i < sources.size(); i++)
+            affected[sources[i]] = true;
+    }
+    for (unsigned v = 0; v < affected.size(); v++)
+    {
+        if (! affected[v])
+            continue;
+        bool existed = v < oldMap.rootVertices.size() && ! oldMap.rootVertices[v].empty();
+        bool exists = v < graph.getMaxVertex() && graph.getVertex(v) != nullptr;
+        std::vector<unsigned> previous;
+        if (oldAdjacent.count(v) > 0)
+            previous = oldAdjacent[v];
+        else if (existed)
+            getAdjacentVertices(previous, graph, v, parameters.sampling);
+        previous.erase(std::remove(previous.begin(), previous.end(), v), previous.end());
+        if (existed)
+        {
+            if (hadContext)
+                removeRadialContext(radialContext, oldMap, v, previous, parameters.degree);
+            for (unsigned d = 0; d < oldMap.rootVertices[v].size(); d++)
+                subgraphOccurrences[oldMap.rootVertices[v][d]]--;
+        }
+        if (! exists)
+            continue;
+        for (unsigned d = 0; d < subgraphMap.rootVertices[v].size(); d++)
+            subgraphOccurrences[subgraphMap.rootVertices[v][d]]++;
+        getAdjacentVertices(adjacent, graph, v, parameters.sampling);
+        adjacent.erase(std::remove(adjacent.begin(), adjacent.end(), v), adjacent.end());
+        // Random context of vertex without adjacent vertices before and after the updates stays
+        if (existed && hadContext && previous.empty() && adjacent.empty())
+            continue;
+        unsigned graphDegree = std::min<unsigned>(parameters.degree, subgraphMap.rootVertices[v].size() - 1);
+        for (unsigned d = 0; d <= graphDegree; d++)
+            radialSkipGramCore(radialContext, subgraphMap, subgraphMap.rootVertices[v][d], graph, adjacent, d, graphDegree, generator);
+    }
+    if (! representatives.empty())
+        representatives[graphNumber] = graphNumber;
+    std::vector<unsigned> newSubgraphs;
+    for (unsigned i = firstNewID; i < subgraphsEmbeddings.size(); i++)
+        newSubgraphs.push_back(i);
+    if (! newSubgraphs.empty())
+        word2vec(subgraphsEmbeddings, newSubgraphs, radialContext, parameters.dimensions, parameters.epochs, parameters.alpha, generator, parameters.objective, parameters.expMethod);
+    std::vector<bool> trainedGraphs(subgraphMaps.size(), false);
+    trainedGraphs[graphNumber] = true;
+    trainGraphsEmbeddings(subgraphMaps, graphsEmbeddings, trainedGraphs, parameters.refreshEpochs);
+    metrics.updateTime += getSeconds(start);
+    return true;
+}
+
+void Graph2Vec::extractSubgraphs(const std::vector<Graph> & graphs, std::vector<SubgraphMap> & maps, unsigned firstGraphID)
+{
+    // Cache is looked up and adaptive degree is found graph by graph
+    if (parameters.batchSize > 0 && parameters.cache.empty() && ! parameters.adaptiveDegree)
+    {
+        GraphBatch batch;
+        for (unsigned first = 0; first < graphs.size(); first += parameters.batchSize)
+        {
+            unsigned last = std::min<std::size_t>(first + parameters.batchSize, graphs.size());
+            if (parameters.verbose)
+                std::cout << "Graphs no " << first << "-" << last - 1 << "\n";
+            packGraphs(batch, graphs, first, last, parameters.sampling);
+            for (unsigned i = first; i < last; i++)
+                countVertices(graphs[i]);
+            getWLSubgraphsBatch(maps, subgraphVocabulary, subgraphHashing, subgraphsEmbeddings, batch, firstGraphID + first, parameters.degree, parameters.dimensions, generator);
+            for (unsigned i = maps.size() - (last - first); i < maps.size(); i++)
+                countSubgraphs(maps[i]);
+        }
+        return;
+    }
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        if (parameters.verbose)
+            std::cout << "Graph no " << i << "\n";
+        maps.push_back(SubgraphMap());
+        maps.back().graphID = firstGraphID + i;
+        extractGraphSubgraphs(graphs[i], maps.back(), subgraphsEmbeddings, generator);
+    }
+}
+
+// Graph of the same content and extraction parameters as the cached one only replays its subgraphs
+// through the vocabulary, other graphs are extracted and added to the cache
+void Graph2Vec::extractGraphSubgraphs(const Graph & graph, SubgraphMap & subgraphMap, std::vector<std::vector<double>> & embeddings, std::mt19937 & gen)
+{
+    countVertices(graph);
+    std::filesystem::path cachePath;
+    CachedSubgraphs cached;
+    if (! parameters.cache.empty())
+    {
+        std::uint64_t key = getExtractionKey(parameters.degree, parameters.adaptiveDegree, parameters.hashBuckets, parameters.sampling);
+        cachePath = getCachePath(parameters.cache, key, getGraphHash(graph, parameters.stringLabels ? &labelTable : nullptr));
+        if (readCachedSubgraphs(cachePath, cached) && cached.rootVertices.size() == graph.getMaxVertex())
+        {
+            replayCachedSubgraphs(subgraphMap, cached, graph, subgraphVocabulary, subgraphHashing, embeddings, parameters.dimensions, gen);
+            metrics.cachedGraphs++;
+            countSubgraphs(subgraphMap);
+            return;
+        }
+    }
+    if (parameters.adaptiveDegree)
+        getWLSubgraphsAdaptive(subgraphMap, subgraphVocabulary, subgraphHashing, embeddings, graph, parameters.degree, parameters.dimensions, parameters.sampling, gen);
+    else
+    {
+        subgraphMap.rootVertices.resize(graph.getMaxVertex());
+        for (unsigned j = 0; j < graph.getMaxVertex(); j++)
+        {
+            if (graph.getVertex(j) != nullptr)
+            {
+                for (unsigned k = 0; k <= parameters.degree; k++)
+                {
+                    getWLSubgraph(subgraphMap, subgraphVocabulary, subgraphHashing, embeddings, graph, graph.getVertex(j), k, parameters.dimensions, parameters.sampling, gen);
+                }
+            }
+        }
+    }
+    countSubgraphs(subgraphMap);
+    if (! cachePath.empty())
+    {
+        getCachedSubgraphs(cached, subgraphMap, graph, parameters.degree, parameters.sampling);
+        writeCachedSubgraphs(cachePath, cached);
+    }
+}
+
+// Add vertices of the graph to metrics, with vertices of sampled adjacent vertices
+void Graph2Vec::countVertices(const Graph & graph)
+{
+    std::vector<unsigned> adjacent;
+    for (unsigned j = 0; j < graph.getMaxVertex(); j++)
+    {
+        if (graph.getVertex(j) == nullptr)
+            continue;
+        metrics.vertices++;
+        if (parameters.sampling.maxNeighbors == 0)
+            continue;
+        unsigned count = getAdjacentVertices(adjacent, graph, j, parameters.sampling);
+        if (count > adjacent.size())
+        {
+            metrics.sampledVertices++;
+            metrics.adjacentVertices += count;
+            metrics.usedAdjacentVertices += adjacent.size();
+        }
+    }
+}
+
+// Add rooted subgraphs of the map to metrics, and the graph to adapted graphs, if it has fewer degrees
+void Graph2Vec::countSubgraphs(const SubgraphMap & subgraphMap)
+{
+    bool adapted = false;
+    for (unsigned j = 0; j < subgraphMap.rootVertices.size(); j++)
+    {
+        metrics.rootedSubgraphs += subgraphMap.rootVertices[j].size();
+        adapted = adapted || (! subgraphMap.rootVertices[j].empty() && subgraphMap.rootVertices[j].size() <= parameters.degree);
+    }
+    metrics.adaptedGraphs += adapted;
+}
+
+// Renumber vertices of the graph by vertexOrder, numbers gets the original number of every vertex
+void Graph2Vec::reorderVertices(Graph & graph, std::vector<unsigned> & numbers) const
+{
+    numbers.clear();
+    if (parameters.vertexOrder == originalOrder)
+        return;
+    getVertexOrder(numbers, graph, parameters.vertexOrder);
+    Graph reordered;
+    reorderGraph(reordered, graph, numbers);
+    graph = std::move(reordered);
+}
+
+void Graph2Vec::collectHashingMetrics()
+{
+    metrics.hashedSubgraphs = subgraphHashing.subgraphs;
+    metrics.collidedSubgraphs = subgraphHashing.collisions;
+    metrics.occupiedBuckets = subgraphHashing.fingerprints.size() - std::count(subgraphHashing.fingerprints.cbegin(), subgraphHashing.fingerprints.cend(), 0);
+    metrics.collidedBuckets = std::count(subgraphHashing.collided.cbegin(), subgraphHashing.collided.cend(), true);
+}
+
+void Graph2Vec::printMetrics() const
+{
+    if (parameters.sampling.maxNeighbors > 0)
+    {
+        std::cout << "Adjacent vertices sampled (at most " << parameters.sampling.maxNeighbors << ") for " << metrics.sampledVertices << " of ";
+        std::cout << metrics.vertices << " vertices, " << metrics.usedAdjacentVertices << " of their " << metrics.adjacentVertices << " adjacent vertices used" << std::endl;
+    }
+    if (parameters.hashBuckets > 0)
+    {
+        std::cout << "Subgraphs hashed into " << metrics.occupiedBuckets << " of " << parameters.hashBuckets << " buckets, " << metrics.collidedBuckets;
+        std::cout << " buckets of more subgraphs, " << metrics.collidedSubgraphs << " of " << metrics.hashedSubgraphs << " rooted subgraphs collided";
+        if (metrics.hashedSubgraphs > 0)
+            std::cout << " (" << 100.0 * metrics.collidedSubgraphs / metrics.hashedSubgraphs << "%)";
+        std::cout << std::endl;
+    }
+    if (parameters.adaptiveDegree)
+    {
+        unsigned long long fullSubgraphs = metrics.vertices * (parameters.degree + 1);
+        std::cout << "Adaptive degree stopped " << metrics.adaptedGraphs << " graphs early, " << metrics.rootedSubgraphs << " of " << fullSubgraphs << " rooted subgraphs extracted";
+        if (fullSubgraphs > 0)
+            std::cout << " (" << 100.0 * (fullSubgraphs - metrics.rootedSubgraphs) / fullSubgraphs << "% saved)";
+        std::cout << std::endl;
+    }
+    if (parameters.deduplicate)
+    {
+        unsigned graphs = subgraphMaps.size();
+        std::cout << "Deduplication: " << metrics.duplicateGraphs << " of " << graphs << " graphs WL-equivalent to an earlier graph";
+        if (graphs > 0)
+            std::cout << " (" << 100.0 * metrics.duplicateGraphs / graphs << "%)";
+        std::cout << ", their " << metrics.skippedSubgraphs << " rooted subgraphs not trained, grouped in " << metrics.deduplicationTime << " s" << std::endl;
+    }
+    if (metrics.numaNodes > 0)
+        std::cout << parameters.threads << " threads of training pinned to " << metrics.numaNodes << " NUMA nodes" << std::endl;
+    if (metrics.appendedGraphs > 0)
+    {
+        std::cout << "Appended " << metrics.appendedGraphs << " graphs to " << subgraphMaps.size() - metrics.appendedGraphs << " fitted graphs, trained with ";
+        std::cout << metrics.sampledGraphs << " of them" << std::endl;
+    }
+    if (! parameters.cache.empty())
+        std::cout << "Subgraphs of " << metrics.cachedGraphs << " graphs loaded from the cache" << std::endl;
+    std::cout << "Time of stages [s]:";
+    if (metrics.readingTime > 0)
+        std::cout << " reading " << metrics.readingTime << ",";
+    if (metrics.reorderingTime > 0)
+        std::cout << " reordering " << metrics.reorderingTime << ",";
+    std::cout << " extraction " << metrics.extractionTime << ", context " << metrics.contextTime;
+    std::cout << ", word2vec " << metrics.word2vecTime << ", graph embeddings " << metrics.trainingTime << std::endl;
+    const PerfCounts * counts[4] = {&metrics.extractionCounts, &metrics.contextCounts, &metrics.word2vecCounts, &metrics.trainingCounts};
+    const char * stages[4] = {"extraction", "context", "word2vec", "graph embeddings"};
+    for (unsigned i = 0; i < 4; i++)
+    {
+        if (! counts[i]->isCounted())
+            continue;
+        std::cout << "Events of " << stages[i] << ": ";
+        writePerfCounts(std::cout, *counts[i]);
+        std::cout << std::endl;
+    }
+}
+
+// Group fitted graphs of the same signature (WLKernel.hpp) and count the work saved
+void Graph2Vec::deduplicateGraphs()
+{
+    representatives.clear();
+    if (! parameters.deduplicate)
+        return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    metrics.duplicateGraphs = groupEquivalentGraphs(representatives, subgraphMaps, parameters.degree);
+    metrics.skippedSubgraphs = 0;
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+    {
+        if (representatives[i] == i)
+            continue;
+        for (unsigned j = 0; j < subgraphMaps[i].rootVertices.size(); j++)
+            metrics.skippedSubgraphs += subgraphMaps[i].rootVertices[j].size();
+    }
+    metrics.deduplicationTime = getSeconds(start);
+}
+
+// With dynamic graphs the context is moved to the model and rooted subgraphs of every ID are counted
+void Graph2Vec::keepDynamicState(RadialContext & context)
+{
+    if (! parameters.dynamicGraphs)
+        return;
+    radialContext = std::move(context);
+    subgraphOccurrences.assign(subgraphsEmbeddings.size(), 0);
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+        for (unsigned j = 0; j < subgraphMaps[i].rootVertices.size(); j++)
+            for (unsigned k = 0; k < subgraphMaps[i].rootVertices[j].size(); k++)
+                subgraphOccurrences[subgraphMaps[i].rootVertices[j][k]]++;
+}
+
+// Duplicate graphs get the embedding of their group, then fineTuneEpochs of training of their own
+void Graph2Vec::shareGraphsEmbeddings()
+{
+    if (representatives.empty())
+        return;
+    std::vector<bool> duplicates(representatives.size(), false);
+    for (unsigned i = 0; i < representatives.size(); i++)
+    {
+        if (representatives[i] == i)
+            continue;
+        graphsEmbeddings[i] = graphsEmbeddings[representatives[i]];
+        duplicates[i] = true;
+    }
+    if (parameters.fineTuneEpochs > 0 && metrics.duplicateGraphs > 0)
+        trainGraphsEmbeddings(subgraphMaps, graphsEmbeddings, duplicates, parameters.fineTuneEpochs);
+}
+
+void Graph2Vec::trainGraphsEmbeddings(const std::vector<SubgraphMap> & maps, std::vector<std::vector<double>> & embeddings)
+{
+    trainGraphsEmbeddings(maps, embeddings, std::vector<bool>(maps.size(), true), parameters.epochs);
+}
+
+// Main loop of the algorithm, negative samples are always drawn from subgraphs of the fitted graphs.
+// Only embeddings of the trained graphs are updated
+void Graph2Vec::trainGraphsEmbeddings(const std::vector<SubgraphMap> & maps, std::vector<std::vector<double>> & embeddings, const std::vector<bool> & trainedGraphs,
+                                      unsigned epochs)
+{
+    if (parameters.threads > 1 || parameters.numa)
+    {
+        trainGraphsEmbeddingsParallel(maps, embeddings, trainedGraphs, epochs);
+        return;
+    }
+    metrics.numaNodes = 0;
+    std::vector<const double *> rows;
+    for (unsigned e = 0; e < epochs; e++)
+    {
+        if (parameters.verbose)
+            std::cout << "Epoch number " << e << std::endl;
+        // Shuffle dataset graphs
+        std::vector<unsigned> indexes = getRandomIndexes(maps.size(), generator);
+        for (unsigned i = 0; i < maps.size(); i++)
+        {
+            if (trainedGraphs[indexes[i]])
+                trainGraphEmbedding(maps[indexes[i]], embeddings[indexes[i]], subgraphsEmbeddings, generator, rows);
+        }
+        // Embeddings of transformed graphs aren't the model's
+        if (parameters.checkpoint && &embeddings == &graphsEmbeddings)
+            parameters.checkpoint(embeddings, e);
+    }
+}
+
+// Graphs are split into contiguous shares of the threads, every thread trains its share in its own
+// order by its own generator, subgraph embeddings are only read. With NUMA placement threads are spread
+// over the nodes and pinned to their CPUs, the rows of every share are copied by its thread first (so
+// they are allocated and touched on its node), and threads of a node read its own replica of subgraph
+// embeddings. On one node (or unknown topology) threads aren't pinned and share the subgraph embeddings
+void Graph2Vec::trainGraphsEmbeddingsParallel(const std::vector<SubgraphMap> & maps, std::vector<std::vector<double>> & embeddings,
+                                              const std::vector<bool> & trainedGraphs, unsigned epochs)
+{
+    unsigned threads = std::max(1u, std::min<unsigned>(parameters.threads, maps.size()));
+    NumaTopology topology;
+    bool placing = parameters.numa && getNumaTopology(topology) && topology.nodes.size() > 1;
+    if (parameters.numa && ! placing && parameters.verbose)
+        std::cout << "One NUMA node, threads of training aren't pinned" << std::endl;
+    std::vector<unsigned> threadNodes = getThreadNodes(threads, placing ? topology.nodes.size() : 1);
+    metrics.numaNodes = placing ? std::min<unsigned>(threads, topology.nodes.size()) : 0;
+    std::vector<std::vector<std::vector<double>>> replicas(placing ? topology.nodes.size() : 0);
+    std::vector<std::mt19937> generators;
+    for (unsigned t = 0; t < threads; t++)
+        generators.emplace_back(generator());
+    // Every epoch runs threads of their own, pinned again to the node of their share
+    auto runThreads = [&](const std::function<void(unsigned)> & work)
+    {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&, t]()
+            {
+                if (placing)
+                    pinThread(topology.cpus[threadNodes[t]]);
+                work(t);
+            });
+        }
+        for (unsigned t = 0; t < workers.size(); t++)
+            workers[t].join();
+    };
+    if (placing)
+    {
+        runThreads([&](unsigned t)
+        {
+            for (unsigned i = (unsigned long long) t * maps.size() / threads; i < (unsigned long long) (t + 1) * maps.size() / threads; i++)
+                embeddings[i] = std::vector<double>(embeddings[i]);
+            if (t == 0 || threadNodes[t] != threadNodes[t - 1])
+                replicas[threadNodes[t]] = subgraphsEmbeddings;
+        });
+    }
+    for (unsigned e = 0; e < epochs; e++)
+    {
+        if (parameters.verbose)
+            std::cout << "Epoch number " << e << std::endl;
+        runThreads([&](unsigned t)
+        {
+            unsigned first = (unsigned long long) t * maps.size() / threads, last = (unsigned long long) (t + 1) * maps.size() / threads;
+            const std::vector<std::vector<double>> & subgraphs = placing ? replicas[threadNodes[t]] : subgraphsEmbeddings;
+            std::vector<unsigned> indexes = getRandomIndexes(last - first, generators[t]);
+            std::vector<const double *> rows;
+            for (unsigned i = 0; i < indexes.size(); i++)
+            {
+                if (trainedGraphs[first + indexes[i]])
+                    trainGraphEmbedding(maps[first + indexes[i]], embeddings[first + indexes[i]], subgraphs, generators[t], rows);
+            }
+        });
+        if (parameters.checkpoint && &embeddings == &graphsEmbeddings)
+            parameters.checkpoint(embeddings, e);
+    }
+}
+
+// One pass over the subgraphs of the graph, with negative samples of the given subgraph embeddings
+void Graph2Vec::trainGraphEmbedding(const SubgraphMap & subgraphMap, std::vector<double> & embedding, const std::vector<std::vector<double>> & subgraphs,
+                                    std::mt19937 & graphGenerator, std::vector<const double *> & rows) const
+{
+    // Choosing negative samples for negative skipgram
+    std::vector<std::vector<double>> negSamplesVector = negativeSampling(parameters.negSamples, subgraphMap.graphID, subgraphMaps,
+                                                                         subgraphs, parameters.degree, graphGenerator);
+    if (parameters.updateBatch > 1)
+    {
+        // Rows of subgraphs of the graph in the order of updates, taken by mini-batches
+        rows.clear();
+        for (unsigned j = 0; j < subgraphMap.rootVertices.size(); j++)
+            for (unsigned k = 0; k < subgraphMap.rootVertices[j].size(); k++)
+                rows.push_back(subgraphs[subgraphMap.rootVertices[j][k]].data());
+        for (unsigned first = 0; first < rows.size(); first += parameters.updateBatch)
+        {
+            unsigned count = std::min<std::size_t>(parameters.updateBatch, rows.size() - first);
+            updateGraphsEmbeddingsBatch(embedding, rows.data() + first, count, negSamplesVector, parameters.alpha, parameters.expMethod);
+        }
+        return;
+    }
+    for (unsigned j = 0; j < subgraphMap.rootVertices.size(); j++)
+    {
+        for (unsigned k = 0; k < subgraphMap.rootVertices[j].size(); k++)
+        {
+            // Training graph embeddings
+            updateGraphsEmbeddings(embedding, subgraphs[subgraphMap.rootVertices[j][k]], negSamplesVector, parameters.alpha, parameters.expMethod);
+        }
+    }
+}
+
+std::filesystem::path Graph2Vec::getMapPath(unsigned graphNumber) const
+{
+    return parameters.workspace / std::string("map").append(std::to_string(graphNumber)).append(".json");
+}
+
+// Load maps of subgraphs from workspace, if all of them exist and fit the graphs
+bool Graph2Vec::readWorkspace(const std::vector<Graph> & graphs)
+{
+    if (parameters.workspace.empty())
+        return false;
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        if (! std::filesystem::directory_entry(getMapPath(i)).exists())
+            return false;
+    }
+    std::vector<SubgraphMap> maps(graphs.size());
+    std::vector<std::vector<double>> embeddings;
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        std::ifstream JSONfile(getMapPath(i));
+        Json::Value JSONmap;
+        JSONfile >> JSONmap;
+        JSONfile.close();
+        if (! subgraphMapFromJSON(JSONmap, maps[i], &embeddings) || maps[i].rootVertices.size() != graphs[i].getMaxVertex())
+            return false;
+        for (unsigned j = 0; j < graphs[i].getMaxVertex(); j++)
+        {
+            unsigned degrees = maps[i].rootVertices[j].size();
+            if (graphs[i].getVertex(j) != nullptr && (parameters.adaptiveDegree ? degrees == 0 || degrees > parameters.degree + 1 : degrees != parameters.degree + 1))
+                return false;
+        }
+    }
+    // With feature hashing buckets without subgraphs aren't in map files, they keep random rows
+    if (parameters.hashBuckets > 0 && embeddings.size() > parameters.hashBuckets)
+        return false;
+    for (unsigned i = 0; i < embeddings.size(); i++)
+    {
+        if (embeddings[i].size() != parameters.dimensions && ! (parameters.hashBuckets > 0 && embeddings[i].empty()))
+            return false;
+    }
+    // Vocabulary isn't stored in map files, but signatures of subgraphs follow from maps and graphs
+    SubgraphVocabulary vocabulary(parameters.hashBuckets > 0 ? 0 : parameters.degree + 1);
+    std::vector<unsigned> signature, adjacent;
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        countVertices(graphs[i]);
+        countSubgraphs(maps[i]);
+        for (unsigned j = 0; j < graphs[i].getMaxVertex(); j++)
+        {
+            if (graphs[i].getVertex(j) == nullptr)
+                continue;
+            getAdjacentVertices(adjacent, graphs[i], j, parameters.sampling);
+            for (unsigned k = 0; k < maps[i].rootVertices[j].size(); k++)
+            {
+                getSubgraphSignature(signature, maps[i], graphs[i], j, adjacent, k);
+                if (parameters.hashBuckets > 0)
+                    getHashedSubgraphID(subgraphHashing, signature, k);
+                else
+                    vocabulary[k].emplace(signature, maps[i].rootVertices[j][k]);
+            }
+        }
+    }
+    subgraphMaps = maps;
+    subgraphVocabulary = vocabulary;
+    if (parameters.hashBuckets > 0)
+    {
+        for (unsigned i = 0; i < embeddings.size(); i++)
+        {
+            if (! embeddings[i].empty())
+                subgraphsEmbeddings[i] = embeddings[i];
+        }
+    }
+    else
+        subgraphsEmbeddings = embeddings;
+    return true;
+}
+
+// Map files of graphs from the first one on, the others are in workspace already
+void Graph2Vec::writeWorkspace(unsigned firstGraph) const
+{
+    if (parameters.workspace.empty())
+        return;
+    std::filesystem::create_directories(parameters.workspace);
+    for (unsigned i = firstGraph; i < subgraphMaps.size(); i++)
+    {
+        std::ofstream JSONfile(getMapPath(i));
+        JSONfile << subgraphMapToJSON(subgraphMaps[i], &subgraphsEmbeddings);
+        JSONfile.close();
+    }
+}
+
+void Graph2Vec::cleanWorkspace() const
+{
+    if (parameters.workspace.empty())
+        return;
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+        std::filesystem::remove(getMapPath(i));
+}
+
+bool Graph2Vec::save(const std::filesystem::path & fileName) const
+{
+    Json::Value model;
+    model["parameters"]["degree"] = parameters.degree;
+    model["parameters"]["adaptiveDegree"] = parameters.adaptiveDegree;
+    model["parameters"]["dimensions"] = parameters.dimensions;
+    model["parameters"]["epochs"] = parameters.epochs;
+    model["parameters"]["alpha"] = parameters.alpha;
+    model["parameters"]["negSamples"] = parameters.negSamples;
+    model["parameters"]["deduplicate"] = parameters.deduplicate;
+    model["parameters"]["fineTuneEpochs"] = parameters.fineTuneEpochs;
+    model["parameters"]["hashBuckets"] = parameters.hashBuckets;
+    model["parameters"]["maxNeighbors"] = parameters.sampling.maxNeighbors;
+    model["parameters"]["samplingSeed"] = parameters.sampling.seed;
+    model["parameters"]["vertexOrder"] = getVertexOrderName(parameters.vertexOrder);
+    model["parameters"]["objective"] = getWord2VecObjectiveName(parameters.objective);
+    model["parameters"]["stringLabels"] = parameters.stringLabels;
+    model["metrics"]["vertices"] = (Json::UInt64) metrics.vertices;
+    model["metrics"]["sampledVertices"] = (Json::UInt64) metrics.sampledVertices;
+    model["metrics"]["adjacentVertices"] = (Json::UInt64) metrics.adjacentVertices;
+    model["metrics"]["usedAdjacentVertices"] = (Json::UInt64) metrics.usedAdjacentVertices;
+    model["metrics"]["hashedSubgraphs"] = (Json::UInt64) metrics.hashedSubgraphs;
+    model["metrics"]["collidedSubgraphs"] = (Json::UInt64) metrics.collidedSubgraphs;
+    model["metrics"]["occupiedBuckets"] = metrics.occupiedBuckets;
+    model["metrics"]["collidedBuckets"] = metrics.collidedBuckets;
+    model["metrics"]["cachedGraphs"] = metrics.cachedGraphs;
+    model["metrics"]["rootedSubgraphs"] = (Json::UInt64) metrics.rootedSubgraphs;
+    model["metrics"]["adaptedGraphs"] = metrics.adaptedGraphs;
+    model["metrics"]["duplicateGraphs"] = metrics.duplicateGraphs;
+    model["metrics"]["skippedSubgraphs"] = (Json::UInt64) metrics.skippedSubgraphs;
+    model["metrics"]["deduplicationTime"] = metrics.deduplicationTime;
+    model["metrics"]["appliedUpdates"] = (Json::UInt64) metrics.appliedUpdates;
+    model["metrics"]["relabeledSubgraphs"] = (Json::UInt64) metrics.relabeledSubgraphs;
+    model["metrics"]["updateTime"] = metrics.updateTime;
+    model["metrics"]["appendedGraphs"] = metrics.appendedGraphs;
+    model["metrics"]["sampledGraphs"] = metrics.sampledGraphs;
+    model["metrics"]["numaNodes"] = metrics.numaNodes;
+    model["metrics"]["readingTime"] = metrics.readingTime;
+    model["metrics"]["reorderingTime"] = metrics.reorderingTime;
+    model["metrics"]["extractionTime"] = metrics.extractionTime;
+    model["metrics"]["contextTime"] = metrics.contextTime;
+    model["metrics"]["word2vecTime"] = metrics.word2vecTime;
+    model["metrics"]["trainingTime"] = metrics.trainingTime;
+    model["graphsEmbeddings"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < graphsEmbeddings.size(); i++)
+    {
+        for (unsigned j = 0; j < graphsEmbeddings[i].size(); j++)
+            model["graphsEmbeddings"][i][j] = graphsEmbeddings[i][j];
+    }
+    model["subgraphsEmbeddings"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < subgraphsEmbeddings.size(); i++)
+    {
+        for (unsigned j = 0; j < subgraphsEmbeddings[i].size(); j++)
+            model["subgraphsEmbeddings"][i][j] = subgraphsEmbeddings[i][j];
+    }
+    model["subgraphMaps"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < subgraphMaps.size(); i++)
+        model["subgraphMaps"][i] = subgraphMapToJSON(subgraphMaps[i], nullptr);
+    // Vertices of maps of reordered graphs are numbered in their order
+    model["vertexNumbers"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < vertexNumbers.size(); i++)
+    {
+        model["vertexNumbers"][i] = Json::Value(Json::arrayValue);
+        for (unsigned j = 0; j < vertexNumbers[i].size(); j++)
+            model["vertexNumbers"][i].append(vertexNumbers[i][j]);
+    }
+    model["representatives"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < representatives.size(); i++)
+        model["representatives"].append(representatives[i]);
+    // String label of every number of label of vertices
+    model["labels"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < labelTable.getLabels().size(); i++)
+        model["labels"].append(labelTable.getLabels()[i]);
+    // Every entry of vocabulary is its signature followed by subgraph ID
+    model["subgraphVocabulary"] = Json::Value(Json::arrayValue);
+    for (unsigned d = 0; d < subgraphVocabulary.size(); d++)
+    {
+        model["subgraphVocabulary"][d] = Json::Value(Json::arrayValue);
+        for (SubgraphVocabulary::value_type::const_iterator it = subgraphVocabulary[d].cbegin(); it != subgraphVocabulary[d].cend(); it++)
+        {
+            Json::Value entry(Json::arrayValue);
+            for (unsigned i = 0; i < it->first.size(); i++)
+                entry.append(it->first[i]);
+            entry.append(it->second);
+            model["subgraphVocabulary"][d].append(entry);
+        }
+    }
+    std::ofstream modelFile(fileName);
+    if (! modelFile)
+    {
+        std::cerr << "Cannot write model file " << fileName << ".\n";
+        return false;
+    }
+    modelFile << model;
+    modelFile.close();
+    return true;
+}
+
+bool Graph2Vec::load(const std::filesystem::path & fileName)
+{
+    std::ifstream modelFile(fileName);
+    Json::Value model;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    if (! modelFile || ! Json::parseFromStream(builder, modelFile, &model, &errors) || ! model.isObject())
+    {
+        std::cerr << "Cannot read model file " << fileName << ".\n";
+        return false;
+    }
+    modelFile.close();
+    Parameters p = parameters;
+    p.degree = model["parameters"]["degree"].asUInt();
+    p.adaptiveDegree = model["parameters"]["adaptiveDegree"].asBool();
+    p.dimensions = model["parameters"]["dimensions"].asUInt();
+    p.epochs = model["parameters"]["epochs"].asUInt();
+    p.alpha = model["parameters"]["alpha"].asDouble();
+    p.negSamples = model["parameters"]["negSamples"].asUInt();
+    p.deduplicate = model["parameters"]["deduplicate"].asBool();
+    p.fineTuneEpochs = model["parameters"]["fineTuneEpochs"].asUInt();
+    p.hashBuckets = model["parameters"]["hashBuckets"].asUInt();
+    p.sampling.maxNeighbors = model["parameters"]["maxNeighbors"].asUInt();
+    p.sampling.seed = model["parameters"]["samplingSeed"].asUInt();
+    if (! parseVertexOrder(p.vertexOrder, model["parameters"]["vertexOrder"].asString().c_str()))
+        p.vertexOrder = originalOrder;
+    if (! parseWord2VecObjective(p.objective, model["parameters"]["objective"].asString().c_str()))
+        p.objective = fullSoftmax;
+    p.stringLabels = model["parameters"]["stringLabels"].asBool();
+    Metrics m;
+    m.vertices = model["metrics"]["vertices"].asUInt64();
+    m.sampledVertices = model["metrics"]["sampledVertices"].asUInt64();
+    m.adjacentVertices = model["metrics"]["adjacentVertices"].asUInt64();
+    m.usedAdjacentVertices = model["metrics"]["usedAdjacentVertices"].asUInt64();
+    m.hashedSubgraphs = model["metrics"]["hashedSubgraphs"].asUInt64();
+    m.collidedSubgraphs = model["metrics"]["collidedSubgraphs"].asUInt64();
+    m.occupiedBuckets = model["metrics"]["occupiedBuckets"].asUInt();
+    m.collidedBuckets = model["metrics"]["collidedBuckets"].asUInt();
+    m.cachedGraphs = model["metrics"]["cachedGraphs"].asUInt();
+    m.rootedSubgraphs = model["metrics"]["rootedSubgraphs"].asUInt64();
+    m.adaptedGraphs = model["metrics"]["adaptedGraphs"].asUInt();
+    m.duplicateGraphs = model["metrics"]["duplicateGraphs"].asUInt();
+    m.skippedSubgraphs = model["metrics"]["skippedSubgraphs"].asUInt64();
+    m.deduplicationTime = model["metrics"]["deduplicationTime"].asDouble();
+    m.appliedUpdates = model["metrics"]["appliedUpdates"].asUInt64();
+    m.relabeledSubgraphs = model["metrics"]["relabeledSubgraphs"].asUInt64();
+    m.updateTime = model["metrics"]["updateTime"].asDouble();
+    m.appendedGraphs = model["metrics"]["appendedGraphs"].asUInt();
+    m.sampledGraphs = model["metrics"]["sampledGraphs"].asUInt();
+    m.numaNodes = model["metrics"]["numaNodes"].asUInt();
+    m.readingTime = model["metrics"]["readingTime"].asDouble();
+    m.reorderingTime = model["metrics"]["reorderingTime"].asDouble();
+    m.extractionTime = model["metrics"]["extractionTime"].asDouble();
+    m.contextTime = model["metrics"]["contextTime"].asDouble();
+    m.word2vecTime = model["metrics"]["word2vecTime"].asDouble();
+    m.trainingTime = model["metrics"]["trainingTime"].asDouble();
+    std::vector<std::vector<double>> graphs, subgraphs;
+    for (unsigned i = 0; i < model["graphsEmbeddings"].size(); i++)
+    {
+        graphs.push_back(std::vector<double>());
+        for (unsigned j = 0; j < model["graphsEmbeddings"][i].size(); j++)
+            graphs[i].push_back(model["graphsEmbeddings"][i][j].asDouble());
+    }
+    for (unsigned i = 0; i < model["subgraphsEmbeddings"].size(); i++)
+    {
+        subgraphs.push_back(std::vector<double>());
+        for (unsigned j = 0; j < model["subgraphsEmbeddings"][i].size(); j++)
+            subgraphs[i].push_back(model["subgraphsEmbeddings"][i][j].asDouble());
+    }
+    std::vector<SubgraphMap> maps(model["subgraphMaps"].size());
+    for (unsigned i = 0; i < maps.size(); i++)
+    {
+        if (! subgraphMapFromJSON(model["subgraphMaps"][i], maps[i], nullptr))
+        {
+            std::cerr << "Invalid map of subgraphs in model file " << fileName << ".\n";
+            return false;
+        }
+        for (unsigned j = 0; j < maps[i].rootVertices.size(); j++)
+        {
+            for (unsigned k = 0; k < maps[i].rootVertices[j].size(); k++)
+            {
+                if (maps[i].rootVertices[j][k] >= subgraphs.size())
+                {
+                    std::cerr << "Invalid subgraph ID in model file " << fileName << ".\n";
+                    return false;
+                }
+            }
+        }
+    }
+    std::vector<std::vector<unsigned>> numbers(model["vertexNumbers"].size());
+    for (unsigned i = 0; i < numbers.size(); i++)
+        for (unsigned j = 0; j < model["vertexNumbers"][i].size(); j++)
+            numbers[i].push_back(model["vertexNumbers"][i][j].asUInt());
+    std::vector<unsigned> groups;
+    for (unsigned i = 0; i < model["representatives"].size(); i++)
+    {
+        groups.push_back(model["representatives"][i].asUInt());
+        if (groups.back() > i)
+        {
+            std::cerr << "Invalid representatives of graphs in model file " << fileName << ".\n";
+            return false;
+        }
+    }
+    std::vector<std::string> labels;
+    for (unsigned i = 0; i < model["labels"].size(); i++)
+        labels.push_back(model["labels"][i].asString());
+    LabelTable table;
+    if (! table.assign(labels))
+    {
+        std::cerr << "Invalid labels in model file " << fileName << ".\n";
+        return false;
+    }
+    SubgraphVocabulary vocabulary(model["subgraphVocabulary"].size());
+    for (unsigned d = 0; d < vocabulary.size(); d++)
+    {
+        for (unsigned i = 0; i < model["subgraphVocabulary"][d].size(); i++)
+        {
+            const Json::Value & entry = model["subgraphVocabulary"][d][i];
+            if (entry.size() < 2 || entry[entry.size() - 1].asUInt() >= subgraphs.size())
+            {
+                std::cerr << "Invalid subgraph vocabulary in model file " << fileName << ".\n";
+                return false;
+            }
+            std::vector<unsigned> signature;
+            for (unsigned j = 0; j + 1 < entry.size(); j++)
+                signature.push_back(entry[j].asUInt());
+            vocabulary[d].emplace(signature, entry[entry.size() - 1].asUInt());
+        }
+    }
+    // append and update index the matrices by graphs and by dimensions without further checks
+    bool valid = graphs.size() == maps.size() && (groups.empty() || groups.size() == maps.size());
+    for (unsigned i = 0; valid && i < graphs.size(); i++)
+        valid = graphs[i].size() == p.dimensions;
+    for (unsigned i = 0; valid && i < subgraphs.size(); i++)
+        valid = subgraphs[i].size() == p.dimensions;
+    if (! valid)
+    {
+        std::cerr << "Embeddings or representatives don't fit the graphs and dimensions in model file " << fileName << ".\n";
+        return false;
+    }
+    parameters = p;
+    metrics = m;
+    graphsEmbeddings = graphs;
+    subgraphsEmbeddings = subgraphs;
+    subgraphMaps = maps;
+    subgraphVocabulary = vocabulary;
+    vertexNumbers = numbers;
+    representatives = groups;
+    labelTable = table;
+    subgraphHashing = SubgraphHashing();
+    subgraphHashing.buckets = parameters.hashBuckets;
+    return true;
+}
+
+// Map of subgraphs in JSON format, with vector representations of subgraphs if matrix of them is given
+Json::Value subgraphMapToJSON(const SubgraphMap & subgraphMap, const std::vector<std::vector<double>> * embeddings)
+{
+    Json::Value JSONmap;
+    JSONmap["graphID"] = subgraphMap.graphID;
+    JSONmap["rootVertices"] = Json::Value(Json::arrayValue);
+    for (unsigned i = 0; i < subgraphMap.rootVertices.size(); i++)
+    {
+        if (subgraphMap.rootVertices[i].empty())
+        {
+            JSONmap["rootVertices"][i] = Json::Value();
+            continue;
+        }
+        JSONmap["rootVertices"][i]["vertexNumber"] = i;
+        for (unsigned j = 0; j < subgraphMap.rootVertices[i].size(); j++)
+        {
+            unsigned subgraphID = subgraphMap.rootVertices[i][j];
+            JSONmap["rootVertices"][i]["degrees"][j]["degree"] = j;
+            JSONmap["rootVertices"][i]["degrees"][j]["subgraphID"] = subgraphID;
+            if (embeddings != nullptr)
+            {
+                for (unsigned k = 0; k < (*embeddings)[subgraphID].size(); k++)
+                    JSONmap["rootVertices"][i]["degrees"][j]["subgraphEmbedding"][k] = (*embeddings)[subgraphID][k];
+            }
+        }
+    }
+    return JSONmap;
+}
+
+// Read map of subgraphs in JSON format, vector representations of subgraphs are read into the matrix if it's given
+bool subgraphMapFromJSON(const Json::Value & JSONmap, SubgraphMap & subgraphMap, std::vector<std::vector<double>> * embeddings)
+{
+    if (! JSONmap.isObject() || ! JSONmap["graphID"].isUInt() || ! JSONmap["rootVertices"].isArray())
+        return false;
+    subgraphMap.graphID = JSONmap["graphID"].asUInt();
+    subgraphMap.rootVertices.assign(JSONmap["rootVertices"].size(), std::vector<unsigned>());
+    for (unsigned i = 0; i < JSONmap["rootVertices"].size(); i++)
+    {
+        const Json::Value & rootVertex = JSONmap["rootVertices"][i];
+        if (rootVertex.isNull())
+            continue;
+        if (! rootVertex["vertexNumber"].isUInt() || rootVertex["vertexNumber"].asUInt() != i)
+            return false;
+        for (unsigned j = 0; j < rootVertex["degrees"].size(); j++)
+        {
+            if (! rootVertex["degrees"][j]["subgraphID"].isUInt())
+                return false;
+            unsigned subgraphID = rootVertex["degrees"][j]["subgraphID"].asUInt();
+            subgraphMap.rootVertices[i].push_back(subgraphID);
+            if (embeddings != nullptr)
+            {
+                if (subgraphID >= embeddings->size())
+                    embeddings->resize(subgraphID + 1);
+                (*embeddings)[subgraphID].clear();
+                for (unsigned k = 0; k < rootVertex["degrees"][j]["subgraphEmbedding"].size(); k++)
+                    (*embeddings)[subgraphID].push_back(rootVertex["degrees"][j]["subgraphEmbedding"][k].asDouble());
+            }
+        }
+    }
+    return true;
+}
+
+// IDs of subgraphs of the map, which aren't trained yet, these are marked as trained
+std::vector<unsigned> getNewSubgraphs(const SubgraphMap & subgraphMap, std::vector<bool> & trained)
+{
+    std::vector<unsigned> result;
+    for (unsigned i = 0; i < subgraphMap.rootVertices.size(); i++)
+    {
+        for (unsigned j = 0; j < subgraphMap.rootVertices[i].size(); j++)
+        {
+            unsigned subgraphID = subgraphMap.rootVertices[i][j];
+            if (! trained[subgraphID])
+            {
+                trained[subgraphID] = true;
+                result.push_back(subgraphID);
+            }
+        }
+    }
+    return result;
+}
+
+double getSeconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,157 @@
+#ifndef GRAPH2VEC_HPP
+#define GRAPH2VEC_HPP
+
+#include <vector>
+#include <random>
+#include <functional>
+#include <filesystem>
+#include "Graph.hpp"
+#include "SubgraphMaps.hpp"
+#include "BoundedQueue.hpp"
+#include "VertexOrder.hpp"
+#include "Kernels.hpp"
+#include "word2vec.hpp"
+#include "DynamicGraph.hpp"
+#include "LabelTable.hpp"
+#include "PerfCounters.hpp"
+
+// Receives graph embeddings of the model after every epoch of their training and the number of the epoch
+typedef std::function<void(const std::vector<std::vector<double>> &, unsigned)> EmbeddingsCheckpoint;
+
+// Model of graph2vec algorithm. All intermediate state (maps of rooted subgraphs, their radial
+// context and embeddings) is kept in memory, unless workspace directory is given, in which
+// maps of subgraphs are stored (and reused by the next fit with the same workspace)
+class Graph2Vec
+{
+public:
+    struct Parameters
+    {
+        unsigned degree = 10; // Maximum degree of rooted subgraphs
+        bool adaptiveDegree = false; // Stop extraction of every graph at the degree, where WL relabeling stops refining its vertices
+        unsigned dimensions = 10; // Number of dimensions of embedding vectors
+        unsigned epochs = 3;
+        double alpha = 0.025; // Learning rate
+        unsigned negSamples = 20; // Number of negative samples
+        unsigned batchSize = 0; // Graphs relabeled together as one disjoint union, 0 for graph by graph extraction
+        unsigned updateBatch = 0; // Subgraphs of a graph in one update of its embedding, 0 for update by every subgraph
+        unsigned threads = 1; // Threads of training of graph embeddings, every one trains its share of graphs
+        bool numa = false; // Pin threads of training to NUMA nodes, with their graph embeddings and a replica of subgraph embeddings on their node
+        bool deduplicate = false; // Train only the first graph of every group of WL-equivalent graphs, the others get its embedding
+        unsigned fineTuneEpochs = 0; // Epochs of training of every deduplicated graph from the embedding of its group
+        bool dynamicGraphs = false; // Keep radial context and counts of subgraphs after fit, so that graphs can be updated
+        unsigned refreshEpochs = 1; // Epochs of training of the embedding of updated graph
+        unsigned appendEpochs = 0; // Epochs of training of appended graphs, 0 for epochs
+        unsigned appendSamples = 0; // Fitted graphs trained again with appended graphs, 0 for as many as the appended graphs
+        std::filesystem::path workspace; // Directory of map files, empty for no files at all
+        std::filesystem::path cache; // Directory of extracted subgraphs of every graph by its content (ExtractionCache.hpp), empty for no cache
+        unsigned queueCapacity = 0; // Graphs in every queue of the pipelined fit of dataset directory, 0 for stages one after another
+        unsigned hashBuckets = 0; // Number of subgraph embeddings of feature hashing, 0 for a row of every subgraph
+        NeighborSampling sampling; // Cap of adjacent vertices used in extraction (look to the SubgraphMaps.hpp)
+        VertexOrder vertexOrder = originalOrder; // Renumbering of vertices of graphs read from dataset
+        bool stringLabels = false; // Labels of vertices of graphs read from dataset are any strings, numbered by the label table of the model
+        ExpMethod expMethod = exactExp; // exp of softmax in training of this model
+        Word2VecObjective objective = fullSoftmax; // Output layer of word2vec of subgraphs
+        bool verbose = false; // Print progress to the standard output
+        bool perfCounters = false; // Count hardware events of the stages of fit (PerfCounters.hpp, Linux)
+        EmbeddingsCheckpoint checkpoint; // Called after every epoch of training of graph embeddings of the model, if set
+    };
+    // Approximations made by extraction of subgraphs since the last fit, and time of its stages
+    struct Metrics
+    {
+        unsigned long long vertices = 0; // Root vertices of extracted graphs
+        unsigned long long sampledVertices = 0; // Vertices of more adjacent vertices than maxNeighbors
+        unsigned long long adjacentVertices = 0; // All adjacent vertices of sampled vertices
+        unsigned long long usedAdjacentVertices = 0; // Adjacent vertices of sampled vertices in their sample
+        unsigned long long hashedSubgraphs = 0; // Rooted subgraphs hashed into buckets
+        unsigned long long collidedSubgraphs = 0; // Rooted subgraphs hashed into the bucket of another subgraph
+        unsigned occupiedBuckets = 0;
+        unsigned collidedBuckets = 0; // Buckets of more different subgraphs
+        unsigned cachedGraphs = 0; // Graphs of subgraphs loaded from the cache, not extracted
+        unsigned long long rootedSubgraphs = 0; // Rooted subgraphs in maps, vertices * (degree + 1) without adaptive degree
+        unsigned adaptedGraphs = 0; // Graphs of fewer degrees than degree + 1 by adaptive degree
+        unsigned duplicateGraphs = 0; // Graphs WL-equivalent to an earlier graph, not trained by deduplication
+        unsigned long long skippedSubgraphs = 0; // Rooted subgraphs of duplicate graphs
+        double deduplicationTime = 0;
+        unsigned long long appliedUpdates = 0; // Insertions and deletions of vertices and edges of dynamic graphs
+        unsigned long long relabeledSubgraphs = 0; // Rooted subgraphs found again after updates
+        double updateTime = 0;
+        unsigned appendedGraphs = 0; // Graphs added to the fitted ones by the last append
+        unsigned sampledGraphs = 0; // Fitted graphs trained with them
+        unsigned numaNodes = 0; // Nodes of threads of the last training of graph embeddings, 0 without NUMA placement
+        double readingTime = 0; // Seconds of reading of the dataset, busy time of its thread in pipelined fit
+        double reorderingTime = 0;
+        double extractionTime = 0;
+        double contextTime = 0;
+        double word2vecTime = 0;
+        double trainingTime = 0; // Seconds of training of graph embeddings
+        PerfCounts extractionCounts; // Hardware events of the stages with perfCounters, not saved with the model
+        PerfCounts contextCounts;
+        PerfCounts word2vecCounts;
+        PerfCounts trainingCounts;
+    };
+private:
+    Parameters parameters;
+    std::vector<SubgraphMap> subgraphMaps; // Maps of subgraphs of fitted graphs
+    SubgraphVocabulary subgraphVocabulary;
+    SubgraphHashing subgraphHashing;
+    std::vector<std::vector<double>> subgraphsEmbeddings; // Row of subgraph ID
+    std::vector<std::vector<double>> graphsEmbeddings; // Row of fitted graph number
+    std::vector<QueueStatistics> pipelineStatistics; // Queues of the last pipelined fit
+    std::vector<std::vector<unsigned>> vertexNumbers; // Number in the dataset of every vertex of reordered graphs, empty without reordering
+    std::vector<unsigned> representatives; // Trained graph of the group of every fitted graph, empty without deduplication
+    RadialContext radialContext; // Context of subgraphs of fitted graphs, kept only for dynamic graphs
+    std::vector<unsigned> subgraphOccurrences; // Rooted subgraphs of every ID in maps of fitted graphs, kept only for dynamic graphs
+    LabelTable labelTable; // Numbers of string labels of graphs read from dataset, saved with the model
+    Metrics metrics;
+    std::mt19937 generator;
+    void clear();
+    LabelTable * getReadLabels();
+    void extractSubgraphs(const std::vector<Graph> &, std::vector<SubgraphMap> &, unsigned);
+    void extractGraphSubgraphs(const Graph &, SubgraphMap &, std::vector<std::vector<double>> &, std::mt19937 &);
+    bool fitPipelined(const std::filesystem::path &);
+    void countVertices(const Graph &);
+    void countSubgraphs(const SubgraphMap &);
+    void reorderVertices(Graph &, std::vector<unsigned> &) const;
+    void collectHashingMetrics();
+    void printMetrics() const;
+    void deduplicateGraphs();
+    void keepDynamicState(RadialContext &);
+    void trainModel(const RadialContext &);
+    void shareGraphsEmbeddings();
+    void trainGraphsEmbeddings(const std::vector<SubgraphMap> &, std::vector<std::vector<double>> &);
+    void trainGraphsEmbeddings(const std::vector<SubgraphMap> &, std::vector<std::vector<double>> &, const std::vector<bool> &, unsigned);
+    void trainGraphsEmbeddingsParallel(const std::vector<SubgraphMap> &, std::vector<std::vector<double>> &, const std::vector<bool> &, unsigned);
+    void trainGraphEmbedding(const SubgraphMap &, std::vector<double> &, const std::vector<std::vector<double>> &, std::mt19937 &, std::vector<const double *> &) const;
+    std::filesystem::path getMapPath(unsigned) const;
+    bool readWorkspace(const std::vector<Graph> &);
+    void writeWorkspace(unsigned) const;
+public:
+    Graph2Vec();
+    explicit Graph2Vec(const Parameters &);
+    const Parameters & getParameters() const;
+    const std::vector<SubgraphMap> & getSubgraphMaps() const;
+    const SubgraphVocabulary & getSubgraphVocabulary() const;
+    const std::vector<std::vector<double>> & getSubgraphsEmbeddings() const;
+    const std::vector<std::vector<double>> & getGraphsEmbeddings() const;
+    const std::vector<QueueStatistics> & getPipelineStatistics() const;
+    const Metrics & getMetrics() const;
+    const std::vector<std::vector<unsigned>> & getVertexNumbers() const;
+    const std::vector<unsigned> & getRepresentatives() const;
+    const std::vector<unsigned> & getSubgraphOccurrences() const;
+    const LabelTable & getLabelTable() const;
+    void setLabelTable(const LabelTable &);
+    bool fit(const std::vector<Graph> &);
+    bool fit(const std::filesystem::path &);
+    bool fit(const Graph2Vec &, const RadialContext &);
+    void extract(const std::vector<Graph> &);
+    bool extract(const std::filesystem::path &);
+    std::vector<std::vector<double>> transform(const std::vector<Graph> &);
+    bool update(unsigned, Graph &, const std::vector<GraphUpdate> &);
+    bool append(const std::vector<Graph> &);
+    bool append(const std::filesystem::path &);
+    bool save(const std::filesystem::path &) const;
+    bool load(const std::filesystem::path &);
+    void cleanWorkspace() const;
+};
+
+#endif
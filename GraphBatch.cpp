@@ -0,0 +1,41 @@
+#include <vector>
+#include "Graph.hpp"
+#include "GraphBatch.hpp"
+#include "SubgraphExtract.hpp"
+
+// Pack graphs of indexes [first, last) into one batch, adjacent vertices sampled as in extraction graph by graph
+void packGraphs(GraphBatch & batch, const std::vector<Graph> & graphs, unsigned first, unsigned last, const NeighborSampling & sampling)
+{
+    batch.graphOffsets.clear();
+    batch.vertexNumbers.clear();
+    batch.labels.clear();
+    batch.adjacencyOffsets.clear();
+    batch.adjacentVertices.clear();
+    // Batch index of every vertex number of the current graph
+    std::vector<unsigned> batchIndexes, adjacent;
+    for (unsigned g = first; g < last; g++)
+    {
+        const Graph & graph = graphs[g];
+        unsigned offset = batch.vertexNumbers.size();
+        batch.graphOffsets.push_back(offset);
+        batchIndexes.assign(graph.getMaxVertex(), 0);
+        for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+        {
+            if (graph.getVertex(i) != nullptr)
+            {
+                batchIndexes[i] = batch.vertexNumbers.size();
+                batch.vertexNumbers.push_back(i);
+                batch.labels.push_back(graph.getVertex(i)->getLabel());
+            }
+        }
+        for (unsigned v = offset; v < batch.vertexNumbers.size(); v++)
+        {
+            batch.adjacencyOffsets.push_back(batch.adjacentVertices.size());
+            getAdjacentVertices(adjacent, graph, batch.vertexNumbers[v], sampling);
+            for (unsigned i = 0; i < adjacent.size(); i++)
+                batch.adjacentVertices.push_back(batchIndexes[adjacent[i]]);
+        }
+    }
+    batch.graphOffsets.push_back(batch.vertexNumbers.size());
+    batch.adjacencyOffsets.push_back(batch.adjacentVertices.size());
+}
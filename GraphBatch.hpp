@@ -0,0 +1,21 @@
+#ifndef GRAPHBATCH_HPP
+#define GRAPHBATCH_HPP
+
+#include <vector>
+#include "Graph.hpp"
+#include "SubgraphMaps.hpp"
+
+// Disjoint union of many graphs in compressed sparse row format. Vertices of all graphs are
+// numbered consecutively, graph by graph, and adjacency lists refer to these batch indexes
+struct GraphBatch
+{
+    std::vector<unsigned> graphOffsets; // First batch vertex of every graph, the last element is number of vertices
+    std::vector<unsigned> vertexNumbers; // Number of the vertex in its own graph
+    std::vector<unsigned> labels;
+    std::vector<unsigned> adjacencyOffsets; // Adjacency list of vertex v is [adjacencyOffsets[v], adjacencyOffsets[v + 1])
+    std::vector<unsigned> adjacentVertices;
+};
+
+void packGraphs(GraphBatch &, const std::vector<Graph> &, unsigned, unsigned, const NeighborSampling &);
+
+#endif
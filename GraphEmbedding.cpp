@@ -0,0 +1,89 @@
+#include <vector>
+#include <set>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include "SubgraphMaps.hpp"
+#include "GraphEmbedding.hpp"
+#include "Kernels.hpp"
+
+std::vector<unsigned> getRandomIndexes(unsigned size, std::mt19937 & generator)
+{
+    std::vector<unsigned> indexes(size);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::shuffle(indexes.begin(), indexes.end(), generator);
+    return indexes;
+}
+
+// Choose embeddings of distinct subgraphs, which are rooted in graphs other than graphIndex
+// (pass number of graphs as graphIndex to sample from all of them)
+std::vector<std::vector<double>> negativeSampling(unsigned samples, unsigned graphIndex, const std::vector<SubgraphMap> & subgraphs,
+                                                  const std::vector<std::vector<double>> & subgraphsEmbeddings, unsigned degree, std::mt19937 & generator)
+{
+    std::uniform_int_distribution<unsigned> unidist1(0, subgraphs.size() - 1);
+    std::uniform_int_distribution<unsigned> unidist3(0, degree);
+    std::vector<std::vector<double>> result;
+    std::set<unsigned> subgraphs_used;
+    // Bound the number of draws, so that too small vocabulary gives fewer samples instead of endless loop
+    unsigned attempts = samples * 1000;
+    while (result.size() < samples && attempts > 0)
+    {
+        attempts--;
+        unsigned tempGraph = unidist1(generator);
+        if (tempGraph == graphIndex || subgraphs[tempGraph].rootVertices.empty())
+            continue;
+        std::uniform_int_distribution<unsigned> unidist2(0, subgraphs[tempGraph].rootVertices.size() - 1);
+        unsigned tempVertex = unidist2(generator);
+        unsigned tempDegree = unidist3(generator);
+        if (subgraphs[tempGraph].rootVertices[tempVertex].empty())
+            continue;
+        unsigned subgraphID = getRootSubgraph(subgraphs[tempGraph], tempVertex, tempDegree);
+        if (subgraphs_used.count(subgraphID) == 1)
+            continue;
+        subgraphs_used.insert(subgraphID);
+        result.push_back(subgraphsEmbeddings[subgraphID]);
+    }
+    return result;
+}
+
+void updateGraphsEmbeddings(std::vector<double> & embedding, const std::vector<double> & subgraph, const std::vector<std::vector<double>> & negSamples, double alpha,
+                            ExpMethod method)
+{
+    if (negSamples.empty())
+        return;
+    unsigned dimensions = embedding.size();
+    // Kernels of fixed vector length, if there are such for this number of dimensions
+    const Kernels & kernels = getKernels(dimensions);
+    std::vector<const double *> rows(negSamples.size());
+    for (unsigned i = 0; i < negSamples.size(); i++)
+        rows[i] = negSamples[i].data();
+    // Here we calculate scalar by matrix (graph embeddings) derivative, as described
+    // in graph2vec paper: softmax (over negative samples) weighted sum of negative samples minus subgraph
+    std::vector<double> sums1(negSamples.size()), weightedSum(dimensions);
+    kernels.batchedDot(embedding.data(), rows.data(), sums1.data(), rows.size(), dimensions);
+    kernels.softmaxWeightedSum(rows.data(), sums1.data(), weightedSum.data(), rows.size(), dimensions, method);
+    kernels.scaledAdd(1.0L, embedding.data(), -alpha, weightedSum.data(), dimensions);
+    kernels.axpy(alpha, subgraph.data(), embedding.data(), dimensions);
+}
+
+// Update of graph embedding by a mini-batch of its subgraphs. Softmax weights of negative samples
+// depend only on the graph embedding, so they are computed once for the batch: gradients of all
+// subgraphs (count times the weighted sum minus the sum of their rows) are applied together
+void updateGraphsEmbeddingsBatch(std::vector<double> & embedding, const double * const * subgraphs, unsigned count, const std::vector<std::vector<double>> & negSamples,
+                                 double alpha, ExpMethod method)
+{
+    if (negSamples.empty() || count == 0)
+        return;
+    unsigned dimensions = embedding.size();
+    const Kernels & kernels = getKernels(dimensions);
+    std::vector<const double *> rows(negSamples.size());
+    for (unsigned i = 0; i < negSamples.size(); i++)
+        rows[i] = negSamples[i].data();
+    std::vector<double> sums1(negSamples.size()), weightedSum(dimensions), subgraphsSum(dimensions, 0.0);
+    kernels.batchedDot(embedding.data(), rows.data(), sums1.data(), rows.size(), dimensions);
+    kernels.softmaxWeightedSum(rows.data(), sums1.data(), weightedSum.data(), rows.size(), dimensions, method);
+    for (unsigned i = 0; i < count; i++)
+        kernels.axpy(1.0L, subgraphs[i], subgraphsSum.data(), dimensions);
+    kernels.scaledAdd(1.0L, embedding.data(), -alpha * count, weightedSum.data(), dimensions);
+    kernels.axpy(alpha, subgraphsSum.data(), embedding.data(), dimensions);
+}
@@ -0,0 +1,17 @@
+#ifndef GRAPHEMBEDDING_HPP
+#define GRAPHEMBEDDING_HPP
+
+#include <vector>
+#include <random>
+#include "SubgraphMaps.hpp"
+#include "Kernels.hpp"
+
+std::vector<unsigned> getRandomIndexes(unsigned, std::mt19937 &);
+
+std::vector<std::vector<double>> negativeSampling(unsigned, unsigned, const std::vector<SubgraphMap> &, const std::vector<std::vector<double>> &, unsigned, std::mt19937 &);
+
+void updateGraphsEmbeddings(std::vector<double> &, const std::vector<double> &, const std::vector<std::vector<double>> &, double, ExpMethod);
+
+void updateGraphsEmbeddingsBatch(std::vector<double> &, const double * const *, unsigned, const std::vector<std::vector<double>> &, double, ExpMethod);
+
+#endif
@@ -0,0 +1,491 @@
+#include <iostream>
+#include <vector>
+#include <set>
+#include <utility>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <json/json.h>
+#include "Graph.hpp"
+#include "GraphReader.hpp"
+
+typedef std::vector<std::pair<unsigned, std::unique_ptr<Graph>>> GraphChunk;
+
+bool parseGraphLine(const std::string &, Json::CharReader &, unsigned &, Graph &, LabelTable *);
+
+bool readGraphRecord(std::istream &, unsigned &, Graph &);
+
+void placeGraphs(std::vector<GraphChunk> &, std::vector<Graph> &);
+
+const std::uint32_t recordMagic = 0x47325652; // "RV2G" in little endian
+
+// Read the dataset into the vector of graphs, indexed by the numbers of graphs: directory of JSON
+// graph files (number of the graph is the name of its file), JSON lines file (extension .jsonl)
+// or file of binary graph records. Files are parsed by chunks in parallel. Labels of JSON graphs
+// are numbers, or any strings interned by the table if one is given (binary records are numbers)
+bool readGraphs(const std::filesystem::path & dataset, std::vector<Graph> & graphs, LabelTable * labels)
+{
+    if (std::filesystem::is_regular_file(dataset))
+    {
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        if (dataset.extension() == ".jsonl")
+            return readGraphsJSONL(dataset, graphs, threads, labels);
+        return readGraphsBinary(dataset, graphs, threads);
+    }
+    std::vector<std::filesystem::path> files;
+    listGraphFiles(dataset, files);
+    if (files.size() > graphs.size())
+        graphs.resize(files.size());
+    for (unsigned i = 0; i < files.size(); i++)
+    {
+        if (! files[i].empty() && ! readGraphFile(files[i], graphs[i], labels))
+            return false;
+    }
+    return true;
+}
+
+// Pass graphs of the dataset (in any format of readGraphs) to the consumer one by one, in the
+// order of the directory numbers or of the file. Only one graph is in memory at once
+bool streamGraphs(const std::filesystem::path & dataset, const GraphConsumer & consumer, LabelTable * labels)
+{
+    if (std::filesystem::is_regular_file(dataset))
+    {
+        if (dataset.extension() == ".jsonl")
+            return streamGraphsJSONL(dataset, consumer, labels);
+        return streamGraphsBinary(dataset, consumer);
+    }
+    std::vector<std::filesystem::path> files;
+    listGraphFiles(dataset, files);
+    for (unsigned i = 0; i < files.size(); i++)
+    {
+        Graph graph;
+        if (! files[i].empty() && ! readGraphFile(files[i], graph, labels))
+            return false;
+        if (! consumer(i, graph))
+            break;
+    }
+    return true;
+}
+
+// Read graphs of numbers from the first one on, graph i of the vector is graph firstGraph + i of the
+// dataset. Only their files of a directory are read, graphs of a file are streamed and older ones dropped
+bool readNewGraphs(const std::filesystem::path & dataset, std::vector<Graph> & graphs, unsigned firstGraph, LabelTable * labels)
+{
+    graphs.clear();
+    if (std::filesystem::is_regular_file(dataset))
+    {
+        return streamGraphs(dataset, [&](unsigned graphNumber, Graph & graph)
+        {
+            if (graphNumber < firstGraph)
+                return true;
+            if (graphNumber - firstGraph >= graphs.size())
+                graphs.resize(graphNumber - firstGraph + 1);
+            graphs[graphNumber - firstGraph] = std::move(graph);
+            return true;
+        }, labels);
+    }
+    std::vector<std::filesystem::path> files;
+    listGraphFiles(dataset, files);
+    if (files.size() > firstGraph)
+        graphs.resize(files.size() - firstGraph);
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        if (! files[firstGraph + i].empty() && ! readGraphFile(files[firstGraph + i], graphs[i], labels))
+            return false;
+    }
+    return true;
+}
+
+// Paths of JSON graph files of the directory, indexed by the number of the graph (empty path
+// for numbers without a file)
+void listGraphFiles(const std::filesystem::path & dir, std::vector<std::filesystem::path> & files)
+{
+    unsigned graphNumber;
+    for (const std::filesystem::directory_entry & entry : std::filesystem::directory_iterator(dir))
+    {
+        graphNumber = (unsigned) std::stoi(entry.path().stem().string());
+        if (graphNumber >= files.size())
+            files.resize(graphNumber + 1);
+        files[graphNumber] = entry.path();
+    }
+}
+
+bool readGraphFile(const std::filesystem::path & fileName, Graph & graph, LabelTable * labels)
+{
+    std::ifstream inputFile(fileName);
+    Json::Value sourceJSON;
+    try
+    {
+        inputFile >> sourceJSON;
+    }
+    catch (const Json::Exception & e)
+    {
+        std::cerr << "Invalid graph file " << fileName << ".\n";
+        return false;
+    }
+    if (! readGraph(sourceJSON, graph, labels))
+    {
+        std::cerr << "Invalid graph file " << fileName << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// Every non-empty line of the file is one graph in JSON format with its number ("id")
+bool streamGraphsJSONL(const std::filesystem::path & fileName, const GraphConsumer & consumer, LabelTable * labels)
+{
+    std::ifstream inputFile(fileName);
+    if (! inputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << ".\n";
+        return false;
+    }
+    std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+    std::string line;
+    unsigned lineNumber = 0, graphNumber;
+    while (std::getline(inputFile, line))
+    {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        Graph graph;
+        if (! parseGraphLine(line, *reader, graphNumber, graph, labels))
+        {
+            std::cerr << "Invalid graph in line " << lineNumber << " of " << fileName << ".\n";
+            return false;
+        }
+        if (! consumer(graphNumber, graph))
+            break;
+    }
+    return true;
+}
+
+// The file is split into chunks of equal size, which begin at the beginning of a line, and
+// every chunk is parsed by its own thread
+bool readGraphsJSONL(const std::filesystem::path & fileName, std::vector<Graph> & graphs, unsigned threads, LabelTable * labels)
+{
+    std::ifstream inputFile(fileName, std::ios::binary);
+    if (! inputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << ".\n";
+        return false;
+    }
+    std::uintmax_t size = std::filesystem::file_size(fileName);
+    std::vector<std::uintmax_t> boundaries(1, 0);
+    std::string line;
+    for (unsigned t = 1; t < threads; t++)
+    {
+        std::uintmax_t position = std::max(boundaries.back(), size * t / threads);
+        if (position >= size)
+            break;
+        // Chunk begins after the end of the line, in which the even split falls
+        if (position > 0)
+        {
+            inputFile.seekg(position - 1);
+            std::getline(inputFile, line);
+        }
+        if (! inputFile.good())
+            break;
+        boundaries.push_back(inputFile.tellg());
+    }
+    boundaries.push_back(size);
+    std::vector<GraphChunk> chunks(boundaries.size() - 1);
+    std::vector<char> failed(chunks.size(), false);
+    std::vector<std::thread> workers;
+    for (unsigned c = 0; c < chunks.size(); c++)
+    {
+        workers.emplace_back([&, c]()
+        {
+            std::ifstream chunkFile(fileName, std::ios::binary);
+            std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+            std::string chunkLine;
+            unsigned graphNumber;
+            chunkFile.seekg(boundaries[c]);
+            while ((std::uintmax_t) chunkFile.tellg() < boundaries[c + 1] && std::getline(chunkFile, chunkLine))
+            {
+                if (chunkLine.find_first_not_of(" \t\r") == std::string::npos)
+                    continue;
+                std::unique_ptr<Graph> graph = std::make_unique<Graph>();
+                if (! parseGraphLine(chunkLine, *reader, graphNumber, *graph, labels))
+                {
+                    failed[c] = true;
+                    return;
+                }
+                chunks[c].emplace_back(graphNumber, std::move(graph));
+            }
+        });
+    }
+    for (unsigned c = 0; c < workers.size(); c++)
+        workers[c].join();
+    if (std::find(failed.begin(), failed.end(), true) != failed.end())
+    {
+        std::cerr << "Invalid graph in " << fileName << ".\n";
+        return false;
+    }
+    placeGraphs(chunks, graphs);
+    return true;
+}
+
+bool parseGraphLine(const std::string & line, Json::CharReader & reader, unsigned & graphNumber, Graph & graph, LabelTable * labels)
+{
+    Json::Value sourceJSON;
+    std::string errors;
+    if (! reader.parse(line.data(), line.data() + line.size(), &sourceJSON, &errors) || ! sourceJSON.isObject() || ! sourceJSON["id"].isUInt())
+        return false;
+    graphNumber = sourceJSON["id"].asUInt();
+    return readGraph(sourceJSON, graph, labels);
+}
+
+// Binary record of graph (unsigned 32-bit numbers in the byte order of the machine): magic number,
+// number of the graph, number of vertices, number of edges, number and label of every vertex,
+// both vertex numbers of every edge. Records don't depend on each other, so files of records
+// can be simply concatenated
+bool streamGraphsBinary(const std::filesystem::path & fileName, const GraphConsumer & consumer)
+{
+    std::ifstream inputFile(fileName, std::ios::binary);
+    if (! inputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << ".\n";
+        return false;
+    }
+    unsigned graphNumber;
+    while (inputFile.peek() != std::ifstream::traits_type::eof())
+    {
+        Graph graph;
+        if (! readGraphRecord(inputFile, graphNumber, graph))
+        {
+            std::cerr << "Invalid graph record at byte " << inputFile.tellg() << " of " << fileName << ".\n";
+            return false;
+        }
+        if (! consumer(graphNumber, graph))
+            break;
+    }
+    return true;
+}
+
+// Headers of records are read first to find where records begin, then records are split into
+// chunks of about equal size, parsed by their own threads
+bool readGraphsBinary(const std::filesystem::path & fileName, std::vector<Graph> & graphs, unsigned threads)
+{
+    std::ifstream inputFile(fileName, std::ios::binary);
+    if (! inputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << ".\n";
+        return false;
+    }
+    std::uintmax_t size = std::filesystem::file_size(fileName), position = 0;
+    std::vector<std::uintmax_t> offsets;
+    std::uint32_t header[4];
+    while (position < size)
+    {
+        inputFile.seekg(position);
+        if (! inputFile.read((char *) header, sizeof(header)) || header[0] != recordMagic)
+        {
+            std::cerr << "Invalid graph record at byte " << position << " of " << fileName << ".\n";
+            return false;
+        }
+        offsets.push_back(position);
+        position += sizeof(header) + (2 * (std::uintmax_t) header[2] + 2 * (std::uintmax_t) header[3]) * sizeof(std::uint32_t);
+    }
+    offsets.push_back(size);
+    std::vector<unsigned> boundaries(1, 0); // First record of every chunk
+    for (unsigned r = 1; r + 1 < offsets.size() && boundaries.size() < threads; r++)
+    {
+        if (offsets[r] >= size * boundaries.size() / threads)
+            boundaries.push_back(r);
+    }
+    boundaries.push_back(offsets.size() - 1);
+    std::vector<GraphChunk> chunks(boundaries.size() - 1);
+    std::vector<char> failed(chunks.size(), false);
+    std::vector<std::thread> workers;
+    for (unsigned c = 0; c < chunks.size(); c++)
+    {
+        workers.emplace_back([&, c]()
+        {
+            std::ifstream chunkFile(fileName, std::ios::binary);
+            unsigned graphNumber;
+            chunkFile.seekg(offsets[boundaries[c]]);
+            for (unsigned r = boundaries[c]; r < boundaries[c + 1]; r++)
+            {
+                std::unique_ptr<Graph> graph = std::make_unique<Graph>();
+                if (! readGraphRecord(chunkFile, graphNumber, *graph))
+                {
+                    failed[c] = true;
+                    return;
+                }
+                chunks[c].emplace_back(graphNumber, std::move(graph));
+            }
+        });
+    }
+    for (unsigned c = 0; c < workers.size(); c++)
+        workers[c].join();
+    if (std::find(failed.begin(), failed.end(), true) != failed.end())
+    {
+        std::cerr << "Invalid graph record in " << fileName << ".\n";
+        return false;
+    }
+    placeGraphs(chunks, graphs);
+    return true;
+}
+
+bool readGraphRecord(std::istream & input, unsigned & graphNumber, Graph & graph)
+{
+    std::uint32_t header[4];
+    if (! input.read((char *) header, sizeof(header)) || header[0] != recordMagic)
+        return false;
+    graphNumber = header[1];
+    std::vector<std::uint32_t> data(2 * (std::size_t) header[2] + 2 * (std::size_t) header[3]);
+    if (! input.read((char *) data.data(), data.size() * sizeof(std::uint32_t)))
+        return false;
+    for (unsigned i = 0; i < header[2]; i++)
+        graph.addVertex(data[2 * i], data[2 * i + 1]);
+    for (unsigned i = header[2]; i < header[2] + header[3]; i++)
+        graph.addEdge(data[2 * i], data[2 * i + 1]);
+    return true;
+}
+
+// Move graphs parsed by chunks to their numbers. The vector is resized once, as copying of
+// graphs by reallocation is expensive
+void placeGraphs(std::vector<GraphChunk> & chunks, std::vector<Graph> & graphs)
+{
+    std::size_t size = graphs.size();
+    for (unsigned c = 0; c < chunks.size(); c++)
+    {
+        for (unsigned i = 0; i < chunks[c].size(); i++)
+            size = std::max<std::size_t>(size, chunks[c][i].first + 1);
+    }
+    graphs.resize(size);
+    for (unsigned c = 0; c < chunks.size(); c++)
+    {
+        for (unsigned i = 0; i < chunks[c].size(); i++)
+        {
+            graphs[chunks[c][i].first] = std::move(*chunks[c][i].second);
+            chunks[c][i].second.reset();
+        }
+    }
+}
+
+// Labels are written as numbers, or as their strings of the table if one is given
+bool writeGraphsJSONL(const std::filesystem::path & fileName, const std::vector<Graph> & graphs, const LabelTable * labels)
+{
+    std::ofstream outputFile(fileName);
+    if (! outputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << " for writing.\n";
+        return false;
+    }
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    for (unsigned g = 0; g < graphs.size(); g++)
+    {
+        Json::Value graphJSON;
+        graphJSON["id"] = g;
+        graphJSON["features"] = Json::Value(Json::objectValue);
+        graphJSON["edges"] = Json::Value(Json::arrayValue);
+        for (unsigned i = 0; i < graphs[g].getMaxVertex(); i++)
+        {
+            if (graphs[g].getVertex(i) == nullptr)
+                continue;
+            unsigned label = graphs[g].getVertex(i)->getLabel();
+            if (labels != nullptr && label < labels->size())
+                graphJSON["features"][std::to_string(i)] = labels->getLabel(label);
+            else
+                graphJSON["features"][std::to_string(i)] = std::to_string(label);
+            for (unsigned j = 0; j < graphs[g].getMaxVertex(); j++)
+            {
+                if (graphs[g].getVertex(j) != nullptr && graphs[g].getEdge(i, j) != nullptr)
+                {
+                    Json::Value edge(Json::arrayValue);
+                    edge.append(i);
+                    edge.append(j);
+                    graphJSON["edges"].append(edge);
+                }
+            }
+        }
+        outputFile << Json::writeString(builder, graphJSON) << "\n";
+    }
+    return outputFile.good();
+}
+
+bool writeGraphsBinary(const std::filesystem::path & fileName, const std::vector<Graph> & graphs)
+{
+    std::ofstream outputFile(fileName, std::ios::binary);
+    if (! outputFile.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << " for writing.\n";
+        return false;
+    }
+    std::vector<std::uint32_t> vertices, edges;
+    for (unsigned g = 0; g < graphs.size(); g++)
+    {
+        vertices.clear();
+        edges.clear();
+        for (unsigned i = 0; i < graphs[g].getMaxVertex(); i++)
+        {
+            if (graphs[g].getVertex(i) == nullptr)
+                continue;
+            vertices.push_back(i);
+            vertices.push_back(graphs[g].getVertex(i)->getLabel());
+            for (unsigned j = 0; j < graphs[g].getMaxVertex(); j++)
+            {
+                if (graphs[g].getVertex(j) != nullptr && graphs[g].getEdge(i, j) != nullptr)
+                {
+                    edges.push_back(i);
+                    edges.push_back(j);
+                }
+            }
+        }
+        std::uint32_t header[4] = {recordMagic, g, (std::uint32_t) vertices.size() / 2, (std::uint32_t) edges.size() / 2};
+        outputFile.write((const char *) header, sizeof(header));
+        outputFile.write((const char *) vertices.data(), vertices.size() * sizeof(std::uint32_t));
+        outputFile.write((const char *) edges.data(), edges.size() * sizeof(std::uint32_t));
+    }
+    return outputFile.good();
+}
+
+// Add vertices and edges of the graph in JSON format ("features" and "edges") to the empty graph.
+// Labels are numbers, or any strings interned by the table if one is given. False for a label,
+// which isn't a number without the table
+bool readGraph(const Json::Value & sourceJSON, Graph & graph, LabelTable * labels)
+{
+    std::vector<unsigned> ft;
+    std::set<std::pair<unsigned, unsigned>> edgesSet;
+    for (unsigned i = 0; i < sourceJSON["features"].size(); i++)
+    {
+        const Json::Value & feature = sourceJSON["features"][std::to_string(i)];
+        if (! feature.isString() && ! feature.isNumeric())
+            return false;
+        std::string label = feature.asString();
+        if (labels != nullptr)
+        {
+            ft.push_back(labels->intern(label));
+            continue;
+        }
+        if (feature.isNumeric())
+        {
+            ft.push_back(feature.asUInt());
+            continue;
+        }
+        char * end;
+        ft.push_back((unsigned) std::strtoul(label.c_str(), &end, 10));
+        if (label.empty() || *end != '\0')
+            return false;
+    }
+    for (unsigned i = 0; i < sourceJSON["edges"].size(); i++)
+    {
+        std::pair<unsigned, unsigned> temp;
+        temp.first = sourceJSON["edges"][i][0].asUInt();
+        temp.second = sourceJSON["edges"][i][1].asUInt();
+        edgesSet.insert(temp);
+    }
+    for (unsigned i = 0; i < ft.size(); i++)
+        graph.addVertex(i, ft[i]);
+    for (std::set<std::pair<unsigned, unsigned>>::iterator i = edgesSet.cbegin(); i != edgesSet.cend(); i++)
+        graph.addEdge((*i).first, (*i).second);
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef GRAPHREADER_HPP
+#define GRAPHREADER_HPP
+
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <json/json.h>
+#include "Graph.hpp"
+#include "LabelTable.hpp"
+
+// Receives graphs read one by one: number of the graph and the graph, which may be moved from.
+// Returns false to stop reading
+typedef std::function<bool(unsigned, Graph &)> GraphConsumer;
+
+bool readGraphs(const std::filesystem::path &, std::vector<Graph> &, LabelTable * = nullptr);
+
+bool streamGraphs(const std::filesystem::path &, const GraphConsumer &, LabelTable * = nullptr);
+
+bool readNewGraphs(const std::filesystem::path &, std::vector<Graph> &, unsigned, LabelTable * = nullptr);
+
+void listGraphFiles(const std::filesystem::path &, std::vector<std::filesystem::path> &);
+
+bool readGraphFile(const std::filesystem::path &, Graph &, LabelTable * = nullptr);
+
+bool streamGraphsJSONL(const std::filesystem::path &, const GraphConsumer &, LabelTable * = nullptr);
+
+bool readGraphsJSONL(const std::filesystem::path &, std::vector<Graph> &, unsigned, LabelTable * = nullptr);
+
+bool streamGraphsBinary(const std::filesystem::path &, const GraphConsumer &);
+
+bool readGraphsBinary(const std::filesystem::path &, std::vector<Graph> &, unsigned);
+
+bool writeGraphsJSONL(const std::filesystem::path &, const std::vector<Graph> &, const LabelTable * = nullptr);
+
+bool writeGraphsBinary(const std::filesystem::path &, const std::vector<Graph> &);
+
+bool readGraph(const Json::Value &, Graph &, LabelTable * = nullptr);
+
+#endif
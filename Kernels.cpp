@@ -0,0 +1,294 @@
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include "Kernels.hpp"
+
+std::vector<const Kernels *> getBestKernels();
+
+std::vector<double> getExpTable();
+
+const unsigned expTableSize = 1024; // Intervals of [expCutoff, 0]
+
+const char * expMethodNames[] = {"exact", "table", "polynomial"};
+
+double portableDot(const double * x, const double * y, unsigned n)
+{
+    double result = 0.0L;
+    for (unsigned i = 0; i < n; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+void portableAxpy(double a, const double * x, double * y, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        y[i] += a * x[i];
+}
+
+void portableScaledAdd(double a, double * y, double b, const double * x, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        y[i] = a * y[i] + b * x[i];
+}
+
+void portableBatchedDot(const double * x, const double * const * rows, double * out, unsigned k, unsigned n)
+{
+    for (unsigned j = 0; j < k; j++)
+        out[j] = portableDot(x, rows[j], n);
+}
+
+void portableSoftmaxWeightedSum(const double * const * rows, double * scores, double * out, unsigned k, unsigned n, ExpMethod method)
+{
+    softmaxWeights(scores, k, method);
+    for (unsigned i = 0; i < n; i++)
+        out[i] = 0.0L;
+    for (unsigned j = 0; j < k; j++)
+        portableAxpy(scores[j], rows[j], out, n);
+}
+
+const Kernels portableKernels = {"portable", portableDot, portableAxpy, portableScaledAdd, portableBatchedDot, portableSoftmaxWeightedSum};
+
+// Kernels for vectors of length D known at compile time (argument n is ignored), loops have
+// fixed length without remainders, so the compiler unrolls and vectorizes them
+
+template <unsigned D> double portableFixedDot(const double * x, const double * y, unsigned)
+{
+    // Eight independent partial sums, so that the reduction is vectorized
+    double partial[8] = {};
+#pragma GCC unroll 8
+    for (unsigned i = 0; i < D; i += 8)
+    {
+        for (unsigned l = 0; l < 8; l++)
+            partial[l] += x[i + l] * y[i + l];
+    }
+    return ((partial[0] + partial[1]) + (partial[2] + partial[3])) + ((partial[4] + partial[5]) + (partial[6] + partial[7]));
+}
+
+template <unsigned D> void portableFixedAxpy(double a, const double * x, double * y, unsigned)
+{
+#pragma GCC ivdep
+    for (unsigned i = 0; i < D; i++)
+        y[i] += a * x[i];
+}
+
+template <unsigned D> void portableFixedScaledAdd(double a, double * y, double b, const double * x, unsigned)
+{
+#pragma GCC ivdep
+    for (unsigned i = 0; i < D; i++)
+        y[i] = a * y[i] + b * x[i];
+}
+
+// Blocks of four rows, so that every load of x is used four times
+template <unsigned D> void portableFixedBatchedDot(const double * x, const double * const * rows, double * out, unsigned k, unsigned)
+{
+    unsigned j = 0;
+    for (; j + 4 <= k; j += 4)
+    {
+        const double * row0 = rows[j], * row1 = rows[j + 1], * row2 = rows[j + 2], * row3 = rows[j + 3];
+        double partial0[8] = {}, partial1[8] = {}, partial2[8] = {}, partial3[8] = {};
+        for (unsigned i = 0; i < D; i += 8)
+        {
+            for (unsigned l = 0; l < 8; l++)
+            {
+                partial0[l] += x[i + l] * row0[i + l];
+                partial1[l] += x[i + l] * row1[i + l];
+                partial2[l] += x[i + l] * row2[i + l];
+                partial3[l] += x[i + l] * row3[i + l];
+            }
+        }
+        out[j] = ((partial0[0] + partial0[1]) + (partial0[2] + partial0[3])) + ((partial0[4] + partial0[5]) + (partial0[6] + partial0[7]));
+        out[j + 1] = ((partial1[0] + partial1[1]) + (partial1[2] + partial1[3])) + ((partial1[4] + partial1[5]) + (partial1[6] + partial1[7]));
+        out[j + 2] = ((partial2[0] + partial2[1]) + (partial2[2] + partial2[3])) + ((partial2[4] + partial2[5]) + (partial2[6] + partial2[7]));
+        out[j + 3] = ((partial3[0] + partial3[1]) + (partial3[2] + partial3[3])) + ((partial3[4] + partial3[5]) + (partial3[6] + partial3[7]));
+    }
+    for (; j < k; j++)
+        out[j] = portableFixedDot<D>(x, rows[j], D);
+}
+
+template <unsigned D> void portableFixedSoftmaxWeightedSum(const double * const * rows, double * scores, double * out, unsigned k, unsigned, ExpMethod method)
+{
+    softmaxWeights(scores, k, method);
+    alignas(64) double sum[D] = {};
+    for (unsigned j = 0; j < k; j++)
+    {
+        const double * row = rows[j];
+        double weight = scores[j];
+#pragma GCC ivdep
+        for (unsigned i = 0; i < D; i++)
+            sum[i] += weight * row[i];
+    }
+    for (unsigned i = 0; i < D; i++)
+        out[i] = sum[i];
+}
+
+template <unsigned D> constexpr Kernels getPortableFixedKernels(const char * name)
+{
+    return Kernels{name, portableFixedDot<D>, portableFixedAxpy<D>, portableFixedScaledAdd<D>, portableFixedBatchedDot<D>, portableFixedSoftmaxWeightedSum<D>};
+}
+
+const Kernels portableFixedKernels[fixedDimensionsCount] = {getPortableFixedKernels<16>("portable 16"), getPortableFixedKernels<32>("portable 32"),
+                                                            getPortableFixedKernels<64>("portable 64"), getPortableFixedKernels<128>("portable 128"),
+                                                            getPortableFixedKernels<256>("portable 256")};
+
+// Softmax of scores in place, scores more than 7 below the maximum get weight 0
+void softmaxWeights(double * scores, unsigned k, ExpMethod method)
+{
+    if (k == 0)
+        return;
+    double maxScore = scores[0];
+    for (unsigned j = 1; j < k; j++)
+    {
+        if (maxScore < scores[j])
+            maxScore = scores[j];
+    }
+    for (unsigned j = 0; j < k; j++)
+        scores[j] -= maxScore;
+    expNegative(scores, k, method);
+    double sum = 0.0L;
+    for (unsigned j = 0; j < k; j++)
+        sum += scores[j];
+    for (unsigned j = 0; j < k; j++)
+        scores[j] /= sum;
+}
+
+bool parseExpMethod(ExpMethod & method, const char * name)
+{
+    for (unsigned i = 0; i < sizeof(expMethodNames) / sizeof(expMethodNames[0]); i++)
+    {
+        if (std::strcmp(name, expMethodNames[i]) == 0)
+        {
+            method = (ExpMethod) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char * getExpMethodName(ExpMethod method)
+{
+    return expMethodNames[method];
+}
+
+// exp of every value (at most 0) in place by the chosen method
+void expNegative(double * values, unsigned k, ExpMethod method)
+{
+    if (method == tableExp)
+        tableExpNegative(values, k);
+    else if (method == polynomialExp)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        if (avx2)
+        {
+            avx2PolynomialExpNegative(values, k);
+            return;
+        }
+#endif
+        portablePolynomialExpNegative(values, k);
+    }
+    else
+        exactExpNegative(values, k);
+}
+
+void exactExpNegative(double * values, unsigned k)
+{
+    for (unsigned j = 0; j < k; j++)
+        values[j] = values[j] < expCutoff ? 0.0L : std::exp(values[j]);
+}
+
+// Values of exp at expTableSize + 1 points of [expCutoff, 0], like expTable of the original word2vec,
+// but interpolated between them
+void tableExpNegative(double * values, unsigned k)
+{
+    static const std::vector<double> table = getExpTable();
+    const double scale = expTableSize / -expCutoff;
+    for (unsigned j = 0; j < k; j++)
+    {
+        if (values[j] < expCutoff)
+        {
+            values[j] = 0.0L;
+            continue;
+        }
+        double position = (values[j] - expCutoff) * scale;
+        unsigned i = position;
+        if (i >= expTableSize)
+            i = expTableSize - 1;
+        double t = position - i;
+        values[j] = table[i] + t * (table[i + 1] - table[i]);
+    }
+}
+
+std::vector<double> getExpTable()
+{
+    std::vector<double> table(expTableSize + 1);
+    for (unsigned i = 0; i <= expTableSize; i++)
+        table[i] = std::exp(expCutoff - expCutoff * i / expTableSize);
+    return table;
+}
+
+// x = k ln 2 + r, exp(x) = 2^k exp(r). k is rounded by adding 1.5 * 2^52, so that it's in the low bits
+// of the mantissa, from which the exponent of 2^k is made. ln 2 is split into two parts, so that r is exact
+void portablePolynomialExpNegative(double * values, unsigned k)
+{
+    const double magic = 6755399441055744.0, log2e = 1.4426950408889634, ln2High = 0.693145751953125, ln2Low = 1.4286068203094173e-06;
+    for (unsigned j = 0; j < k; j++)
+    {
+        double x = values[j];
+        double shifted = x * log2e + magic;
+        double n = shifted - magic;
+        double r = x - n * ln2High - n * ln2Low;
+        double p = 1.0 / 5040;
+        p = p * r + 1.0 / 720;
+        p = p * r + 1.0 / 120;
+        p = p * r + 1.0 / 24;
+        p = p * r + 1.0 / 6;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+        std::uint64_t bits;
+        std::memcpy(&bits, &shifted, sizeof(bits));
+        bits = (bits + 1023) << 52;
+        double power;
+        std::memcpy(&power, &bits, sizeof(power));
+        values[j] = x < expCutoff ? 0.0L : p * power;
+    }
+}
+
+// Kernels of every instruction set supported by the processor, from the portable ones to the fastest
+std::vector<const Kernels *> getSupportedKernels(unsigned dimensions)
+{
+    unsigned fixed = 0;
+    while (fixed < fixedDimensionsCount && fixedDimensions[fixed] != dimensions)
+        fixed++;
+    std::vector<const Kernels *> result;
+    result.push_back(fixed < fixedDimensionsCount ? &portableFixedKernels[fixed] : &portableKernels);
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        result.push_back(fixed < fixedDimensionsCount ? &avx2FixedKernels[fixed] : &avx2Kernels);
+    if (__builtin_cpu_supports("avx512f"))
+        result.push_back(fixed < fixedDimensionsCount ? &avx512FixedKernels[fixed] : &avx512Kernels);
+#endif
+    return result;
+}
+
+// The fastest kernels of any length, followed by the fastest ones of every fixed length
+std::vector<const Kernels *> getBestKernels()
+{
+    std::vector<const Kernels *> result(1, getSupportedKernels().back());
+    for (unsigned i = 0; i < fixedDimensionsCount; i++)
+        result.push_back(getSupportedKernels(fixedDimensions[i]).back());
+    return result;
+}
+
+const Kernels & getKernels(unsigned dimensions)
+{
+    static const std::vector<const Kernels *> kernels = getBestKernels();
+    for (unsigned i = 0; i < fixedDimensionsCount; i++)
+    {
+        if (fixedDimensions[i] == dimensions)
+            return *kernels[i + 1];
+    }
+    return *kernels[0];
+}
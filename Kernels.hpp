@@ -0,0 +1,77 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <vector>
+
+// Evaluation of exp in softmax of training (softmaxWeights and word2vec), passed by the caller, so
+// models of other methods may train in one process at once. Arguments are at most 0, those below
+// expCutoff give 0 with every method. Relative error on [expCutoff, 0]: exactExp is std::exp, tableExp interpolates linearly between 1024 values
+// (error below h^2 / 8 * e^h = 5.9e-6 for the step h = 7 / 1024), polynomialExp is 2^k times
+// Taylor polynomial of degree 7 of the rest |r| <= ln 2 / 2 (error below 7.5e-9), vectorized
+enum ExpMethod
+{
+    exactExp,
+    tableExp,
+    polynomialExp
+};
+
+const double expCutoff = -7.0;
+
+// Vector kernels of embedding training. Every kernel has portable, AVX2 and AVX-512 version,
+// getKernels chooses the best one supported by the processor at run time. For the common
+// embedding dimensions (fixedDimensions) there are also versions of fixed vector length
+struct Kernels
+{
+    const char * name;
+    // x . y
+    double (*dot)(const double * x, const double * y, unsigned n);
+    // y += a * x
+    void (*axpy)(double a, const double * x, double * y, unsigned n);
+    // y = a * y + b * x
+    void (*scaledAdd)(double a, double * y, double b, const double * x, unsigned n);
+    // out[j] = x . rows[j] for j < k
+    void (*batchedDot)(const double * x, const double * const * rows, double * out, unsigned k, unsigned n);
+    // out = sum of softmax(scores)[j] * rows[j] for j < k, scores are replaced by softmax weights
+    void (*softmaxWeightedSum)(const double * const * rows, double * scores, double * out, unsigned k, unsigned n, ExpMethod method);
+};
+
+const unsigned fixedDimensions[] = {16, 32, 64, 128, 256};
+
+const unsigned fixedDimensionsCount = sizeof(fixedDimensions) / sizeof(fixedDimensions[0]);
+
+// Kernels for vectors of the given length, 0 for kernels of any length
+const Kernels & getKernels(unsigned = 0);
+
+std::vector<const Kernels *> getSupportedKernels(unsigned = 0);
+
+void softmaxWeights(double *, unsigned, ExpMethod);
+
+bool parseExpMethod(ExpMethod &, const char *);
+
+const char * getExpMethodName(ExpMethod);
+
+void expNegative(double *, unsigned, ExpMethod);
+
+void exactExpNegative(double *, unsigned);
+
+void tableExpNegative(double *, unsigned);
+
+void portablePolynomialExpNegative(double *, unsigned);
+
+extern const Kernels portableKernels;
+
+extern const Kernels portableFixedKernels[fixedDimensionsCount];
+
+#if defined(__x86_64__) || defined(__i386__)
+extern const Kernels avx2Kernels;
+
+extern const Kernels avx2FixedKernels[fixedDimensionsCount];
+
+extern const Kernels avx512Kernels;
+
+extern const Kernels avx512FixedKernels[fixedDimensionsCount];
+
+void avx2PolynomialExpNegative(double *, unsigned);
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+#include "Kernels.hpp"
+
+// This file is compiled with -mavx2 -mfma, its kernels are called only if processor supports them
+
+static inline double horizontalSum(__m256d v)
+{
+    __m128d low = _mm256_castpd256_pd128(v), high = _mm256_extractf128_pd(v, 1);
+    low = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+double avx2Dot(const double * x, const double * y, unsigned n)
+{
+    __m256d sum1 = _mm256_setzero_pd(), sum2 = _mm256_setzero_pd();
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), sum1);
+        sum2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), sum2);
+    }
+    if (i + 4 <= n)
+    {
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), sum1);
+        i += 4;
+    }
+    double result = horizontalSum(_mm256_add_pd(sum1, sum2));
+    for (; i < n; i++)
+        result += x[i] * y[i];
+    return result;
+}
+
+void avx2Axpy(double a, const double * x, double * y, unsigned n)
+{
+    __m256d va = _mm256_set1_pd(a);
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    for (; i < n; i++)
+        y[i] += a * x[i];
+}
+
+void avx2ScaledAdd(double a, double * y, double b, const double * x, unsigned n)
+{
+    __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(vb, _mm256_loadu_pd(x + i), _mm256_mul_pd(va, _mm256_loadu_pd(y + i))));
+    for (; i < n; i++)
+        y[i] = a * y[i] + b * x[i];
+}
+
+// Four rows at once, so every load of x is used four times
+void avx2BatchedDot(const double * x, const double * const * rows, double * out, unsigned k, unsigned n)
+{
+    unsigned j = 0;
+    for (; j + 4 <= k; j += 4)
+    {
+        __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd(), sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+        unsigned i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256d vx = _mm256_loadu_pd(x + i);
+            sum0 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j] + i), sum0);
+            sum1 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j + 1] + i), sum1);
+            sum2 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j + 2] + i), sum2);
+            sum3 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j + 3] + i), sum3);
+        }
+        out[j] = horizontalSum(sum0);
+        out[j + 1] = horizontalSum(sum1);
+        out[j + 2] = horizontalSum(sum2);
+        out[j + 3] = horizontalSum(sum3);
+        for (; i < n; i++)
+        {
+            out[j] += x[i] * rows[j][i];
+            out[j + 1] += x[i] * rows[j + 1][i];
+            out[j + 2] += x[i] * rows[j + 2][i];
+            out[j + 3] += x[i] * rows[j + 3][i];
+        }
+    }
+    for (; j < k; j++)
+        out[j] = avx2Dot(x, rows[j], n);
+}
+
+void avx2SoftmaxWeightedSum(const double * const * rows, double * scores, double * out, unsigned k, unsigned n, ExpMethod method)
+{
+    softmaxWeights(scores, k, method);
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d sum = _mm256_setzero_pd();
+        for (unsigned j = 0; j < k; j++)
+            sum = _mm256_fmadd_pd(_mm256_set1_pd(scores[j]), _mm256_loadu_pd(rows[j] + i), sum);
+        _mm256_storeu_pd(out + i, sum);
+    }
+    for (; i < n; i++)
+    {
+        out[i] = 0.0L;
+        for (unsigned j = 0; j < k; j++)
+            out[i] += scores[j] * rows[j][i];
+    }
+}
+
+const Kernels avx2Kernels = {"avx2", avx2Dot, avx2Axpy, avx2ScaledAdd, avx2BatchedDot, avx2SoftmaxWeightedSum};
+
+// Kernels for vectors of length D known at compile time (argument n is ignored), multiple of 8
+
+template <unsigned D> double avx2FixedDot(const double * x, const double * y, unsigned)
+{
+    __m256d sum1 = _mm256_setzero_pd(), sum2 = _mm256_setzero_pd();
+    for (unsigned i = 0; i < D; i += 8)
+    {
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), sum1);
+        sum2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), sum2);
+    }
+    return horizontalSum(_mm256_add_pd(sum1, sum2));
+}
+
+template <unsigned D> void avx2FixedAxpy(double a, const double * x, double * y, unsigned)
+{
+    __m256d va = _mm256_set1_pd(a);
+    for (unsigned i = 0; i < D; i += 4)
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+}
+
+template <unsigned D> void avx2FixedScaledAdd(double a, double * y, double b, const double * x, unsigned)
+{
+    __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+    for (unsigned i = 0; i < D; i += 4)
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(vb, _mm256_loadu_pd(x + i), _mm256_mul_pd(va, _mm256_loadu_pd(y + i))));
+}
+
+template <unsigned D> void avx2FixedBatchedDot(const double * x, const double * const * rows, double * out, unsigned k, unsigned)
+{
+    unsigned j = 0;
+    for (; j + 4 <= k; j += 4)
+    {
+        __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd(), sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+        for (unsigned i = 0; i < D; i += 4)
+        {
+            __m256d vx = _mm256_loadu_pd(x + i);
+            sum0 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j] + i), sum0);
+            sum1 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j + 1] + i), sum1);
+            sum2 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j + 2] + i), sum2);
+            sum3 = _mm256_fmadd_pd(vx, _mm256_loadu_pd(rows[j + 3] + i), sum3);
+        }
+        out[j] = horizontalSum(sum0);
+        out[j + 1] = horizontalSum(sum1);
+        out[j + 2] = horizontalSum(sum2);
+        out[j + 3] = horizontalSum(sum3);
+    }
+    for (; j < k; j++)
+        out[j] = avx2FixedDot<D>(x, rows[j], D);
+}
+
+// Sums of blocks of 32 elements stay in registers while all rows are added
+template <unsigned D> void avx2FixedSoftmaxWeightedSum(const double * const * rows, double * scores, double * out, unsigned k, unsigned, ExpMethod method)
+{
+    const unsigned block = D < 32 ? D : 32;
+    softmaxWeights(scores, k, method);
+    for (unsigned b = 0; b < D; b += block)
+    {
+        __m256d sum[block / 4];
+        for (unsigned i = 0; i < block / 4; i++)
+            sum[i] = _mm256_setzero_pd();
+        for (unsigned j = 0; j < k; j++)
+        {
+            __m256d weight = _mm256_set1_pd(scores[j]);
+            for (unsigned i = 0; i < block / 4; i++)
+                sum[i] = _mm256_fmadd_pd(weight, _mm256_loadu_pd(rows[j] + b + 4 * i), sum[i]);
+        }
+        for (unsigned i = 0; i < block / 4; i++)
+            _mm256_storeu_pd(out + b + 4 * i, sum[i]);
+    }
+}
+
+template <unsigned D> constexpr Kernels getAvx2FixedKernels(const char * name)
+{
+    return Kernels{name, avx2FixedDot<D>, avx2FixedAxpy<D>, avx2FixedScaledAdd<D>, avx2FixedBatchedDot<D>, avx2FixedSoftmaxWeightedSum<D>};
+}
+
+const Kernels avx2FixedKernels[fixedDimensionsCount] = {getAvx2FixedKernels<16>("avx2 16"), getAvx2FixedKernels<32>("avx2 32"), getAvx2FixedKernels<64>("avx2 64"),
+                                                        getAvx2FixedKernels<128>("avx2 128"), getAvx2FixedKernels<256>("avx2 256")};
+
+// Polynomial exp of portablePolynomialExpNegative, four values at once
+void avx2PolynomialExpNegative(double * values, unsigned k)
+{
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0), log2e = _mm256_set1_pd(1.4426950408889634);
+    const __m256d ln2High = _mm256_set1_pd(0.693145751953125), ln2Low = _mm256_set1_pd(1.4286068203094173e-06);
+    const __m256d cutoff = _mm256_set1_pd(expCutoff);
+    const double coefficients[8] = {1.0 / 5040, 1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 0.5, 1.0, 1.0};
+    unsigned j = 0;
+    for (; j + 4 <= k; j += 4)
+    {
+        __m256d x = _mm256_loadu_pd(values + j);
+        __m256d shifted = _mm256_fmadd_pd(x, log2e, magic);
+        __m256d n = _mm256_sub_pd(shifted, magic);
+        __m256d r = _mm256_fnmadd_pd(n, ln2Low, _mm256_fnmadd_pd(n, ln2High, x));
+        __m256d p = _mm256_set1_pd(coefficients[0]);
+        for (unsigned c = 1; c < 8; c++)
+            p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(coefficients[c]));
+        __m256i bits = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(shifted), _mm256_set1_epi64x(1023)), 52);
+        __m256d result = _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+        _mm256_storeu_pd(values + j, _mm256_andnot_pd(_mm256_cmp_pd(x, cutoff, _CMP_LT_OQ), result));
+    }
+    portablePolynomialExpNegative(values + j, k - j);
+}
+
+#endif
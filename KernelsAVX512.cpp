@@ -0,0 +1,199 @@
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+#include "Kernels.hpp"
+
+// This file is compiled with -mavx512f, its kernels are called only if processor supports it.
+// Tails shorter than 8 elements are handled with masked loads and stores
+
+static inline __mmask8 tailMask(unsigned n)
+{
+    return (__mmask8) ((1U << n) - 1);
+}
+
+static inline double reduceSum(__m512d v)
+{
+    alignas(64) double elements[8];
+    _mm512_store_pd(elements, v);
+    return ((elements[0] + elements[1]) + (elements[2] + elements[3])) + ((elements[4] + elements[5]) + (elements[6] + elements[7]));
+}
+
+double avx512Dot(const double * x, const double * y, unsigned n)
+{
+    __m512d sum1 = _mm512_setzero_pd(), sum2 = _mm512_setzero_pd();
+    unsigned i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), sum1);
+        sum2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), sum2);
+    }
+    for (; i + 8 <= n; i += 8)
+        sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), sum1);
+    if (i < n)
+    {
+        __mmask8 mask = tailMask(n - i);
+        sum2 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), sum2);
+    }
+    return reduceSum(_mm512_add_pd(sum1, sum2));
+}
+
+void avx512Axpy(double a, const double * x, double * y, unsigned n)
+{
+    __m512d va = _mm512_set1_pd(a);
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+    if (i < n)
+    {
+        __mmask8 mask = tailMask(n - i);
+        _mm512_mask_storeu_pd(y + i, mask, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i)));
+    }
+}
+
+void avx512ScaledAdd(double a, double * y, double b, const double * x, unsigned n)
+{
+    __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(vb, _mm512_loadu_pd(x + i), _mm512_mul_pd(va, _mm512_loadu_pd(y + i))));
+    if (i < n)
+    {
+        __mmask8 mask = tailMask(n - i);
+        __m512d result = _mm512_fmadd_pd(vb, _mm512_maskz_loadu_pd(mask, x + i), _mm512_mul_pd(va, _mm512_maskz_loadu_pd(mask, y + i)));
+        _mm512_mask_storeu_pd(y + i, mask, result);
+    }
+}
+
+// Four rows at once, so every load of x is used four times
+void avx512BatchedDot(const double * x, const double * const * rows, double * out, unsigned k, unsigned n)
+{
+    unsigned j = 0;
+    for (; j + 4 <= k; j += 4)
+    {
+        __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd(), sum2 = _mm512_setzero_pd(), sum3 = _mm512_setzero_pd();
+        unsigned i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m512d vx = _mm512_loadu_pd(x + i);
+            sum0 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j] + i), sum0);
+            sum1 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j + 1] + i), sum1);
+            sum2 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j + 2] + i), sum2);
+            sum3 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j + 3] + i), sum3);
+        }
+        if (i < n)
+        {
+            __mmask8 mask = tailMask(n - i);
+            __m512d vx = _mm512_maskz_loadu_pd(mask, x + i);
+            sum0 = _mm512_fmadd_pd(vx, _mm512_maskz_loadu_pd(mask, rows[j] + i), sum0);
+            sum1 = _mm512_fmadd_pd(vx, _mm512_maskz_loadu_pd(mask, rows[j + 1] + i), sum1);
+            sum2 = _mm512_fmadd_pd(vx, _mm512_maskz_loadu_pd(mask, rows[j + 2] + i), sum2);
+            sum3 = _mm512_fmadd_pd(vx, _mm512_maskz_loadu_pd(mask, rows[j + 3] + i), sum3);
+        }
+        out[j] = reduceSum(sum0);
+        out[j + 1] = reduceSum(sum1);
+        out[j + 2] = reduceSum(sum2);
+        out[j + 3] = reduceSum(sum3);
+    }
+    for (; j < k; j++)
+        out[j] = avx512Dot(x, rows[j], n);
+}
+
+void avx512SoftmaxWeightedSum(const double * const * rows, double * scores, double * out, unsigned k, unsigned n, ExpMethod method)
+{
+    softmaxWeights(scores, k, method);
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        __mmask8 mask = n - i >= 8 ? 0xFF : tailMask(n - i);
+        __m512d sum = _mm512_setzero_pd();
+        for (unsigned j = 0; j < k; j++)
+            sum = _mm512_fmadd_pd(_mm512_set1_pd(scores[j]), _mm512_maskz_loadu_pd(mask, rows[j] + i), sum);
+        _mm512_mask_storeu_pd(out + i, mask, sum);
+    }
+}
+
+const Kernels avx512Kernels = {"avx512", avx512Dot, avx512Axpy, avx512ScaledAdd, avx512BatchedDot, avx512SoftmaxWeightedSum};
+
+// Kernels for vectors of length D known at compile time (argument n is ignored), multiple of 8
+
+template <unsigned D> double avx512FixedDot(const double * x, const double * y, unsigned)
+{
+    __m512d sum1 = _mm512_setzero_pd(), sum2 = _mm512_setzero_pd();
+    unsigned i = 0;
+    for (; i + 16 <= D; i += 16)
+    {
+        sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), sum1);
+        sum2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), sum2);
+    }
+    if (i < D)
+        sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), sum1);
+    return reduceSum(_mm512_add_pd(sum1, sum2));
+}
+
+template <unsigned D> void avx512FixedAxpy(double a, const double * x, double * y, unsigned)
+{
+    __m512d va = _mm512_set1_pd(a);
+    for (unsigned i = 0; i < D; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+}
+
+template <unsigned D> void avx512FixedScaledAdd(double a, double * y, double b, const double * x, unsigned)
+{
+    __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+    for (unsigned i = 0; i < D; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(vb, _mm512_loadu_pd(x + i), _mm512_mul_pd(va, _mm512_loadu_pd(y + i))));
+}
+
+template <unsigned D> void avx512FixedBatchedDot(const double * x, const double * const * rows, double * out, unsigned k, unsigned)
+{
+    unsigned j = 0;
+    for (; j + 4 <= k; j += 4)
+    {
+        __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd(), sum2 = _mm512_setzero_pd(), sum3 = _mm512_setzero_pd();
+        for (unsigned i = 0; i < D; i += 8)
+        {
+            __m512d vx = _mm512_loadu_pd(x + i);
+            sum0 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j] + i), sum0);
+            sum1 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j + 1] + i), sum1);
+            sum2 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j + 2] + i), sum2);
+            sum3 = _mm512_fmadd_pd(vx, _mm512_loadu_pd(rows[j + 3] + i), sum3);
+        }
+        out[j] = reduceSum(sum0);
+        out[j + 1] = reduceSum(sum1);
+        out[j + 2] = reduceSum(sum2);
+        out[j + 3] = reduceSum(sum3);
+    }
+    for (; j < k; j++)
+        out[j] = avx512FixedDot<D>(x, rows[j], D);
+}
+
+// Sums of blocks of 64 elements stay in registers while all rows are added
+template <unsigned D> void avx512FixedSoftmaxWeightedSum(const double * const * rows, double * scores, double * out, unsigned k, unsigned, ExpMethod method)
+{
+    const unsigned block = D < 64 ? D : 64;
+    softmaxWeights(scores, k, method);
+    for (unsigned b = 0; b < D; b += block)
+    {
+        __m512d sum[block / 8];
+        for (unsigned i = 0; i < block / 8; i++)
+            sum[i] = _mm512_setzero_pd();
+        for (unsigned j = 0; j < k; j++)
+        {
+            __m512d weight = _mm512_set1_pd(scores[j]);
+            for (unsigned i = 0; i < block / 8; i++)
+                sum[i] = _mm512_fmadd_pd(weight, _mm512_loadu_pd(rows[j] + b + 8 * i), sum[i]);
+        }
+        for (unsigned i = 0; i < block / 8; i++)
+            _mm512_storeu_pd(out + b + 8 * i, sum[i]);
+    }
+}
+
+template <unsigned D> constexpr Kernels getAvx512FixedKernels(const char * name)
+{
+    return Kernels{name, avx512FixedDot<D>, avx512FixedAxpy<D>, avx512FixedScaledAdd<D>, avx512FixedBatchedDot<D>, avx512FixedSoftmaxWeightedSum<D>};
+}
+
+const Kernels avx512FixedKernels[fixedDimensionsCount] = {getAvx512FixedKernels<16>("avx512 16"), getAvx512FixedKernels<32>("avx512 32"),
+                                                          getAvx512FixedKernels<64>("avx512 64"), getAvx512FixedKernels<128>("avx512 128"),
+                                                          getAvx512FixedKernels<256>("avx512 256")};
+
+#endif
@@ -0,0 +1,102 @@
+#include <mutex>
+#include "LabelTable.hpp"
+
+LabelTable::LabelTable()
+{
+}
+
+LabelTable::LabelTable(const LabelTable & table)
+{
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    numbers = table.numbers;
+    labels = table.labels;
+}
+
+LabelTable & LabelTable::operator=(const LabelTable & table)
+{
+    if (this == &table)
+        return *this;
+    std::scoped_lock lock(mutex, table.mutex);
+    numbers = table.numbers;
+    labels = table.labels;
+    return *this;
+}
+
+// Number of the label, a new label gets the next number
+unsigned LabelTable::intern(const std::string & label)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        std::unordered_map<std::string, unsigned>::const_iterator found = numbers.find(label);
+        if (found != numbers.cend())
+            return found->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::pair<std::unordered_map<std::string, unsigned>::iterator, bool> inserted = numbers.emplace(label, labels.size());
+    if (inserted.second)
+        labels.push_back(label);
+    return inserted.first->second;
+}
+
+bool LabelTable::find(const std::string & label, unsigned & number) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::unordered_map<std::string, unsigned>::const_iterator found = numbers.find(label);
+    if (found == numbers.cend())
+        return false;
+    number = found->second;
+    return true;
+}
+
+// Copy of the label of the number, also while other threads intern. False for an unknown number
+bool LabelTable::copyLabel(unsigned number, std::string & label) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (number >= labels.size())
+        return false;
+    label = labels[number];
+    return true;
+}
+
+// Label of the number, not while other threads intern
+const std::string & LabelTable::getLabel(unsigned number) const
+{
+    return labels[number];
+}
+
+const std::vector<std::string> & LabelTable::getLabels() const
+{
+    return labels;
+}
+
+// Labels numbered by their positions, false (and the table is empty) if a label repeats
+bool LabelTable::assign(const std::vector<std::string> & newLabels)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    numbers.clear();
+    labels.clear();
+    numbers.reserve(newLabels.size());
+    for (unsigned i = 0; i < newLabels.size(); i++)
+    {
+        if (! numbers.emplace(newLabels[i], i).second)
+        {
+            numbers.clear();
+            return false;
+        }
+    }
+    labels = newLabels;
+    return true;
+}
+
+unsigned LabelTable::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return labels.size();
+}
+
+void LabelTable::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    numbers.clear();
+    labels.clear();
+}
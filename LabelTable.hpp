@@ -0,0 +1,33 @@
+#ifndef LABELTABLE_HPP
+#define LABELTABLE_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+
+// Dense numbers of string labels of vertices (atom types, opcodes, ...) in the order of their first
+// occurrence, so that graphs of any labels have labels of Graph. Interning of a known label is one
+// lookup of the hash table, threads parsing chunks of a file intern at once (numbers of new labels
+// depend on their order then, the table is saved with the model for graphs read later)
+class LabelTable
+{
+private:
+    std::unordered_map<std::string, unsigned> numbers;
+    std::vector<std::string> labels;
+    mutable std::shared_mutex mutex;
+public:
+    LabelTable();
+    LabelTable(const LabelTable &);
+    LabelTable & operator=(const LabelTable &);
+    unsigned intern(const std::string &);
+    bool find(const std::string &, unsigned &) const;
+    const std::string & getLabel(unsigned) const;
+    bool copyLabel(unsigned, std::string &) const;
+    const std::vector<std::string> & getLabels() const;
+    bool assign(const std::vector<std::string> &);
+    unsigned size() const;
+    void clear();
+};
+
+#endif
@@ -1,48 +1,80 @@
 #include <iostream>
 #include <fstream>
-#include <random>
 #include <vector>
-#include <set>
-#include <utility>
 #include <string>
 #include <cstring>
 #include <cstdlib>
 #include <filesystem>
-#include <json/json.h>
+#include <random>
+#include <thread>
 #include "Graph.hpp"
-#include "word2vec.hpp"
-#include "SubgraphMaps.hpp"
-#include "SubgraphExtract.hpp"
+#include "Graph2Vec.hpp"
+#include "GraphReader.hpp"
+#include "ProductQuantizer.hpp"
+#include "WLKernel.hpp"
+#include "SharedEmbeddings.hpp"
+#include "ParameterSweep.hpp"
+#include "LabelTable.hpp"
 
 int argPos(const char *, int, char **);
 
-void readGraphs(std::filesystem::directory_entry &, std::vector<Graph> &);
-
-std::vector<unsigned> getRandomIndexes(unsigned);
-
-std::vector<std::vector<double>> negativeSampling(unsigned, unsigned, const std::vector<Graph> &, unsigned, const std::vector<std::string> &, unsigned);
-
-void updateGraphsEmbeddings(std::vector<std::vector<double>> &, unsigned, const std::vector<double> &, const std::vector<std::vector<double>> &, double);
+bool writeEmbeddings(const std::filesystem::path &, const std::vector<std::vector<double>> &);
 
 int main(int argc, char ** argv)
 {
     if ((argc == 2 && std::strcmp(argv[1], "--help") == 0) || argc == 1)
     {
-        std::cout << "Usage:\ngraph2vec --dataset <JSON graph files directory>\n";
+        std::cout << "Usage:\ngraph2vec --dataset <JSON graph files directory, JSON lines file (.jsonl) or file of binary graph records>\n";
         std::cout << "\t--output <graphs embeddings file>\n";
         std::cout << "\t--deg <maximum degree of rooted subgraphs> (default: 10)\n";
+        std::cout << "\t--adaptive-degree (stop at the degree, where WL relabeling of the graph stops refining its vertices)\n";
         std::cout << "\t--dim <number of dimensions of embedding vectors> (default: 10)\n";
         std::cout << "\t--ep <number of epochs> (default: 3)\n";
         std::cout << "\t--alpha <learning rate> (default: 0.025)\n";
         std::cout << "\t--neg <number of negative samples> (default: 20)\n";
+        std::cout << "\t--batch <number of graphs relabeled together> (default: 0, graph by graph)\n";
+        std::cout << "\t--update-batch <number of subgraphs in one update of graph embedding> (default: 0, update by every subgraph)\n";
+        std::cout << "\t--threads <number of threads of training of graph embeddings> (default: 1)\n";
+        std::cout << "\t--numa (pin threads of training to NUMA nodes with their graph embeddings and a replica of subgraph embeddings, Linux)\n";
+        std::cout << "\t--dedup (train one graph of every group of WL-equivalent graphs, the others get its embedding)\n";
+        std::cout << "\t--fine-tune <number of epochs of training of deduplicated graphs from embedding of their group> (default: 0)\n";
+        std::cout << "\t--workspace <directory of map files> (default: none, everything is kept in memory)\n";
+        std::cout << "\t--cache <directory of extracted subgraphs of graphs by their content> (default: none, every graph is extracted)\n";
+        std::cout << "\t--hash-buckets <number of subgraph embeddings, subgraphs are hashed into> (default: 0, embedding of every subgraph)\n";
+        std::cout << "\t--max-neighbors <number of adjacent vertices sampled for vertices of greater degree> (default: 0, all of them)\n";
+        std::cout << "\t--sampling-seed <seed of sampling of adjacent vertices> (default: 0)\n";
+        std::cout << "\t--pipeline <number of graphs in queues between stages> (default: 0, stages one after another)\n";
+        std::cout << "\t--exp <exact, table or polynomial, evaluation of exp in softmax> (default: exact)\n";
+        std::cout << "\t--objective <softmax or hs, output layer of word2vec: full softmax or hierarchical softmax over Huffman tree> (default: softmax)\n";
+        std::cout << "\t--reorder <degree, bfs or rcm, renumbering of vertices after reading> (default: original)\n";
+        std::cout << "\t--string-labels (labels of vertices of JSON graphs and updates are any strings, numbered by the label table saved with the model)\n";
+        std::cout << "\t--updates <file of insertions and deletions of vertices and edges of the graphs, applied after fit, not with --reorder or --pipeline>\n";
+        std::cout << "\t--refresh-epochs <number of epochs of training of embedding of updated graph> (default: 1)\n";
+        std::cout << "\t--model <model file> (written after fit)\n";
+        std::cout << "\t--append (load the model file and fit only graphs of the dataset after its graphs, parameters are of the model)\n";
+        std::cout << "\t--append-epochs <number of epochs of training of appended graphs> (default: --ep of the model)\n";
+        std::cout << "\t--append-samples <number of fitted graphs trained with appended graphs> (default: 0, as many as the appended graphs)\n";
+        std::cout << "\t--shm <name of POSIX shared memory segment> (publish graphs embeddings there for readers of SharedEmbeddings.hpp)\n";
+        std::cout << "\t--shm-checkpoint (publish graphs embeddings after every epoch of their training too)\n";
+        std::cout << "\t--perf-counters (count cycles, instructions, LLC, branch and dTLB misses of the stages of fit by perf_event_open, Linux)\n";
         std::cout << "\t--clean (clean map files)\n";
+        std::cout << "\t--pq <number of subspaces> (product quantize embeddings to <output>.graphs.pq and <output>.subgraphs.pq)\n";
+        std::cout << "\t--pq-centroids <number of centroids of every subspace, at most 256> (default: 256)\n";
+        std::cout << "graph2vec --dataset <dataset> --output <graphs embeddings file> --sweep <grid of training parameters, as \"dim=16,32;alpha=0.025,0.05;neg=10,20;ep=3\">\n";
+        std::cout << "\t[--sweep-threads <number of configurations trained at once> (default: number of hardware threads)] [options of extraction]\n";
+        std::cout << "\t(embeddings of every configuration to <output stem>.<configuration><output extension>, summary to <output stem>.sweep.tsv)\n";
+        std::cout << "graph2vec --dataset <dataset> --convert <JSON lines file (.jsonl) or file of binary graph records> [--string-labels (kept as strings in JSON lines only)]\n";
+        std::cout << "graph2vec --dataset <dataset> [--wl-features <libsvm file of counts of subgraphs>] [--wl-kernel <WL subtree kernel matrix file>]\n";
+        std::cout << "\t[--wl-normalize (cosine normalized kernel)] [options of extraction: --deg, --adaptive-degree, --batch, --workspace, --cache, --hash-buckets, --max-neighbors, --sampling-seed]\n";
         return 0;
     }
-    std::filesystem::path inputDirName, inputFileName, outputFileName;
+    std::filesystem::path inputDirName, outputFileName, featuresFileName, kernelFileName, updatesFileName, modelFileName;
     std::filesystem::directory_entry inputDir;
-    unsigned degree, dimensions, epochs, negSamples;
-    double alpha;
-    bool cleaning;
+    Graph2Vec::Parameters parameters;
+    ProductQuantizer::Parameters pqParameters;
+    bool cleaning, quantizing;
+    LabelTable labels; // String labels of graphs read here, not by the model
+    LabelTable * readLabels = argPos("--string-labels", argc, argv) != argc ? &labels : nullptr;
     int pos = argPos("--dataset", argc, argv);
     if (pos == argc)
     {
@@ -50,215 +82,357 @@ int main(int argc, char ** argv)
         return EXIT_FAILURE;
     }
     inputDirName = std::filesystem::path(argv[pos + 1]);
+    inputDir = std::filesystem::directory_entry(inputDirName);
+    if (! inputDir.exists())
+    {
+        std::cerr << "Input dataset doesn't exist.\n";
+        return EXIT_FAILURE;
+    }
+    pos = argPos("--convert", argc, argv);
+    if (pos != argc)
+    {
+        // Only the dataset is written in another format
+        std::filesystem::path convertedFileName(argv[pos + 1]);
+        std::vector<Graph> graphs;
+        if (! readGraphs(inputDirName, graphs, readLabels))
+            return EXIT_FAILURE;
+        if (convertedFileName.extension() == ".jsonl")
+            return writeGraphsJSONL(convertedFileName, graphs, readLabels) ? 0 : EXIT_FAILURE;
+        return writeGraphsBinary(convertedFileName, graphs) ? 0 : EXIT_FAILURE;
+    }
+    // WL features and kernel are written from extracted subgraphs instead of embeddings
+    pos = argPos("--wl-features", argc, argv);
+    if (pos != argc)
+        featuresFileName = std::filesystem::path(argv[pos + 1]);
+    pos = argPos("--wl-kernel", argc, argv);
+    if (pos != argc)
+        kernelFileName = std::filesystem::path(argv[pos + 1]);
+    bool extracting = ! featuresFileName.empty() || ! kernelFileName.empty();
     pos = argPos("--output", argc, argv);
-    if (pos == argc)
+    if (pos == argc && ! extracting)
     {
         std::cerr << "Lack of output file.\n";
         return EXIT_FAILURE;
     }
-    std::string fileName;
-    if (argv[pos + 1][0] == '/')
-        fileName = "";
-    else
-        fileName = "./";
-    fileName.append(argv[pos + 1]);
-    outputFileName = std::filesystem::path(fileName);
+    if (pos != argc)
+    {
+        std::string fileName;
+        if (argv[pos + 1][0] == '/')
+            fileName = "";
+        else
+            fileName = "./";
+        fileName.append(argv[pos + 1]);
+        outputFileName = std::filesystem::path(fileName);
+    }
     pos = argPos("--deg", argc, argv);
     if (pos == argc)
-        degree = 10;
+        parameters.degree = 10;
     else
-        degree = (unsigned) std::atoi(argv[pos + 1]);
+        parameters.degree = (unsigned) std::atoi(argv[pos + 1]);
     pos = argPos("--dim", argc, argv);
     if (pos == argc)
-        dimensions = 10;
+        parameters.dimensions = 10;
     else
-        dimensions = (unsigned) std::atoi(argv[pos + 1]);
+        parameters.dimensions = (unsigned) std::atoi(argv[pos + 1]);
     pos = argPos("--ep", argc, argv);
     if (pos == argc)
-        epochs = 3;
+        parameters.epochs = 3;
     else
-        epochs = (unsigned) std::atoi(argv[pos + 1]);
+        parameters.epochs = (unsigned) std::atoi(argv[pos + 1]);
     pos = argPos("--alpha", argc, argv);
     if (pos == argc)
-        alpha = 0.025;
+        parameters.alpha = 0.025;
     else
-        alpha = std::atof(argv[pos + 1]);
+        parameters.alpha = std::atof(argv[pos + 1]);
     pos = argPos("--neg", argc, argv);
     if (pos == argc)
-        negSamples = 20;
+        parameters.negSamples = 20;
     else
     {
-        negSamples = (unsigned) std::atoi(argv[pos + 1]);
-        if (negSamples <= 1)
+        parameters.negSamples = (unsigned) std::atoi(argv[pos + 1]);
+        if (parameters.negSamples <= 1)
         {
             std::cerr << "Too few negative samples (at least 2).\n";
             return EXIT_FAILURE;
         }
     }
-    pos = argPos("--clean", argc, argv);
-    if (pos == argc)
-        cleaning = false;
-    else
-        cleaning = true;
-    inputDir = std::filesystem::directory_entry(inputDirName);
-    if (! inputDir.exists())
+    parameters.adaptiveDegree = argPos("--adaptive-degree", argc, argv) != argc;
+    pos = argPos("--batch", argc, argv);
+    if (pos != argc)
+        parameters.batchSize = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--update-batch", argc, argv);
+    if (pos != argc)
+        parameters.updateBatch = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--threads", argc, argv);
+    if (pos != argc)
+        parameters.threads = (unsigned) std::atoi(argv[pos + 1]);
+    parameters.numa = argPos("--numa", argc, argv) != argc;
+    parameters.deduplicate = argPos("--dedup", argc, argv) != argc;
+    pos = argPos("--fine-tune", argc, argv);
+    if (pos != argc)
+        parameters.fineTuneEpochs = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--workspace", argc, argv);
+    if (pos != argc)
+        parameters.workspace = std::filesystem::path(argv[pos + 1]);
+    pos = argPos("--cache", argc, argv);
+    if (pos != argc)
+        parameters.cache = std::filesystem::path(argv[pos + 1]);
+    pos = argPos("--hash-buckets", argc, argv);
+    if (pos != argc)
+        parameters.hashBuckets = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--max-neighbors", argc, argv);
+    if (pos != argc)
+        parameters.sampling.maxNeighbors = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--sampling-seed", argc, argv);
+    if (pos != argc)
+        parameters.sampling.seed = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--pipeline", argc, argv);
+    if (pos != argc)
+        parameters.queueCapacity = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--exp", argc, argv);
+    if (pos != argc && ! parseExpMethod(parameters.expMethod, argv[pos + 1]))
+    {
+        std::cerr << "Unknown method of exp " << argv[pos + 1] << " (exact, table or polynomial).\n";
+        return EXIT_FAILURE;
+    }
+    pos = argPos("--objective", argc, argv);
+    if (pos != argc && ! parseWord2VecObjective(parameters.objective, argv[pos + 1]))
     {
-        std::cerr << "Input directory doesn't exist.\n";
+        std::cerr << "Unknown objective of word2vec " << argv[pos + 1] << " (softmax or hs).\n";
         return EXIT_FAILURE;
     }
-    if (inputDir.exists() && ! inputDir.is_directory())
+    pos = argPos("--reorder", argc, argv);
+    if (pos != argc && ! parseVertexOrder(parameters.vertexOrder, argv[pos + 1]))
     {
-        std::cerr << "Input source is not a directory.\n";
+        std::cerr << "Unknown order of vertices " << argv[pos + 1] << " (original, degree, bfs or rcm).\n";
         return EXIT_FAILURE;
     }
-    std::vector<Graph> graphsVector; // Vector of the graphs to be embedded
-    readGraphs(inputDir, graphsVector);
-    std::vector<std::vector<double>> graphsEmbeddings; // Matrix of embeddings
-    std::random_device dev;
-    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
-    // Initialization of embeddings matrix by random real values
-    for (unsigned i = 0; i < graphsVector.size(); i++)
+    parameters.stringLabels = readLabels != nullptr;
+    pos = argPos("--updates", argc, argv);
+    if (pos != argc)
     {
-        graphsEmbeddings.push_back(std::vector<double>());
-        for (unsigned j = 0; j < dimensions; j++)
+        updatesFileName = std::filesystem::path(argv[pos + 1]);
+        parameters.dynamicGraphs = true;
+        // Updates are of the vertices of the dataset, fitted as read and all at once
+        if (parameters.vertexOrder != originalOrder || parameters.queueCapacity > 0)
         {
-            graphsEmbeddings[i].push_back(unidist(dev));
+            std::cerr << "Updates cannot be applied with --reorder or --pipeline.\n";
+            return EXIT_FAILURE;
         }
     }
-    // Creating temporal JSON files names
-    std::vector<std::string> mapName;
-    for (unsigned i = 0; i < graphsVector.size(); i++)
-        mapName.push_back(std::string("map").append(std::to_string(i)).append(".json"));
-    // Now we call function, which extracts rooted subgraphs and assigns to them ID
-    bool mapsExist = true;
-    for (unsigned i = 0; i < graphsVector.size(); i++)
+    pos = argPos("--refresh-epochs", argc, argv);
+    if (pos != argc)
+        parameters.refreshEpochs = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--model", argc, argv);
+    if (pos != argc)
+        modelFileName = std::filesystem::path(argv[pos + 1]);
+    bool appending = argPos("--append", argc, argv) != argc;
+    if (appending && modelFileName.empty())
+    {
+        std::cerr << "Lack of model file to append to.\n";
+        return EXIT_FAILURE;
+    }
+    pos = argPos("--append-epochs", argc, argv);
+    if (pos != argc)
+        parameters.appendEpochs = (unsigned) std::atoi(argv[pos + 1]);
+    pos = argPos("--append-samples", argc, argv);
+    if (pos != argc)
+        parameters.appendSamples = (unsigned) std::atoi(argv[pos + 1]);
+    // Segment is created by the first checkpoint or the final publication, of the shape of the embeddings
+    std::string sharedName;
+    SharedEmbeddingsWriter sharedWriter;
+    pos = argPos("--shm", argc, argv);
+    if (pos != argc)
+    {
+        sharedName = argv[pos + 1];
+        if (sharedName[0] != '/')
+            sharedName.insert(0, "/");
+    }
+    if (! sharedName.empty() && argPos("--shm-checkpoint", argc, argv) != argc)
     {
-        if (! std::filesystem::directory_entry(std::filesystem::path(mapName[i])).exists())
+        parameters.checkpoint = [&](const std::vector<std::vector<double>> & embeddings, unsigned)
         {
-            mapsExist = false;
-            break;
-        }
+            if (sharedWriter.getRows() != embeddings.size() && ! sharedWriter.open(sharedName, embeddings.size(), embeddings[0].size()))
+                return;
+            sharedWriter.publish(embeddings);
+        };
     }
-    if (! mapsExist)
+    pos = argPos("--clean", argc, argv);
+    if (pos == argc)
+        cleaning = false;
+    else
+        cleaning = true;
+    pos = argPos("--pq", argc, argv);
+    if (pos == argc)
+        quantizing = false;
+    else
     {
-        for (unsigned i = 0; i < graphsVector.size(); i++)
+        quantizing = true;
+        pqParameters.subspaces = (unsigned) std::atoi(argv[pos + 1]);
+    }
+    pos = argPos("--pq-centroids", argc, argv);
+    if (pos != argc)
+        pqParameters.centroids = (unsigned) std::atoi(argv[pos + 1]);
+    parameters.verbose = true;
+    parameters.perfCounters = argPos("--perf-counters", argc, argv) != argc;
+    pos = argPos("--sweep", argc, argv);
+    if (pos != argc && ! extracting)
+    {
+        // Graphs are extracted and their context made once for all configurations of the grid
+        std::vector<Graph2Vec::Parameters> grid;
+        if (! parseSweepGrid(grid, argv[pos + 1], parameters))
+            return EXIT_FAILURE;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        pos = argPos("--sweep-threads", argc, argv);
+        if (pos != argc)
+            threads = (unsigned) std::atoi(argv[pos + 1]);
+        std::vector<Graph> graphs;
+        if (! readGraphs(inputDirName, graphs, readLabels))
+            return EXIT_FAILURE;
+        std::vector<Graph2Vec> models;
+        SweepMetrics sweepMetrics;
+        std::cout << graphs.size() << " graphs read, " << grid.size() << " configurations" << std::endl;
+        if (! sweepParameters(models, sweepMetrics, graphs, grid, threads, readLabels))
+            return EXIT_FAILURE;
+        for (unsigned i = 0; i < models.size(); i++)
         {
-            Json::Value JSONmap;
-            std::fstream JSONfile;
-            std::cout << "Graph no " << i << "\n";
-            JSONfile.open(mapName[i], std::ios::out);
-            JSONfile << "{\n}\n";
-            JSONfile.close();
-            for (unsigned j = 0; j < graphsVector[i].getMaxVertex(); j++)
-            {
-                if (graphsVector[i].getVertex(j) != nullptr)
-                {
-                    for (unsigned k = 0; k <= degree; k++)
-                    {
-                        JSONfile.open(mapName[i], std::ios::in);
-                        JSONfile >> JSONmap;
-                        JSONfile.close();
-                        getWLSubgraph(JSONmap, graphsVector[i], graphsVector[i].getVertex(j), i, j, k, dimensions);
-                        JSONfile.open(mapName[i], std::ios::out);
-                        JSONfile << JSONmap;
-                        JSONfile.close();
-                        JSONmap.clear();
-                    }
-                }
-            }
+            if (! writeEmbeddings(getSweepOutputPath(outputFileName, models[i].getParameters()), models[i].getGraphsEmbeddings()))
+                return EXIT_FAILURE;
         }
+        std::filesystem::path summaryFileName = outputFileName;
+        summaryFileName.replace_filename(outputFileName.stem().string() + ".sweep.tsv");
+        std::ofstream summaryFile(summaryFileName);
+        writeSweepSummary(summaryFile, models, sweepMetrics);
+        writeSweepSummary(std::cout, models, sweepMetrics);
+        return summaryFile.good() ? 0 : EXIT_FAILURE;
     }
-    RadialContext subgraphContext; // Look to the SubgraphMaps.hpp
-    // Now radial context of every rooted subgraph is being set, like in subgraph2vec algorithm
-    radialSkipGram(subgraphContext, mapName, graphsVector, degree);
-    // Now we call word2vec algorithm in order to make vector representations of rooted subgraphs
-    for (unsigned i = 0; i < graphsVector.size(); i++)
+    Graph2Vec model(parameters);
+    if (extracting)
     {
-        std::ifstream JSONfileIn(mapName[i]);
-        Json::Value JSONmap;
-        JSONfileIn >> JSONmap;
-        JSONfileIn.close();
-        std::cout << "word2vec for subgraphs of Graph no " << i << std::endl;
-        // Here the minimal subgraph ID for every graph in dataset is chosen. We want that
-        // because subgraph IDs are unique for every subgraph in the vocabulary
-        // (for all graphs in dataset), but in word2vec we need to assign word IDs from 0
-        unsigned minID = JSONmap["rootVertices"][0]["degrees"][0]["subgraphID"].asUInt();
-        for (unsigned j = 0; j < graphsVector[i].getMaxVertex(); j++)
+        if (! model.extract(inputDirName))
+            return EXIT_FAILURE;
+        SubgraphCounts counts;
+        getSubgraphCounts(counts, model.getSubgraphMaps(), model.getSubgraphsEmbeddings().size());
+        std::cout << model.getSubgraphMaps().size() << " graphs, " << counts.columns << " subgraphs, " << counts.subgraphs.size() << " nonzero counts" << std::endl;
+        if (! featuresFileName.empty() && ! writeLibSVM(featuresFileName, counts))
+            return EXIT_FAILURE;
+        bool normalized = argPos("--wl-normalize", argc, argv) != argc;
+        if (! kernelFileName.empty() && ! writeKernelMatrix(kernelFileName, counts, normalized, std::max(1u, std::thread::hardware_concurrency())))
+            return EXIT_FAILURE;
+        if (cleaning)
+            model.cleanWorkspace();
+        return 0;
+    }
+    if (appending)
+    {
+        // Parameters of the model replace the ones given, except the options of this run
+        if (! model.load(modelFileName) || ! model.append(inputDirName))
+            return EXIT_FAILURE;
+    }
+    else if (updatesFileName.empty())
+    {
+        if (! model.fit(inputDirName))
+            return EXIT_FAILURE;
+    }
+    else
+    {
+        // Graphs are kept for the updates, which are applied to them and to the model
+        std::vector<Graph> graphs;
+        if (! readGraphs(inputDirName, graphs, readLabels))
+            return EXIT_FAILURE;
+        // Labels are known to the model before fit, the cache hashes them by their strings
+        model.setLabelTable(labels);
+        if (! model.fit(graphs))
+            return EXIT_FAILURE;
+        bool updated = streamGraphUpdates(updatesFileName, [&](unsigned graphNumber, const std::vector<GraphUpdate> & updates)
         {
-            for (unsigned k = 0; k <= degree; k++)
+            if (graphNumber >= graphs.size())
             {
-                if (JSONmap["rootVertices"][j]["degrees"][k]["subgraphID"].asUInt() < minID)
-                {
-                    minID = JSONmap["rootVertices"][j]["degrees"][k]["subgraphID"].asUInt();
-                }
+                std::cerr << "Graph " << graphNumber << " of updates doesn't exist.\n";
+                return true;
             }
+            model.update(graphNumber, graphs[graphNumber], updates);
+            return true;
+        }, readLabels);
+        if (! updated)
+            return EXIT_FAILURE;
+        model.setLabelTable(labels);
+        const Graph2Vec::Metrics & metrics = model.getMetrics();
+        std::cout << "Applied " << metrics.appliedUpdates << " updates, relabeled " << metrics.relabeledSubgraphs << " rooted subgraphs in ";
+        std::cout << metrics.updateTime << " s" << std::endl;
+    }
+    if (! modelFileName.empty() && ! model.save(modelFileName))
+        return EXIT_FAILURE;
+    const std::vector<std::vector<double>> & graphsEmbeddings = model.getGraphsEmbeddings(); // Matrix of embeddings
+    if (! writeEmbeddings(outputFileName, graphsEmbeddings))
+        return EXIT_FAILURE;
+    if (! sharedName.empty())
+    {
+        // Segment stays after exit for its readers, until it's replaced or removed from /dev/shm
+        unsigned dimensions = model.getParameters().dimensions;
+        if (sharedWriter.getRows() != graphsEmbeddings.size() || sharedWriter.getDimensions() != dimensions)
+        {
+            if (! sharedWriter.open(sharedName, graphsEmbeddings.size(), dimensions))
+                return EXIT_FAILURE;
         }
-        word2vec(JSONmap, subgraphContext, graphsVector[i], degree, dimensions, epochs, alpha, minID);
-        std::ofstream JSONfileOut(mapName[i]);
-        JSONfileOut << JSONmap;
-        JSONmap.clear();
-        JSONfileOut.close();
+        if (! sharedWriter.publish(graphsEmbeddings))
+            return EXIT_FAILURE;
+        std::cout << "Graphs embeddings published to shared memory " << sharedName << ", generation " << sharedWriter.getGeneration() << std::endl;
     }
-    // Main loop of the algorithm
-    for (unsigned e = 0; e < epochs; e++)
+    if (quantizing)
     {
-        std::cout << "Epoch number " << e << std::endl;
-        // Shuffle dataset graphs
-        std::vector<unsigned> indexes = getRandomIndexes(graphsVector.size());
-        for (unsigned i = 0; i < graphsVector.size(); i++)
+        std::mt19937 generator(std::random_device{}());
+        const std::vector<std::vector<double>> * matrices[2] = {&graphsEmbeddings, &model.getSubgraphsEmbeddings()};
+        const char * names[2] = {"graphs", "subgraphs"};
+        for (unsigned i = 0; i < 2; i++)
         {
-            std::ifstream JSONfile(mapName[indexes[i]]);
-            Json::Value JSONmap;
-            JSONfile >> JSONmap;
-            // Choosing negative samples for negative skipgram
-            std::vector<std::vector<double>> negSamplesVector = negativeSampling(negSamples, indexes[i], graphsVector, degree, mapName, dimensions);
-            for (unsigned j = 0; j < graphsVector[indexes[i]].getMaxVertex(); j++)
-            {
-                if (graphsVector[indexes[i]].getVertex(j) != nullptr)
-                {
-                    for (unsigned k = 0; k <= degree; k++)
-                    {
-                        // Training graph embeddings
-                        std::vector<double> temp;
-                        for (unsigned l = 0; l < dimensions; l++)
-                        {
-                            temp.push_back(JSONmap["rootVertices"][j]["degrees"][k]["subgraphEmbedding"][l].asDouble());
-                        }
-                        updateGraphsEmbeddings(graphsEmbeddings, indexes[i], temp, negSamplesVector, alpha);
-                    }
-                }
-            }
-            JSONfile.close();
+            ProductQuantizer quantizer(pqParameters);
+            if (! quantizer.fit(*matrices[i], generator) || ! quantizer.save(outputFileName.string() + "." + names[i] + ".pq"))
+                return EXIT_FAILURE;
+            std::cout << "Product quantized " << names[i] << " embeddings: compression ratio " << quantizer.getCompressionRatio();
+            std::cout << ", relative reconstruction error " << quantizer.getReconstructionError(*matrices[i]) << std::endl;
         }
     }
+    if (cleaning)
+        model.cleanWorkspace();
+    return 0;
+}
+
+// Writing embeddings to the file
+bool writeEmbeddings(const std::filesystem::path & outputFileName, const std::vector<std::vector<double>> & graphsEmbeddings)
+{
     std::filesystem::directory_entry outputDir(outputFileName.parent_path());
     if (! outputDir.exists())
         std::filesystem::create_directories(outputFileName.parent_path());
     std::ofstream outputFile(outputFileName);
-    // Writing embeddings to the file
-    for (unsigned i = 0; i < graphsVector.size(); i++)
+    if (! outputFile.is_open())
+    {
+        std::cerr << "Cannot open " << outputFileName << ".\n";
+        return false;
+    }
+    for (unsigned i = 0; i < graphsEmbeddings.size(); i++)
     {
         outputFile << "Graph no " << i << std::endl;
-        for (unsigned j = 0; j < dimensions; j++)
+        for (unsigned j = 0; j < graphsEmbeddings[i].size(); j++)
         {
             outputFile << "\tx_" << j + 1 << ": " << graphsEmbeddings[i][j] << std::endl;
         }
     }
     outputFile.close();
-    if (cleaning)
+    if (! outputFile.good())
     {
-        for (unsigned i = 0; i < graphsVector.size(); i++)
-        {
-            std::filesystem::remove(std::filesystem::path(mapName[i]));
-        }
+        std::cerr << "Cannot write embeddings to " << outputFileName << ".\n";
+        return false;
     }
-    return 0;
+    return true;
 }
 
 int argPos(const char * s, int argc, char ** argv)
 {
     int pos;
-    if (std::strcmp("--clean", s) == 0)
+    if (std::strcmp("--clean", s) == 0 || std::strcmp("--wl-normalize", s) == 0 || std::strcmp("--adaptive-degree", s) == 0 || std::strcmp("--dedup", s) == 0
+        || std::strcmp("--append", s) == 0 || std::strcmp("--shm-checkpoint", s) == 0 || std::strcmp("--string-labels", s) == 0
+        || std::strcmp("--numa", s) == 0 || std::strcmp("--perf-counters", s) == 0)
     {
         for (pos = 1; pos < argc; pos++)
         {
@@ -285,139 +459,3 @@ int argPos(const char * s, int argc, char ** argv)
     }
     return pos;
 }
-
-void readGraphs(std::filesystem::directory_entry & dir, std::vector<Graph> & graphs)
-{
-    std::vector<unsigned> ft;
-    std::set<std::pair<unsigned, unsigned>> edgesSet;
-    std::filesystem::directory_iterator dir_it(dir.path());
-    std::filesystem::path inputFileName;
-    std::ifstream inputFile;
-    unsigned graphNumber;
-    Json::Value sourceJSON;
-    for (dir_it = begin(dir_it); dir_it != end(dir_it); dir_it++)
-    {
-        inputFileName = dir_it->path();
-        inputFile.open(inputFileName);
-        inputFile >> sourceJSON;
-        inputFile.close();
-        for (unsigned i = 0; i < sourceJSON["features"].size(); i++)
-            ft.push_back(std::stoi(sourceJSON["features"][std::to_string(i)].asString()));
-        for (unsigned i = 0; i < sourceJSON["edges"].size(); i++)
-        {
-            std::pair<unsigned, unsigned> temp;
-            temp.first = sourceJSON["edges"][i][0].asUInt();
-            temp.second = sourceJSON["edges"][i][1].asUInt();
-            edgesSet.insert(temp);
-        }
-        sourceJSON.clear();
-        graphNumber = (unsigned) std::stoi(inputFileName.stem().string());
-        if (graphNumber >= graphs.size())
-        {
-            graphs.resize(graphNumber);
-            Graph * g = new Graph;
-            graphs.push_back(*g);
-            delete g;
-        }
-        for (unsigned i = 0; i < ft.size(); i++)
-            graphs[graphNumber].addVertex(i, ft[i]);
-        for (std::set<std::pair<unsigned, unsigned>>::iterator i = edgesSet.cbegin(); i != edgesSet.cend(); i++)
-            graphs[graphNumber].addEdge((*i).first, (*i).second);
-        ft.clear();
-        edgesSet.clear();
-    }
-}
-
-std::vector<unsigned> getRandomIndexes(unsigned size)
-{
-    std::random_device dev;
-    std::uniform_int_distribution<unsigned> unidist(0, size - 1);
-    std::set<unsigned> indexes_used;
-    std::vector<unsigned> indexes;
-    for (unsigned i = 0; i < size; i++)
-    {
-        unsigned temp;
-        do
-            temp = unidist(dev);
-        while (indexes_used.count(temp) == 1);
-        indexes_used.insert(temp);
-        indexes.push_back(temp);
-    }
-    return indexes;
-}
-
-std::vector<std::vector<double>> negativeSampling(unsigned samples, unsigned graphIndex, const std::vector<Graph> & graphs, unsigned degree, const std::vector<std::string> & subgraphs,
-                                                  unsigned dimensions)
-{
-    std::random_device dev;
-    std::uniform_int_distribution<unsigned> unidist1(0, graphs.size() - 1);
-    std::uniform_int_distribution<unsigned> unidist3(0, degree);
-    std::vector<std::vector<double>> result;
-    std::set<unsigned> subgraphs_used;
-    for (unsigned i = 0; i < samples; i++)
-    {
-        Json::Value JSONmap;
-        std::ifstream JSONfile;
-        unsigned tempGraph, tempVertex, tempDegree;
-        do
-        {
-            do
-                tempGraph = unidist1(dev);
-            while (tempGraph == graphIndex);
-            std::uniform_int_distribution<unsigned> unidist2(0, graphs[tempGraph].getMaxVertex() - 1);
-            tempVertex = unidist2(dev);
-            tempDegree = unidist3(dev);
-            JSONmap.clear();
-            JSONfile.open(subgraphs[tempGraph]);
-            JSONfile >> JSONmap;
-            JSONfile.close();
-        }
-        while (subgraphs_used.count(JSONmap["rootVertices"][tempVertex]["degrees"][tempDegree]["subgraphID"].asUInt()) == 1);
-        subgraphs_used.insert(JSONmap["rootVertices"][tempVertex]["degrees"][tempDegree]["subgraphID"].asUInt());
-        std::vector<double> resultPart;
-        for (unsigned j = 0; j < dimensions; j++)
-            resultPart.push_back(JSONmap["rootVertices"][tempVertex]["degrees"][tempDegree]["subgraphEmbedding"][j].asDouble());
-        result.push_back(resultPart);
-    }
-    return result;
-}
-
-void updateGraphsEmbeddings(std::vector<std::vector<double>> & embeddings, unsigned graphIndex, const std::vector<double> & subgraph,
-                            const std::vector<std::vector<double>> & negSamples, double alpha)
-{
-    // Here we calculate scalar by matrix (graph embeddings) derivative, as described
-    // in graph2vec paper
-    std::vector<double> sums1;
-    for (unsigned i = 0; i < negSamples.size(); i++)
-        sums1.push_back(0.0L);
-    for (unsigned i = 0; i < negSamples.size(); i++)
-    {
-        for (unsigned j = 0; j < embeddings[0].size(); j++)
-        {
-            sums1[i] += embeddings[graphIndex][j] * negSamples[i][j];
-        }
-    }
-    double maxSum = sums1[0];
-    for (unsigned i = 1; i < negSamples.size(); i++)
-    {
-        if (maxSum < sums1[i])
-        {
-            maxSum = sums1[i];
-        }
-    }
-    for (unsigned i = 0; i < embeddings[0].size(); i++)
-    {
-        double sum2 = 0.0L, sum3 = 0.0L;
-        for (unsigned j = 0; j < negSamples.size(); j++)
-        {
-            double ex;
-            if (sums1[j] - maxSum < -7.0L)
-                ex = 0.0L;
-            else
-                ex = std::exp(sums1[j] - maxSum);
-            sum2 += ex;
-            sum3 += ex * negSamples[j][i];
-        }
-        embeddings[graphIndex][i] -= alpha * (sum3 / sum2 - subgraph[i]);
-    }
-}
@@ -0,0 +1,93 @@
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <filesystem>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include "Numa.hpp"
+
+bool parseCPUList(const std::string &, std::vector<unsigned> &);
+
+// False if the topology isn't known (not Linux or no sysfs), a machine without NUMA has one node
+bool getNumaTopology(NumaTopology & topology)
+{
+    topology = NumaTopology();
+    const std::filesystem::path nodesDir("/sys/devices/system/node");
+    std::ifstream onlineFile(nodesDir / "online");
+    std::string line;
+    std::vector<unsigned> online;
+    if (! std::getline(onlineFile, line) || ! parseCPUList(line, online))
+        return false;
+    for (unsigned i = 0; i < online.size(); i++)
+    {
+        std::ifstream cpuFile(nodesDir / ("node" + std::to_string(online[i])) / "cpulist");
+        std::vector<unsigned> cpus;
+        if (! std::getline(cpuFile, line))
+            return false;
+        if (! parseCPUList(line, cpus))
+            return false;
+        if (cpus.empty())
+            continue;
+        topology.nodes.push_back(online[i]);
+        topology.cpus.push_back(cpus);
+    }
+    return ! topology.nodes.empty();
+}
+
+// Restrict the calling thread to the CPUs, so that pages it touches first are allocated on their node
+bool pinThread(const std::vector<unsigned> & cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned i = 0; i < cpus.size(); i++)
+    {
+        if (cpus[i] < CPU_SETSIZE)
+            CPU_SET(cpus[i], &set);
+    }
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+// Index of the node of every thread, threads are split into contiguous groups of about equal size,
+// so that threads of neighbouring shares of work share their node
+std::vector<unsigned> getThreadNodes(unsigned threads, unsigned nodes)
+{
+    std::vector<unsigned> threadNodes(threads);
+    for (unsigned t = 0; t < threads; t++)
+        threadNodes[t] = (unsigned long long) t * nodes / threads;
+    return threadNodes;
+}
+
+// List of numbers and ranges, as "0-3,8,10-11" (empty list for an empty line)
+bool parseCPUList(const std::string & line, std::vector<unsigned> & numbers)
+{
+    numbers.clear();
+    std::istringstream stream(line);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty())
+            continue;
+        char * end;
+        unsigned long first = std::strtoul(range.c_str(), &end, 10), last = first;
+        if (end == range.c_str())
+            return false;
+        if (*end == '-')
+        {
+            const char * second = end + 1;
+            last = std::strtoul(second, &end, 10);
+            if (end == second || last < first)
+                return false;
+        }
+        if (*end != '\0')
+            return false;
+        for (unsigned long n = first; n <= last; n++)
+            numbers.push_back(n);
+    }
+    return true;
+}
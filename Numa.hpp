@@ -0,0 +1,20 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <vector>
+
+// NUMA nodes of the machine with CPUs (memory-only nodes are left out) and the CPUs of every node,
+// read from /sys/devices/system/node on Linux
+struct NumaTopology
+{
+    std::vector<unsigned> nodes;
+    std::vector<std::vector<unsigned>> cpus; // CPUs of every node of nodes
+};
+
+bool getNumaTopology(NumaTopology &);
+
+bool pinThread(const std::vector<unsigned> &);
+
+std::vector<unsigned> getThreadNodes(unsigned, unsigned);
+
+#endif
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include "ParameterSweep.hpp"
+#include "SubgraphExtract.hpp"
+#include "WLKernel.hpp"
+#include "Kernels.hpp"
+
+bool setSweepParameter(Graph2Vec::Parameters &, const std::string &, const std::string &);
+
+// Grid of training parameters "<name>=<value>,<value>;<name>=..." of names dim, alpha, neg, ep and
+// update-batch (as the options). Grid is every combination of the values, other parameters are the base
+bool parseSweepGrid(std::vector<Graph2Vec::Parameters> & grid, const char * spec, const Graph2Vec::Parameters & base)
+{
+    grid.assign(1, base);
+    std::istringstream stream(spec);
+    std::string axis, value;
+    while (std::getline(stream, axis, ';'))
+    {
+        if (axis.empty())
+            continue;
+        std::size_t equals = axis.find('=');
+        if (equals == std::string::npos || equals + 1 == axis.size())
+        {
+            std::cerr << "Invalid axis " << axis << " of the sweep grid.\n";
+            return false;
+        }
+        std::string name = axis.substr(0, equals);
+        std::istringstream values(axis.substr(equals + 1));
+        std::vector<Graph2Vec::Parameters> expanded;
+        while (std::getline(values, value, ','))
+        {
+            for (unsigned i = 0; i < grid.size(); i++)
+            {
+                expanded.push_back(grid[i]);
+                if (! setSweepParameter(expanded.back(), name, value))
+                {
+                    std::cerr << "Invalid value " << value << " of " << name << " of the sweep grid (dim, alpha, neg, ep or update-batch).\n";
+                    return false;
+                }
+            }
+        }
+        grid = expanded;
+    }
+    return true;
+}
+
+// Name of the configuration in output files and the summary, of the parameters of the grid
+std::string getSweepName(const Graph2Vec::Parameters & parameters)
+{
+    std::ostringstream name;
+    name << "dim" << parameters.dimensions << "_alpha" << parameters.alpha << "_neg" << parameters.negSamples << "_ep" << parameters.epochs;
+    if (parameters.updateBatch > 0)
+        name << "_batch" << parameters.updateBatch;
+    return name.str();
+}
+
+// <output stem>.<name of the configuration><output extension>
+std::filesystem::path getSweepOutputPath(const std::filesystem::path & output, const Graph2Vec::Parameters & parameters)
+{
+    std::filesystem::path path = output;
+    std::string extension = output.extension().string();
+    return path.replace_filename(output.stem().string() + "." + getSweepName(parameters) + extension);
+}
+
+// Fit a model of every configuration of the grid. Graphs are extracted and their radial context made
+// once (as by fit, by parameters of extraction of the first configuration), then configurations are
+// trained by the threads at once, every thread takes the next one. Extraction and context are only
+// read by them. Configurations don't write workspace and aren't verbose. Labels of the graphs read as
+// strings are kept by every model
+bool sweepParameters(std::vector<Graph2Vec> & models, SweepMetrics & metrics, const std::vector<Graph> & graphs,
+                     const std::vector<Graph2Vec::Parameters> & grid, unsigned threads, const LabelTable * labels)
+{
+    if (grid.empty())
+        return false;
+    metrics = SweepMetrics();
+    const Graph2Vec::Parameters & extraction = grid[0];
+    Graph2Vec extractor(extraction);
+    if (labels != nullptr)
+        extractor.setLabelTable(*labels);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    extractor.extract(graphs);
+    metrics.extractionTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // Duplicate graphs add nothing to the context, as in fit
+    start = std::chrono::steady_clock::now();
+    const std::vector<SubgraphMap> & maps = extractor.getSubgraphMaps();
+    std::vector<unsigned> representatives;
+    if (extraction.deduplicate)
+        groupEquivalentGraphs(representatives, maps, extraction.degree);
+    std::mt19937 generator(std::random_device{}());
+    RadialContext context;
+    for (unsigned i = 0; i < graphs.size(); i++)
+    {
+        if (representatives.empty() || representatives[i] == i)
+            radialSkipGramGraph(context, maps[i], graphs[i], extraction.degree, extraction.sampling, generator);
+    }
+    metrics.contextTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    models.clear();
+    for (unsigned i = 0; i < grid.size(); i++)
+    {
+        Graph2Vec::Parameters parameters = grid[i];
+        parameters.workspace.clear();
+        parameters.dynamicGraphs = false;
+        parameters.checkpoint = nullptr;
+        parameters.verbose = false;
+        models.emplace_back(parameters);
+    }
+    metrics.threads = std::max(1u, std::min<unsigned>(threads, grid.size()));
+    start = std::chrono::steady_clock::now();
+    std::atomic<unsigned> next(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < metrics.threads; t++)
+    {
+        workers.emplace_back([&]()
+        {
+            for (unsigned i = next++; i < models.size(); i = next++)
+            {
+                if (! models[i].fit(extractor, context))
+                    failed = true;
+            }
+        });
+    }
+    for (unsigned t = 0; t < workers.size(); t++)
+        workers[t].join();
+    metrics.trainingTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ! failed;
+}
+
+// Tab separated table of the configurations with time of their stages, after a comment line of the
+// shared stages
+void writeSweepSummary(std::ostream & output, const std::vector<Graph2Vec> & models, const SweepMetrics & metrics)
+{
+    output << "# extraction " << metrics.extractionTime << " s, context " << metrics.contextTime << " s, " << models.size() << " configurations trained in ";
+    output << metrics.trainingTime << " s by " << metrics.threads << " threads\n";
+    output << "configuration\tdimensions\talpha\tnegSamples\tepochs\tupdateBatch\tword2vec [s]\tgraph embeddings [s]\n";
+    for (unsigned i = 0; i < models.size(); i++)
+    {
+        const Graph2Vec::Parameters & parameters = models[i].getParameters();
+        output << getSweepName(parameters) << "\t" << parameters.dimensions << "\t" << parameters.alpha << "\t" << parameters.negSamples << "\t" << parameters.epochs;
+        output << "\t" << parameters.updateBatch << "\t" << models[i].getMetrics().word2vecTime << "\t" << models[i].getMetrics().trainingTime << "\n";
+    }
+}
+
+bool setSweepParameter(Graph2Vec::Parameters & parameters, const std::string & name, const std::string & value)
+{
+    char * end;
+    if (name == "alpha")
+    {
+        parameters.alpha = std::strtod(value.c_str(), &end);
+        return ! value.empty() && *end == '\0' && parameters.alpha > 0;
+    }
+    unsigned long number = std::strtoul(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0')
+        return false;
+    if (name == "dim")
+        parameters.dimensions = number;
+    else if (name == "neg")
+        parameters.negSamples = number;
+    else if (name == "ep")
+        parameters.epochs = number;
+    else if (name == "update-batch")
+        parameters.updateBatch = number;
+    else
+        return false;
+    return (name != "dim" || number > 0) && (name != "neg" || number > 1);
+}
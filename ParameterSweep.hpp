@@ -0,0 +1,31 @@
+#ifndef PARAMETERSWEEP_HPP
+#define PARAMETERSWEEP_HPP
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <filesystem>
+#include "Graph.hpp"
+#include "Graph2Vec.hpp"
+
+// Time of the stages shared by all configurations of a sweep, and wall time of their training
+struct SweepMetrics
+{
+    double extractionTime = 0;
+    double contextTime = 0;
+    double trainingTime = 0;
+    unsigned threads = 0;
+};
+
+bool parseSweepGrid(std::vector<Graph2Vec::Parameters> &, const char *, const Graph2Vec::Parameters &);
+
+std::string getSweepName(const Graph2Vec::Parameters &);
+
+std::filesystem::path getSweepOutputPath(const std::filesystem::path &, const Graph2Vec::Parameters &);
+
+bool sweepParameters(std::vector<Graph2Vec> &, SweepMetrics &, const std::vector<Graph> &, const std::vector<Graph2Vec::Parameters> &, unsigned,
+                     const LabelTable * = nullptr);
+
+void writeSweepSummary(std::ostream &, const std::vector<Graph2Vec> &, const SweepMetrics &);
+
+#endif
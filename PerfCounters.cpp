@@ -0,0 +1,133 @@
+#include <cstring>
+#include <cstdint>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "PerfCounters.hpp"
+
+const char * perfEventNames[] = {"cycles", "instructions", "LLC misses", "branch misses", "dTLB misses", "page faults"};
+
+bool PerfCounts::isCounted() const
+{
+    for (unsigned i = 0; i < perfEventsCount; i++)
+    {
+        if (counts[i] >= 0)
+            return true;
+    }
+    return false;
+}
+
+PerfCounters::PerfCounters()
+{
+}
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+// Open a counter of every event, events which can't be counted are left out. False if none can
+bool PerfCounters::open()
+{
+    close();
+    descriptors.assign(perfEventsCount, -1);
+#ifdef __linux__
+    const std::uint32_t types[perfEventsCount] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE};
+    const std::uint64_t configs[perfEventsCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+                                                    PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                                                    PERF_COUNT_SW_PAGE_FAULTS};
+    bool opened = false;
+    for (unsigned i = 0; i < perfEventsCount; i++)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = types[i];
+        attributes.config = configs[i];
+        attributes.disabled = 1;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        descriptors[i] = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        opened = opened || descriptors[i] >= 0;
+    }
+    return opened;
+#else
+    return false;
+#endif
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+    for (unsigned i = 0; i < descriptors.size(); i++)
+    {
+        if (descriptors[i] < 0)
+            continue;
+        ioctl(descriptors[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// Counts since start, counters are stopped until the next start
+PerfCounts PerfCounters::stop()
+{
+    PerfCounts counts;
+#ifdef __linux__
+    for (unsigned i = 0; i < descriptors.size(); i++)
+    {
+        if (descriptors[i] < 0)
+            continue;
+        ioctl(descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+        // Value, time enabled and time running
+        std::uint64_t values[3];
+        if (read(descriptors[i], values, sizeof(values)) != sizeof(values) || values[2] == 0)
+            continue;
+        counts.counts[i] = values[2] < values[1] ? (long long) ((double) values[0] * values[1] / values[2]) : (long long) values[0];
+    }
+#endif
+    return counts;
+}
+
+void PerfCounters::close()
+{
+#ifdef __linux__
+    for (unsigned i = 0; i < descriptors.size(); i++)
+    {
+        if (descriptors[i] >= 0)
+            ::close(descriptors[i]);
+    }
+#endif
+    descriptors.clear();
+}
+
+const char * getPerfEventName(PerfEvent event)
+{
+    return perfEventNames[event];
+}
+
+// Events counted with instructions per cycle and misses per 1000 instructions, which tell memory bound
+// stages (many misses per instruction, low IPC) from compute bound ones
+void writePerfCounts(std::ostream & output, const PerfCounts & counts)
+{
+    const long long * c = counts.counts;
+    bool first = true;
+    for (unsigned i = 0; i < perfEventsCount; i++)
+    {
+        if (c[i] < 0)
+            continue;
+        output << (first ? "" : ", ") << perfEventNames[i] << " " << c[i];
+        first = false;
+        if (i == instructionsEvent && c[cyclesEvent] > 0)
+            output << " (IPC " << (double) c[i] / c[cyclesEvent] << ")";
+        else if (i != cyclesEvent && i != instructionsEvent && i != pageFaultsEvent && c[instructionsEvent] > 0)
+            output << " (" << 1000.0 * c[i] / c[instructionsEvent] << " per 1000 instructions)";
+    }
+    if (first)
+        output << "not counted";
+}
@@ -0,0 +1,47 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <vector>
+#include <ostream>
+
+enum PerfEvent
+{
+    cyclesEvent,
+    instructionsEvent,
+    cacheMissesEvent, // Misses of the last level cache
+    branchMissesEvent,
+    dtlbMissesEvent, // Read misses of the data TLB
+    pageFaultsEvent, // Software event, counted also without hardware counters (virtual machines)
+    perfEventsCount
+};
+
+// Counts of events of one stage, -1 for an event, which isn't counted (not supported by the
+// processor or the kernel, or not allowed by perf_event_paranoid)
+struct PerfCounts
+{
+    long long counts[perfEventsCount] = {-1, -1, -1, -1, -1, -1};
+    bool isCounted() const;
+};
+
+// Counters of hardware events by perf_event_open (Linux) of the calling thread, and of threads it
+// creates while counting, in user space. Counts of multiplexed counters are scaled by the time they ran
+class PerfCounters
+{
+private:
+    std::vector<int> descriptors;
+public:
+    PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters & operator=(const PerfCounters &) = delete;
+    ~PerfCounters();
+    bool open();
+    void start();
+    PerfCounts stop();
+    void close();
+};
+
+const char * getPerfEventName(PerfEvent);
+
+void writePerfCounts(std::ostream &, const PerfCounts &);
+
+#endif
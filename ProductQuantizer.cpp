@@ -0,0 +1,293 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cstring>
+#include "ProductQuantizer.hpp"
+
+double squaredDistance(const double *, const double *, unsigned);
+
+unsigned getNearestCentroid(const double *, const std::vector<double> &, unsigned, unsigned);
+
+void kMeans(const std::vector<const double *> &, unsigned, std::vector<double> &, unsigned, unsigned, std::mt19937 &);
+
+const char fileMagic[8] = {'G', '2', 'V', 'P', 'Q', '0', '0', '1'};
+
+ProductQuantizer::ProductQuantizer() {}
+
+ProductQuantizer::ProductQuantizer(const Parameters & p) : parameters(p) {}
+
+const ProductQuantizer::Parameters & ProductQuantizer::getParameters() const
+{
+    return parameters;
+}
+
+unsigned ProductQuantizer::getDimensions() const
+{
+    return dimensions;
+}
+
+unsigned ProductQuantizer::getRows() const
+{
+    return rows;
+}
+
+const std::vector<std::uint8_t> & ProductQuantizer::getCodes() const
+{
+    return codes;
+}
+
+// Learn codebooks on a sample of rows of the matrix and encode all its rows
+bool ProductQuantizer::fit(const std::vector<std::vector<double>> & matrix, std::mt19937 & generator)
+{
+    if (matrix.empty() || matrix[0].empty())
+    {
+        std::cerr << "No embeddings to quantize.\n";
+        return false;
+    }
+    if (parameters.subspaces == 0 || parameters.centroids == 0 || parameters.centroids > 256)
+    {
+        std::cerr << "Invalid parameters of product quantization (subspaces > 0, 0 < centroids <= 256).\n";
+        return false;
+    }
+    dimensions = matrix[0].size();
+    rows = matrix.size();
+    parameters.subspaces = std::min(parameters.subspaces, dimensions);
+    std::vector<const double *> sample(rows);
+    for (unsigned i = 0; i < rows; i++)
+        sample[i] = matrix[i].data();
+    if (parameters.sampleSize > 0 && parameters.sampleSize < rows)
+    {
+        std::shuffle(sample.begin(), sample.end(), generator);
+        sample.resize(parameters.sampleSize);
+    }
+    parameters.centroids = std::min(parameters.centroids, (unsigned) sample.size());
+    subspaceOffsets.resize(parameters.subspaces + 1);
+    for (unsigned s = 0; s <= parameters.subspaces; s++)
+        subspaceOffsets[s] = s * dimensions / parameters.subspaces;
+    codebooks.assign(parameters.subspaces, std::vector<double>());
+    std::vector<const double *> points(sample.size());
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+    {
+        for (unsigned i = 0; i < sample.size(); i++)
+            points[i] = sample[i] + subspaceOffsets[s];
+        kMeans(points, subspaceOffsets[s + 1] - subspaceOffsets[s], codebooks[s], parameters.centroids, parameters.iterations, generator);
+    }
+    codes.resize((std::size_t) rows * parameters.subspaces);
+    for (unsigned i = 0; i < rows; i++)
+        encode(matrix[i], codes.data() + (std::size_t) i * parameters.subspaces);
+    return true;
+}
+
+void ProductQuantizer::encode(const std::vector<double> & vector, std::uint8_t * code) const
+{
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+        code[s] = getNearestCentroid(vector.data() + subspaceOffsets[s], codebooks[s], parameters.centroids, subspaceOffsets[s + 1] - subspaceOffsets[s]);
+}
+
+// Approximation of the row made of centroids of its code
+std::vector<double> ProductQuantizer::decode(unsigned row) const
+{
+    std::vector<double> vector(dimensions);
+    const std::uint8_t * code = codes.data() + (std::size_t) row * parameters.subspaces;
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+    {
+        unsigned n = subspaceOffsets[s + 1] - subspaceOffsets[s];
+        std::copy_n(codebooks[s].begin() + code[s] * n, n, vector.begin() + subspaceOffsets[s]);
+    }
+    return vector;
+}
+
+// Squared distances of the subvectors of the query to every centroid: entry s * centroids + c is
+// the distance in subspace s to centroid c. Computed once per query, then every row costs
+// one lookup per subspace
+std::vector<double> ProductQuantizer::getDistanceTable(const std::vector<double> & query) const
+{
+    std::vector<double> table((std::size_t) parameters.subspaces * parameters.centroids);
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+    {
+        unsigned n = subspaceOffsets[s + 1] - subspaceOffsets[s];
+        for (unsigned c = 0; c < parameters.centroids; c++)
+            table[s * parameters.centroids + c] = squaredDistance(query.data() + subspaceOffsets[s], codebooks[s].data() + c * n, n);
+    }
+    return table;
+}
+
+// Asymmetric squared distance of the query (given by its distance table) to the row
+double ProductQuantizer::getDistance(const std::vector<double> & table, unsigned row) const
+{
+    const std::uint8_t * code = codes.data() + (std::size_t) row * parameters.subspaces;
+    double distance = 0;
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+        distance += table[s * parameters.centroids + code[s]];
+    return distance;
+}
+
+// Rows nearest to the query, ordered by asymmetric distance
+std::vector<unsigned> ProductQuantizer::search(const std::vector<double> & query, unsigned k) const
+{
+    std::vector<double> table = getDistanceTable(query);
+    std::vector<std::pair<double, unsigned>> distances(rows);
+    for (unsigned i = 0; i < rows; i++)
+        distances[i] = std::make_pair(getDistance(table, i), i);
+    k = std::min(k, rows);
+    std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+    std::vector<unsigned> nearest(k);
+    for (unsigned i = 0; i < k; i++)
+        nearest[i] = distances[i].second;
+    return nearest;
+}
+
+// Size of the matrix of doubles divided by the size of codes together with codebooks
+double ProductQuantizer::getCompressionRatio() const
+{
+    double original = (double) rows * dimensions * sizeof(double);
+    double compressed = (double) codes.size() + (double) parameters.centroids * dimensions * sizeof(double);
+    return original / compressed;
+}
+
+// Sum of squared errors of reconstructed rows, relative to the sum of squared norms of rows
+double ProductQuantizer::getReconstructionError(const std::vector<std::vector<double>> & matrix) const
+{
+    double error = 0, norm = 0;
+    std::vector<double> zero(dimensions, 0.0);
+    for (unsigned i = 0; i < rows && i < matrix.size(); i++)
+    {
+        error += squaredDistance(matrix[i].data(), decode(i).data(), dimensions);
+        norm += squaredDistance(matrix[i].data(), zero.data(), dimensions);
+    }
+    if (norm == 0)
+        return error;
+    return error / norm;
+}
+
+bool ProductQuantizer::save(const std::filesystem::path & fileName) const
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if (! file.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << " for writing.\n";
+        return false;
+    }
+    unsigned header[4] = {dimensions, rows, parameters.subspaces, parameters.centroids};
+    file.write(fileMagic, sizeof(fileMagic));
+    file.write((const char *) header, sizeof(header));
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+        file.write((const char *) codebooks[s].data(), codebooks[s].size() * sizeof(double));
+    file.write((const char *) codes.data(), codes.size());
+    if (! file.good())
+    {
+        std::cerr << "Failed to write " << fileName << ".\n";
+        return false;
+    }
+    return true;
+}
+
+bool ProductQuantizer::load(const std::filesystem::path & fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (! file.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << ".\n";
+        return false;
+    }
+    char magic[sizeof(fileMagic)];
+    unsigned header[4];
+    file.read(magic, sizeof(magic));
+    file.read((char *) header, sizeof(header));
+    if (! file.good() || std::memcmp(magic, fileMagic, sizeof(fileMagic)) != 0 || header[2] == 0 || header[2] > header[0] || header[3] == 0 || header[3] > 256)
+    {
+        std::cerr << fileName << " is not a file of product quantized embeddings.\n";
+        return false;
+    }
+    dimensions = header[0];
+    rows = header[1];
+    parameters.subspaces = header[2];
+    parameters.centroids = header[3];
+    subspaceOffsets.resize(parameters.subspaces + 1);
+    for (unsigned s = 0; s <= parameters.subspaces; s++)
+        subspaceOffsets[s] = s * dimensions / parameters.subspaces;
+    codebooks.assign(parameters.subspaces, std::vector<double>());
+    for (unsigned s = 0; s < parameters.subspaces; s++)
+    {
+        codebooks[s].resize(parameters.centroids * (subspaceOffsets[s + 1] - subspaceOffsets[s]));
+        file.read((char *) codebooks[s].data(), codebooks[s].size() * sizeof(double));
+    }
+    codes.resize((std::size_t) rows * parameters.subspaces);
+    file.read((char *) codes.data(), codes.size());
+    if (! file.good())
+    {
+        std::cerr << fileName << " is truncated.\n";
+        return false;
+    }
+    return true;
+}
+
+double squaredDistance(const double * x, const double * y, unsigned n)
+{
+    double sum = 0;
+    for (unsigned i = 0; i < n; i++)
+        sum += (x[i] - y[i]) * (x[i] - y[i]);
+    return sum;
+}
+
+unsigned getNearestCentroid(const double * x, const std::vector<double> & codebook, unsigned centroids, unsigned n)
+{
+    unsigned nearest = 0;
+    double minDistance = std::numeric_limits<double>::max();
+    for (unsigned c = 0; c < centroids; c++)
+    {
+        double distance = squaredDistance(x, codebook.data() + c * n, n);
+        if (distance < minDistance)
+        {
+            minDistance = distance;
+            nearest = c;
+        }
+    }
+    return nearest;
+}
+
+// Lloyd's algorithm on subvectors of length n, initialized with distinct random points.
+// Centroid left without points is moved to a random point
+void kMeans(const std::vector<const double *> & points, unsigned n, std::vector<double> & codebook, unsigned centroids, unsigned iterations, std::mt19937 & generator)
+{
+    std::vector<unsigned> indexes(points.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::shuffle(indexes.begin(), indexes.end(), generator);
+    codebook.resize(centroids * n);
+    for (unsigned c = 0; c < centroids; c++)
+        std::copy_n(points[indexes[c]], n, codebook.begin() + c * n);
+    std::vector<unsigned> assignment(points.size()), counts(centroids);
+    std::uniform_int_distribution<unsigned> pointDist(0, points.size() - 1);
+    for (unsigned it = 0; it < iterations; it++)
+    {
+        bool changed = false;
+        for (unsigned i = 0; i < points.size(); i++)
+        {
+            unsigned c = getNearestCentroid(points[i], codebook, centroids, n);
+            if (it == 0 || c != assignment[i])
+                changed = true;
+            assignment[i] = c;
+        }
+        if (! changed)
+            break;
+        std::fill(codebook.begin(), codebook.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (unsigned i = 0; i < points.size(); i++)
+        {
+            double * centroid = codebook.data() + assignment[i] * n;
+            for (unsigned j = 0; j < n; j++)
+                centroid[j] += points[i][j];
+            counts[assignment[i]]++;
+        }
+        for (unsigned c = 0; c < centroids; c++)
+        {
+            if (counts[c] == 0)
+                std::copy_n(points[pointDist(generator)], n, codebook.begin() + c * n);
+            else
+                for (unsigned j = 0; j < n; j++)
+                    codebook[c * n + j] /= counts[c];
+        }
+    }
+}
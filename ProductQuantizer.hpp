@@ -0,0 +1,49 @@
+#ifndef PRODUCTQUANTIZER_HPP
+#define PRODUCTQUANTIZER_HPP
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <filesystem>
+
+// Product quantization of the matrix of embeddings: every row is split into subspaces, each
+// subspace of a row is stored as one byte, the number of the nearest centroid of the codebook
+// learned by k-means for this subspace. Distances to a query are computed on the codes
+// (asymmetric distance computation), rows are reconstructed from the centroids on demand
+class ProductQuantizer
+{
+public:
+    struct Parameters
+    {
+        unsigned subspaces = 8; // Number of bytes of code of a row
+        unsigned centroids = 256; // Size of codebook of every subspace, at most 256
+        unsigned iterations = 20; // Iterations of k-means
+        unsigned sampleSize = 65536; // Rows used for learning codebooks, 0 for all rows
+    };
+private:
+    Parameters parameters;
+    unsigned dimensions = 0;
+    unsigned rows = 0;
+    std::vector<unsigned> subspaceOffsets; // First dimension of every subspace, and the number of dimensions at the end
+    std::vector<std::vector<double>> codebooks; // Centroids of subspace s, one after another
+    std::vector<std::uint8_t> codes; // Row r of codes begins at r * subspaces
+    void encode(const std::vector<double> &, std::uint8_t *) const;
+public:
+    ProductQuantizer();
+    explicit ProductQuantizer(const Parameters &);
+    const Parameters & getParameters() const;
+    unsigned getDimensions() const;
+    unsigned getRows() const;
+    const std::vector<std::uint8_t> & getCodes() const;
+    bool fit(const std::vector<std::vector<double>> &, std::mt19937 &);
+    std::vector<double> decode(unsigned) const;
+    std::vector<double> getDistanceTable(const std::vector<double> &) const;
+    double getDistance(const std::vector<double> &, unsigned) const;
+    std::vector<unsigned> search(const std::vector<double> &, unsigned) const;
+    double getCompressionRatio() const;
+    double getReconstructionError(const std::vector<std::vector<double>> &) const;
+    bool save(const std::filesystem::path &) const;
+    bool load(const std::filesystem::path &);
+};
+
+#endif
@@ -0,0 +1,257 @@
+#include <iostream>
+#include <algorithm>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SharedEmbeddings.hpp"
+
+std::size_t getSegmentSize(unsigned, unsigned);
+
+const double * getSlot(const SharedEmbeddingsHeader *, unsigned);
+
+const std::uint32_t sharedMagic = 0x53325647; // "GV2S" in little endian
+
+const std::uint32_t sharedVersion = 1;
+
+// Slots begin at a cache line of their own
+const std::size_t slotsOffset = 64;
+
+static_assert(sizeof(SharedEmbeddingsHeader) <= slotsOffset, "Header of shared embeddings is too large");
+
+SharedEmbeddingsWriter::SharedEmbeddingsWriter()
+{
+}
+
+SharedEmbeddingsWriter::~SharedEmbeddingsWriter()
+{
+    close();
+}
+
+// Create the segment of the name (beginning with '/') for a matrix of the size. A segment of the name
+// left by an earlier writer is marked superseded for its readers and replaced, never resized under them
+bool SharedEmbeddingsWriter::open(const std::string & segmentName, unsigned rows, unsigned dimensions)
+{
+    close();
+    int fd = shm_open(segmentName.c_str(), O_RDWR, 0);
+    if (fd >= 0)
+    {
+        struct stat status;
+        if (fstat(fd, &status) == 0 && (std::size_t) status.st_size >= sizeof(SharedEmbeddingsHeader))
+        {
+            void * old = mmap(nullptr, sizeof(SharedEmbeddingsHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (old != MAP_FAILED)
+            {
+                static_cast<SharedEmbeddingsHeader *>(old)->superseded.store(1, std::memory_order_release);
+                munmap(old, sizeof(SharedEmbeddingsHeader));
+            }
+        }
+        ::close(fd);
+        shm_unlink(segmentName.c_str());
+    }
+    fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot create shared memory segment " << segmentName << ".\n";
+        return false;
+    }
+    std::size_t segmentSize = getSegmentSize(rows, dimensions);
+    void * segment = MAP_FAILED;
+    if (ftruncate(fd, segmentSize) == 0)
+        segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (segment == MAP_FAILED)
+    {
+        std::cerr << "Cannot map shared memory segment " << segmentName << " of " << segmentSize << " bytes.\n";
+        shm_unlink(segmentName.c_str());
+        return false;
+    }
+    // The segment is zeroed by ftruncate, magic is set last, so readers never accept a partial header
+    header = new (segment) SharedEmbeddingsHeader;
+    header->version = sharedVersion;
+    header->rows = rows;
+    header->dimensions = dimensions;
+    header->generation.store(0, std::memory_order_relaxed);
+    header->superseded.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = sharedMagic;
+    name = segmentName;
+    size = segmentSize;
+    return true;
+}
+
+// Fill the slot, which readers don't use, and publish it as the next generation
+bool SharedEmbeddingsWriter::publish(const std::vector<std::vector<double>> & embeddings)
+{
+    if (header == nullptr || embeddings.size() != header->rows)
+    {
+        std::cerr << "Embeddings don't fit the shared memory segment " << name << ".\n";
+        return false;
+    }
+    for (unsigned i = 0; i < embeddings.size(); i++)
+    {
+        if (embeddings[i].size() != header->dimensions)
+        {
+            std::cerr << "Embeddings don't fit the shared memory segment " << name << ".\n";
+            return false;
+        }
+    }
+    std::uint64_t generation = header->generation.load(std::memory_order_relaxed);
+    header->generation.store(generation + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    double * slot = const_cast<double *>(getSlot(header, (generation + 2) / 2 % 2));
+    for (unsigned i = 0; i < embeddings.size(); i++)
+        std::copy(embeddings[i].cbegin(), embeddings[i].cend(), slot + (std::size_t) i * header->dimensions);
+    header->generation.store(generation + 2, std::memory_order_release);
+    return true;
+}
+
+bool SharedEmbeddingsWriter::isOpen() const
+{
+    return header != nullptr;
+}
+
+unsigned SharedEmbeddingsWriter::getRows() const
+{
+    return header == nullptr ? 0 : header->rows;
+}
+
+unsigned SharedEmbeddingsWriter::getDimensions() const
+{
+    return header == nullptr ? 0 : header->dimensions;
+}
+
+std::uint64_t SharedEmbeddingsWriter::getGeneration() const
+{
+    return header == nullptr ? 0 : header->generation.load(std::memory_order_relaxed);
+}
+
+// Unmap the segment, its last snapshot stays for readers
+void SharedEmbeddingsWriter::close()
+{
+    if (header != nullptr)
+        munmap(header, size);
+    header = nullptr;
+    size = 0;
+}
+
+// Remove the name, mapped segments stay until their readers close them
+void SharedEmbeddingsWriter::unlink()
+{
+    if (! name.empty())
+        shm_unlink(name.c_str());
+    name.clear();
+}
+
+SharedEmbeddingsReader::SharedEmbeddingsReader()
+{
+}
+
+SharedEmbeddingsReader::~SharedEmbeddingsReader()
+{
+    close();
+}
+
+// Map the segment of the name read-only
+bool SharedEmbeddingsReader::open(const std::string & segmentName)
+{
+    close();
+    int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot open shared memory segment " << segmentName << ".\n";
+        return false;
+    }
+    struct stat status;
+    void * segment = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && (std::size_t) status.st_size >= slotsOffset)
+        segment = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (segment == MAP_FAILED)
+    {
+        std::cerr << "Cannot map shared memory segment " << segmentName << ".\n";
+        return false;
+    }
+    const SharedEmbeddingsHeader * segmentHeader = static_cast<const SharedEmbeddingsHeader *>(segment);
+    std::uint32_t magic = segmentHeader->magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (magic != sharedMagic || segmentHeader->version != sharedVersion || (std::size_t) status.st_size < getSegmentSize(segmentHeader->rows, segmentHeader->dimensions))
+    {
+        std::cerr << "Invalid shared memory segment " << segmentName << ".\n";
+        munmap(segment, status.st_size);
+        return false;
+    }
+    header = segmentHeader;
+    size = status.st_size;
+    return true;
+}
+
+// Latest published snapshot in place, false before the first one. While the writer fills the other
+// slot (odd generation), the snapshot before it is still the latest
+bool SharedEmbeddingsReader::getSnapshot(SharedEmbeddingsSnapshot & snapshot) const
+{
+    if (header == nullptr)
+        return false;
+    std::uint64_t generation = header->generation.load(std::memory_order_acquire) & ~(std::uint64_t) 1;
+    if (generation == 0)
+        return false;
+    snapshot.generation = generation;
+    snapshot.rows = header->rows;
+    snapshot.dimensions = header->dimensions;
+    snapshot.data = getSlot(header, generation / 2 % 2);
+    return true;
+}
+
+// True if the writer hasn't begun to overwrite the slot of the snapshot, so everything read from it
+// before the call is consistent
+bool SharedEmbeddingsReader::isValid(const SharedEmbeddingsSnapshot & snapshot) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return header != nullptr && header->generation.load(std::memory_order_relaxed) < snapshot.generation + 3;
+}
+
+// Copy of the latest snapshot, read again until no overwrite is detected
+bool SharedEmbeddingsReader::copySnapshot(std::vector<std::vector<double>> & embeddings, std::uint64_t & generation) const
+{
+    SharedEmbeddingsSnapshot snapshot;
+    while (getSnapshot(snapshot))
+    {
+        embeddings.resize(snapshot.rows);
+        for (unsigned i = 0; i < snapshot.rows; i++)
+        {
+            const double * row = snapshot.data + (std::size_t) i * snapshot.dimensions;
+            embeddings[i].assign(row, row + snapshot.dimensions);
+        }
+        if (isValid(snapshot))
+        {
+            generation = snapshot.generation;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A new writer replaced the segment of the name, open it again to follow
+bool SharedEmbeddingsReader::isSuperseded() const
+{
+    return header != nullptr && header->superseded.load(std::memory_order_acquire) != 0;
+}
+
+void SharedEmbeddingsReader::close()
+{
+    if (header != nullptr)
+        munmap(const_cast<SharedEmbeddingsHeader *>(header), size);
+    header = nullptr;
+    size = 0;
+}
+
+std::size_t getSegmentSize(unsigned rows, unsigned dimensions)
+{
+    return slotsOffset + 2 * (std::size_t) rows * dimensions * sizeof(double);
+}
+
+const double * getSlot(const SharedEmbeddingsHeader * header, unsigned slot)
+{
+    return reinterpret_cast<const double *>(reinterpret_cast<const char *>(header) + slotsOffset) + (std::size_t) slot * header->rows * header->dimensions;
+}
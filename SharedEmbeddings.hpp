@@ -0,0 +1,77 @@
+#ifndef SHAREDEMBEDDINGS_HPP
+#define SHAREDEMBEDDINGS_HPP
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Matrix of embeddings published in a named POSIX shared memory segment, so that processes of the
+// host map it read-only instead of parsing the output file. The segment is the header and two slots
+// of rows * dimensions doubles. Generation is a seqlock: odd while the writer fills a slot, even when
+// the snapshot is published, and the snapshot of generation g is in slot (g / 2) % 2. The writer
+// fills only the other slot, so a reader of generation g may use its slot in place until the
+// generation is g + 3, when the writer begins to overwrite it
+struct SharedEmbeddingsHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version; // Version of the layout
+    std::uint32_t rows;
+    std::uint32_t dimensions;
+    std::atomic<std::uint64_t> generation; // 0 before the first snapshot
+    std::atomic<std::uint32_t> superseded; // 1 once a new segment of the name replaced this one
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Generation of shared embeddings must be lock free");
+
+// Rows of a published snapshot in place, row r begins at data + r * dimensions
+struct SharedEmbeddingsSnapshot
+{
+    std::uint64_t generation = 0;
+    unsigned rows = 0;
+    unsigned dimensions = 0;
+    const double * data = nullptr;
+};
+
+// The only writer of the segment of the name, the segment stays after close until it's unlinked
+class SharedEmbeddingsWriter
+{
+private:
+    std::string name;
+    SharedEmbeddingsHeader * header = nullptr;
+    std::size_t size = 0;
+public:
+    SharedEmbeddingsWriter();
+    SharedEmbeddingsWriter(const SharedEmbeddingsWriter &) = delete;
+    SharedEmbeddingsWriter & operator=(const SharedEmbeddingsWriter &) = delete;
+    ~SharedEmbeddingsWriter();
+    bool open(const std::string &, unsigned, unsigned);
+    bool publish(const std::vector<std::vector<double>> &);
+    bool isOpen() const;
+    unsigned getRows() const;
+    unsigned getDimensions() const;
+    std::uint64_t getGeneration() const;
+    void close();
+    void unlink();
+};
+
+class SharedEmbeddingsReader
+{
+private:
+    const SharedEmbeddingsHeader * header = nullptr;
+    std::size_t size = 0;
+public:
+    SharedEmbeddingsReader();
+    SharedEmbeddingsReader(const SharedEmbeddingsReader &) = delete;
+    SharedEmbeddingsReader & operator=(const SharedEmbeddingsReader &) = delete;
+    ~SharedEmbeddingsReader();
+    bool open(const std::string &);
+    bool getSnapshot(SharedEmbeddingsSnapshot &) const;
+    bool isValid(const SharedEmbeddingsSnapshot &) const;
+    bool copySnapshot(std::vector<std::vector<double>> &, std::uint64_t &) const;
+    bool isSuperseded() const;
+    void close();
+};
+
+#endif
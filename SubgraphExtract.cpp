@@ -1,183 +1,292 @@
 #include <random>
-#include <string>
 #include <set>
 #include <map>
 #include <vector>
-#include <utility>
-#include <iostream>
-#include <filesystem>
-#include <json/json.h>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_set>
 #include "Graph.hpp"
+#include "GraphBatch.hpp"
 #include "SubgraphMaps.hpp"
 #include "SubgraphExtract.hpp"
 
+std::uint64_t getSamplingRank(unsigned, unsigned, unsigned);
+
+// Numbers of vertices adjacent to the vertex (including itself, if there is a loop), in increasing
+// order. Returns the number of all adjacent vertices, which is greater than the size of the list,
+// if they were sampled
+unsigned getAdjacentVertices(std::vector<unsigned> & adjacent, const Graph & graph, unsigned nodeNumber, const NeighborSampling & sampling)
+{
+    adjacent.clear();
+    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    {
+        if (graph.getVertex(i) != nullptr && graph.getEdge(nodeNumber, i) != nullptr)
+            adjacent.push_back(i);
+    }
+    unsigned count = adjacent.size();
+    if (sampling.maxNeighbors > 0 && count > sampling.maxNeighbors)
+    {
+        // Adjacent vertices of the smallest ranks are kept
+        std::nth_element(adjacent.begin(), adjacent.begin() + sampling.maxNeighbors, adjacent.end(), [&](unsigned a, unsigned b)
+        {
+            return getSamplingRank(sampling.seed, nodeNumber, a) < getSamplingRank(sampling.seed, nodeNumber, b);
+        });
+        adjacent.resize(sampling.maxNeighbors);
+        std::sort(adjacent.begin(), adjacent.end());
+    }
+    return count;
+}
+
+// Pseudorandom rank of the edge, mixing function of splitmix64
+std::uint64_t getSamplingRank(unsigned seed, unsigned nodeNumber, unsigned adjacentNumber)
+{
+    std::uint64_t h = ((std::uint64_t) seed << 32 | nodeNumber) * 0x9e3779b97f4a7c15ULL + adjacentNumber;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
 // Extract rooted subgraphs information
-void getWLSubgraph(Json::Value & JSONmap, const Graph & graph, const Graph::Vertex * node, unsigned graphNumber, unsigned nodeNumber, unsigned degree, unsigned dimensions)
+void getWLSubgraph(SubgraphMap & subgraphMap, SubgraphVocabulary & vocabulary, SubgraphHashing & hashing, std::vector<std::vector<double>> & subgraphsEmbeddings,
+                   const Graph & graph, const Graph::Vertex * node, unsigned degree, unsigned dimensions, const NeighborSampling & sampling, std::mt19937 & generator)
 {
-    static unsigned subgraphID = 0;
-    unsigned tempID = subgraphID;
-    //std::string subgraphString("");
-    bool alreadyInMap = false;
-    // If this subgraph is already in map of subgraphs, return it
-    if (! JSONmap["graphID"].empty() && JSONmap["graphID"].asUInt() == graphNumber && ! JSONmap["rootVertices"].empty())
-    {
-        for (unsigned i = 0; i < JSONmap["rootVertices"].size(); i++)
+    unsigned nodeNumber = node->getNumber();
+    if (subgraphMap.rootVertices.size() <= nodeNumber)
+        subgraphMap.rootVertices.resize(nodeNumber + 1);
+    // If this subgraph is already in map of subgraphs, return it. Subgraph of degree d is always
+    // added after the one of degree d - 1 rooted in the same vertex, so degrees are the indexes
+    if (subgraphMap.rootVertices[nodeNumber].size() > degree)
+        return;
+    std::vector<unsigned> adjacent;
+    if (degree > 0)
+    {
+        getAdjacentVertices(adjacent, graph, nodeNumber, sampling);
+        for (unsigned i = 0; i < adjacent.size(); i++)
         {
-            if (! JSONmap["rootVertices"][i].empty() && JSONmap["rootVertices"][i]["vertexNumber"].asUInt() == nodeNumber && ! JSONmap["rootVertices"][i]["degrees"].empty())
-            {
-                for (unsigned j = 0; j < JSONmap["rootVertices"][i]["degrees"].size(); j++)
-                {
-                    if (! JSONmap["rootVertices"][i]["degrees"][j].empty() && JSONmap["rootVertices"][i]["degrees"][j]["degree"].asUInt() == degree)
-                    {
-                        alreadyInMap = true;
-                    }
-                }
-            }
+            getWLSubgraph(subgraphMap, vocabulary, hashing, subgraphsEmbeddings, graph, graph.getVertex(adjacent[i]), degree - 1, dimensions, sampling, generator);
         }
+        getWLSubgraph(subgraphMap, vocabulary, hashing, subgraphsEmbeddings, graph, node, degree - 1, dimensions, sampling, generator);
     }
-    if (! alreadyInMap)
+    std::vector<unsigned> signature;
+    getSubgraphSignature(signature, subgraphMap, graph, nodeNumber, adjacent, degree);
+    subgraphMap.rootVertices[nodeNumber].push_back(getSubgraphID(vocabulary, hashing, subgraphsEmbeddings, signature, degree, dimensions, generator));
+}
+
+// Extract rooted subgraphs of the graph degree by degree, until the partition of vertices by their
+// subgraphs stops changing. Signatures of the next degree are counted before they get IDs: if there
+// are as many different signatures as subgraphs of the previous degree, WL relabeling refines the
+// partition no more and higher degrees aren't extracted (look to the getRootSubgraph). Returns the
+// number of degrees extracted
+unsigned getWLSubgraphsAdaptive(SubgraphMap & subgraphMap, SubgraphVocabulary & vocabulary, SubgraphHashing & hashing, std::vector<std::vector<double>> & subgraphsEmbeddings,
+                                const Graph & graph, unsigned degree, unsigned dimensions, const NeighborSampling & sampling, std::mt19937 & generator)
+{
+    subgraphMap.rootVertices.assign(graph.getMaxVertex(), std::vector<unsigned>());
+    std::vector<unsigned> vertices;
+    std::vector<std::vector<unsigned>> adjacent(graph.getMaxVertex());
+    for (unsigned v = 0; v < graph.getMaxVertex(); v++)
     {
-        if (degree == 0)
-            ;
-        else
+        if (graph.getVertex(v) == nullptr)
+            continue;
+        vertices.push_back(v);
+        getAdjacentVertices(adjacent[v], graph, v, sampling);
+    }
+    std::vector<std::vector<unsigned>> signatures(vertices.size());
+    std::unordered_set<std::vector<unsigned>, SignatureHash> differentSignatures;
+    std::unordered_set<unsigned> previousSubgraphs;
+    for (unsigned d = 0; d <= degree; d++)
+    {
+        differentSignatures.clear();
+        for (unsigned i = 0; i < vertices.size(); i++)
         {
-            std::set<const Graph::Vertex *> adjacentNodes;
-            for (unsigned i = 0; i < graph.getMaxVertex(); i++)
-            {
-                if (graph.getEdge(node->getNumber(), i) != nullptr)
-                {
-                    adjacentNodes.insert(graph.getVertex(i));
-                }
-            }
-            for (std::set<const Graph::Vertex *>::iterator i = adjacentNodes.cbegin(); i != adjacentNodes.cend(); i++)
-            {
-                getWLSubgraph(JSONmap, graph, *i, graphNumber, (*i)->getNumber(), degree - 1, dimensions);
-            }
-            getWLSubgraph(JSONmap, graph, node, graphNumber, nodeNumber, degree - 1, dimensions);
+            getSubgraphSignature(signatures[i], subgraphMap, graph, vertices[i], adjacent[vertices[i]], d);
+            differentSignatures.insert(signatures[i]);
         }
-        // Increment unique subgraph ID
-        subgraphID++;
-        std::random_device dev;
-        std::uniform_real_distribution<double> unidist(-1.0, 1.0);
-        if (JSONmap["graphID"].empty())
+        if (d > 0 && differentSignatures.size() == previousSubgraphs.size())
+            return d;
+        previousSubgraphs.clear();
+        for (unsigned i = 0; i < vertices.size(); i++)
         {
-            std::cout << "Subgraph no " << subgraphID << "\n";
-            JSONmap["graphID"] = graphNumber;
-            JSONmap["rootVertices"][0]["vertexNumber"] = nodeNumber;
-            JSONmap["rootVertices"][0]["degrees"][0]["degree"] = degree;
-            JSONmap["rootVertices"][0]["degrees"][0]["subgraphID"] = tempID;
-            // Generate random vector representations of subgraphs
-            for (unsigned i = 0; i < dimensions; i++)
-            {
-                JSONmap["rootVertices"][0]["degrees"][0]["subgraphEmbedding"][i] = unidist(dev);
-            }
+            unsigned subgraphID = getSubgraphID(vocabulary, hashing, subgraphsEmbeddings, signatures[i], d, dimensions, generator);
+            subgraphMap.rootVertices[vertices[i]].push_back(subgraphID);
+            previousSubgraphs.insert(subgraphID);
         }
-        else
+    }
+    return degree + 1;
+}
+
+// WL relabeling of all graphs of the batch at once, every degree is one sweep over the vertices
+// of the batch. Maps of subgraphs of the batch graphs are appended to the vector of maps
+void getWLSubgraphsBatch(std::vector<SubgraphMap> & maps, SubgraphVocabulary & vocabulary, SubgraphHashing & hashing, std::vector<std::vector<double>> & subgraphsEmbeddings,
+                         const GraphBatch & batch, unsigned firstGraphID, unsigned degree, unsigned dimensions, std::mt19937 & generator)
+{
+    unsigned vertices = batch.vertexNumbers.size();
+    std::vector<std::vector<unsigned>> subgraphIDs(degree + 1, std::vector<unsigned>(vertices));
+    std::vector<unsigned> signature(1);
+    for (unsigned v = 0; v < vertices; v++)
+    {
+        signature[0] = batch.labels[v];
+        subgraphIDs[0][v] = getSubgraphID(vocabulary, hashing, subgraphsEmbeddings, signature, 0, dimensions, generator);
+    }
+    for (unsigned d = 1; d <= degree; d++)
+    {
+        const std::vector<unsigned> & previous = subgraphIDs[d - 1];
+        for (unsigned v = 0; v < vertices; v++)
         {
-            bool nodeNumberExists = false, degreeExists = false;
-            unsigned i, j;
-            for (i = 0; i < JSONmap["rootVertices"].size(); i++)
-            {
-                if (JSONmap["rootVertices"][i]["vertexNumber"].asUInt() == nodeNumber)
-                {
-                    nodeNumberExists = true;
-                    for (j = 0; j < JSONmap["rootVertices"][i]["degrees"].size(); j++)
-                    {
-                        if (JSONmap["rootVertices"][i]["degrees"][j]["degree"].asUInt() == degree)
-                        {
-                            degreeExists = true;
-                            break;
-                        }
-                    }
-                }
-                if (nodeNumberExists)
-                {
-                    break;
-                }
-            }
-            if (! nodeNumberExists)
-            {
-                std::cout << "Subgraph no " << subgraphID << "\n";
-                JSONmap["rootVertices"][i]["vertexNumber"] = nodeNumber;
-                JSONmap["rootVertices"][i]["degrees"][0]["degree"] = degree;
-                JSONmap["rootVertices"][i]["degrees"][0]["subgraphID"] = tempID;
-                // Generate random vector representations of subgraphs
-                for (unsigned k = 0; k < dimensions; k++)
-                {
-                    JSONmap["rootVertices"][i]["degrees"][0]["subgraphEmbedding"][k] = unidist(dev);
-                }
-            }
-            else if (nodeNumberExists && ! degreeExists)
-            {
-                std::cout << "Subgraph no " << subgraphID << "\n";
-                JSONmap["rootVertices"][i]["degrees"][j]["degree"] = degree;
-                JSONmap["rootVertices"][i]["degrees"][j]["subgraphID"] = tempID;
-                // Generate random vector representations of subgraphs
-                for (unsigned k = 0; k < dimensions; k++)
-                {
-                    JSONmap["rootVertices"][i]["degrees"][j]["subgraphEmbedding"][k] = unidist(dev);
-                }
-            }
+            signature.assign(1, previous[v]);
+            for (unsigned i = batch.adjacencyOffsets[v]; i < batch.adjacencyOffsets[v + 1]; i++)
+                signature.push_back(previous[batch.adjacentVertices[i]]);
+            std::sort(signature.begin() + 1, signature.end());
+            subgraphIDs[d][v] = getSubgraphID(vocabulary, hashing, subgraphsEmbeddings, signature, d, dimensions, generator);
+        }
+    }
+    for (unsigned g = 0; g + 1 < batch.graphOffsets.size(); g++)
+    {
+        maps.push_back(SubgraphMap());
+        maps.back().graphID = firstGraphID + g;
+        for (unsigned v = batch.graphOffsets[g]; v < batch.graphOffsets[g + 1]; v++)
+        {
+            unsigned vertexNumber = batch.vertexNumbers[v];
+            if (maps.back().rootVertices.size() <= vertexNumber)
+                maps.back().rootVertices.resize(vertexNumber + 1);
+            for (unsigned d = 0; d <= degree; d++)
+                maps.back().rootVertices[vertexNumber].push_back(subgraphIDs[d][v]);
         }
     }
 }
 
-void radialSkipGram(RadialContext & context, const std::vector<std::string> & subgraphs, const std::vector<Graph> & graphs, unsigned degree)
+// Signature of the subgraph (look to the SubgraphMaps.hpp) given adjacent vertices of its root,
+// subgraphs of degree - 1 have to be in map
+void getSubgraphSignature(std::vector<unsigned> & signature, const SubgraphMap & subgraphMap, const Graph & graph, unsigned nodeNumber,
+                          const std::vector<unsigned> & adjacent, unsigned degree)
+{
+    signature.clear();
+    if (degree == 0)
+    {
+        signature.push_back(graph.getVertex(nodeNumber)->getLabel());
+        return;
+    }
+    signature.push_back(subgraphMap.rootVertices[nodeNumber][degree - 1]);
+    for (unsigned i = 0; i < adjacent.size(); i++)
+        signature.push_back(subgraphMap.rootVertices[adjacent[i]][degree - 1]);
+    std::sort(signature.begin() + 1, signature.end());
+}
+
+// ID of the subgraph of given signature. Subgraph, which isn't in vocabulary yet, gets the next
+// free row of the subgraph embeddings matrix as ID, with random vector representation. With
+// feature hashing ID is the bucket of the signature and rows of all buckets already exist
+unsigned getSubgraphID(SubgraphVocabulary & vocabulary, SubgraphHashing & hashing, std::vector<std::vector<double>> & subgraphsEmbeddings,
+                       const std::vector<unsigned> & signature, unsigned degree, unsigned dimensions, std::mt19937 & generator)
+{
+    if (hashing.buckets > 0)
+        return getHashedSubgraphID(hashing, signature, degree);
+    if (vocabulary.size() <= degree)
+        vocabulary.resize(degree + 1);
+    SubgraphVocabulary::value_type::const_iterator it = vocabulary[degree].find(signature);
+    if (it != vocabulary[degree].cend())
+        return it->second;
+    unsigned subgraphID = subgraphsEmbeddings.size();
+    vocabulary[degree].emplace(signature, subgraphID);
+    std::uniform_real_distribution<double> unidist(-1.0, 1.0);
+    subgraphsEmbeddings.push_back(std::vector<double>());
+    for (unsigned i = 0; i < dimensions; i++)
+    {
+        subgraphsEmbeddings[subgraphID].push_back(unidist(generator));
+    }
+    return subgraphID;
+}
+
+unsigned getHashedSubgraphID(SubgraphHashing & hashing, const std::vector<unsigned> & signature, unsigned degree)
+{
+    std::uint64_t h = SignatureHash()(signature) + degree * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h = h ^ (h >> 31);
+    unsigned bucket = h % hashing.buckets;
+    h |= 1;
+    if (hashing.fingerprints.size() < hashing.buckets)
+    {
+        hashing.fingerprints.resize(hashing.buckets, 0);
+        hashing.collided.resize(hashing.buckets, false);
+    }
+    hashing.subgraphs++;
+    if (hashing.fingerprints[bucket] == 0)
+        hashing.fingerprints[bucket] = h;
+    else if (hashing.fingerprints[bucket] != h)
+    {
+        hashing.collisions++;
+        hashing.collided[bucket] = true;
+    }
+    return bucket;
+}
+
+// Remove subgraphs of ID firstID and greater from vocabulary
+void truncateVocabulary(SubgraphVocabulary & vocabulary, unsigned firstID)
+{
+    for (unsigned d = 0; d < vocabulary.size(); d++)
+    {
+        for (SubgraphVocabulary::value_type::iterator it = vocabulary[d].begin(); it != vocabulary[d].end(); )
+        {
+            if (it->second >= firstID)
+                it = vocabulary[d].erase(it);
+            else
+                it++;
+        }
+    }
+}
+
+void radialSkipGram(RadialContext & context, const std::vector<SubgraphMap> & subgraphs, const std::vector<Graph> & graphs, unsigned degree,
+                    const NeighborSampling & sampling, std::mt19937 & generator)
 {
     for (unsigned i = 0; i < graphs.size(); i++)
+        radialSkipGramGraph(context, subgraphs[i], graphs[i], degree, sampling, generator);
+}
+
+// Radial context of the subgraphs of one graph
+void radialSkipGramGraph(RadialContext & context, const SubgraphMap & subgraphMap, const Graph & graph, unsigned degree, const NeighborSampling & sampling,
+                         std::mt19937 & generator)
+{
+    std::vector<unsigned> adjacent;
+    for (unsigned j = 0; j < graph.getMaxVertex(); j++)
     {
-        std::ifstream subgraphsMap(subgraphs[i]);
-        Json::Value JSONmap;
-        subgraphsMap >> JSONmap;
-        for (unsigned j = 0; j < graphs[i].getMaxVertex(); j++)
+        if (graph.getVertex(j) != nullptr)
         {
-            if (graphs[i].getVertex(j) != nullptr)
+            getAdjacentVertices(adjacent, graph, j, sampling);
+            // Root vertex isn't in its own context
+            adjacent.erase(std::remove(adjacent.begin(), adjacent.end(), j), adjacent.end());
+            // Aliased degrees of adaptive degree get no context of their own
+            unsigned graphDegree = std::min<unsigned>(degree, subgraphMap.rootVertices[j].size() - 1);
+            for (unsigned d = 0; d <= graphDegree; d++)
             {
-                for (unsigned d = 0; d <= degree; d++)
-                {
-                    unsigned subgraphID = JSONmap["rootVertices"][j]["degrees"][d]["subgraphID"].asUInt();
-                    radialSkipGramCore(context, JSONmap, subgraphID, graphs[i], graphs[i].getVertex(j), d, degree);
-                                        
-                }
+                unsigned subgraphID = subgraphMap.rootVertices[j][d];
+                radialSkipGramCore(context, subgraphMap, subgraphID, graph, adjacent, d, graphDegree, generator);
             }
         }
-        JSONmap.clear();
-        subgraphsMap.close();
     }
 }
 
-void radialSkipGramCore(RadialContext & context, Json::Value & JSONmap, unsigned subgraphID, const Graph & graph, const Graph::Vertex * node, unsigned d, unsigned degree)
+void radialSkipGramCore(RadialContext & context, const SubgraphMap & subgraphMap, unsigned subgraphID, const Graph & graph, const std::vector<unsigned> & adjacent,
+                        unsigned d, unsigned degree, std::mt19937 & generator)
 {
-    bool hasAdjacentVertices = false;
-    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    bool hasAdjacentVertices = ! adjacent.empty();
+    std::multiset<unsigned> & subgraphContext = context[subgraphID];
+    for (unsigned i = 0; i < adjacent.size(); i++)
     {
-        if (node->getNumber() != graph.getVertex(i)->getNumber() && graph.getEdge(node->getNumber(), graph.getVertex(i)->getNumber()) != nullptr)
+        for (unsigned delta = (d > 0 ? d - 1 : 0); delta <= (d + 1 < degree ? d + 1 : degree); delta++)
         {
-            hasAdjacentVertices = true;
-            for (unsigned delta = ((long long) d - 1 > 0 ? d - 1 : 0); delta <= ((long long) d + 1 < degree ? d + 1 : degree); delta++)
-            {
-                unsigned tempID = JSONmap["rootVertices"][i]["degrees"][delta]["subgraphID"].asUInt();
-                if (context.count(subgraphID) == 0)
-                    context[subgraphID] = std::multiset<unsigned>();
-                context[subgraphID].insert(tempID);
-            }
+            subgraphContext.insert(subgraphMap.rootVertices[adjacent[i]][delta]);
         }
     }
     // If particular vertex in particular graph doesn't have adjacent vertices, generate its context vertex randomly
     if (! hasAdjacentVertices)
     {
-        std::random_device dev;
         std::uniform_int_distribution<unsigned> unidist(0, graph.getMaxVertex() - 1);
         unsigned temp;
         do
-            temp = unidist(dev);
+            temp = unidist(generator);
         while (graph.getVertex(temp) == nullptr);
-        for (unsigned delta = ((long long) d - 1 > 0 ? d - 1 : 0); delta <= ((long long) d + 1 < degree ? d + 1 : degree); delta++)
+        for (unsigned delta = (d > 0 ? d - 1 : 0); delta <= (d + 1 < degree ? d + 1 : degree); delta++)
         {
-            unsigned tempID = JSONmap["rootVertices"][temp]["degrees"][delta]["subgraphID"].asUInt();
-            if (context.count(subgraphID) == 0)
-                context[subgraphID] = std::multiset<unsigned>();
-            context[subgraphID].insert(tempID);
+            subgraphContext.insert(subgraphMap.rootVertices[temp][delta]);
         }
     }
 }
@@ -1,17 +1,35 @@
 #ifndef SUBGRAPHEXTRACT_HPP
 #define SUBGRAPHEXTRACT_HPP
 
-#include <string>
 #include <vector>
-#include <fstream>
-#include <json/json.h>
+#include <random>
 #include "Graph.hpp"
+#include "GraphBatch.hpp"
 #include "SubgraphMaps.hpp"
 
-void getWLSubgraph(Json::Value &, const Graph &, const Graph::Vertex *, unsigned, unsigned, unsigned, unsigned);
+unsigned getAdjacentVertices(std::vector<unsigned> &, const Graph &, unsigned, const NeighborSampling &);
 
-void radialSkipGram(RadialContext &, const std::vector<std::string> &, const std::vector<Graph> &, unsigned);
+void getWLSubgraph(SubgraphMap &, SubgraphVocabulary &, SubgraphHashing &, std::vector<std::vector<double>> &, const Graph &, const Graph::Vertex *, unsigned, unsigned,
+                   const NeighborSampling &, std::mt19937 &);
 
-void radialSkipGramCore(RadialContext &, Json::Value &, unsigned, const Graph &, const Graph::Vertex *, unsigned, unsigned);
+unsigned getWLSubgraphsAdaptive(SubgraphMap &, SubgraphVocabulary &, SubgraphHashing &, std::vector<std::vector<double>> &, const Graph &, unsigned, unsigned,
+                                const NeighborSampling &, std::mt19937 &);
+
+void getWLSubgraphsBatch(std::vector<SubgraphMap> &, SubgraphVocabulary &, SubgraphHashing &, std::vector<std::vector<double>> &, const GraphBatch &, unsigned, unsigned,
+                         unsigned, std::mt19937 &);
+
+void getSubgraphSignature(std::vector<unsigned> &, const SubgraphMap &, const Graph &, unsigned, const std::vector<unsigned> &, unsigned);
+
+unsigned getSubgraphID(SubgraphVocabulary &, SubgraphHashing &, std::vector<std::vector<double>> &, const std::vector<unsigned> &, unsigned, unsigned, std::mt19937 &);
+
+unsigned getHashedSubgraphID(SubgraphHashing &, const std::vector<unsigned> &, unsigned);
+
+void truncateVocabulary(SubgraphVocabulary &, unsigned);
+
+void radialSkipGram(RadialContext &, const std::vector<SubgraphMap> &, const std::vector<Graph> &, unsigned, const NeighborSampling &, std::mt19937 &);
+
+void radialSkipGramGraph(RadialContext &, const SubgraphMap &, const Graph &, unsigned, const NeighborSampling &, std::mt19937 &);
+
+void radialSkipGramCore(RadialContext &, const SubgraphMap &, unsigned, const Graph &, const std::vector<unsigned> &, unsigned, unsigned, std::mt19937 &);
 
 #endif
@@ -3,9 +3,70 @@
 
 #include <map>
 #include <set>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
 
 // For every rooted subgraph (ID) map multiset of subgraphs (ID), which are in the radial
 // context of this subgraph
 typedef std::map<unsigned, std::multiset<unsigned>> RadialContext;
 
+// Rooted subgraphs of one graph: rootVertices[v][d] is the ID of the subgraph of degree d
+// rooted in the vertex of number v (empty vector for vertex numbers not present in graph).
+// Vector representations of subgraphs are kept apart, in the matrix indexed by subgraph ID.
+// With adaptive degree all vertices of the graph may have fewer degrees than the maximum
+struct SubgraphMap
+{
+    unsigned graphID;
+    std::vector<std::vector<unsigned>> rootVertices;
+};
+
+// ID of the subgraph of degree d rooted in the vertex v. Degrees over the last one extracted by
+// adaptive degree are aliased to it, since they partition vertices of the graph the same way
+inline unsigned getRootSubgraph(const SubgraphMap & subgraphMap, unsigned v, unsigned d)
+{
+    const std::vector<unsigned> & degrees = subgraphMap.rootVertices[v];
+    return degrees[d < degrees.size() ? d : degrees.size() - 1];
+}
+
+struct SignatureHash
+{
+    std::size_t operator()(const std::vector<unsigned> & signature) const
+    {
+        std::size_t h = signature.size();
+        for (unsigned i = 0; i < signature.size(); i++)
+            h ^= signature[i] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+// Vocabulary of rooted subgraphs, one hash table for every degree (iteration of WL relabeling).
+// Signature of subgraph of degree 0 is the label of its root vertex, signature of subgraph of
+// degree d > 0 is the ID of subgraph of degree d - 1 rooted in the same vertex, followed by
+// sorted IDs of subgraphs of degree d - 1 rooted in adjacent vertices
+typedef std::vector<std::unordered_map<std::vector<unsigned>, unsigned, SignatureHash>> SubgraphVocabulary;
+
+// Feature hashing of subgraphs: ID of subgraph is the hash of its degree and signature modulo
+// buckets, so the number of embeddings is fixed and the vocabulary isn't kept at all. Different
+// subgraphs of the same ID are told apart by the full hash (fingerprint) of the first subgraph of
+// every bucket, only to count collisions
+struct SubgraphHashing
+{
+    unsigned buckets = 0; // 0 for vocabulary of all subgraphs
+    std::vector<std::uint64_t> fingerprints; // 0 for bucket without subgraphs yet
+    std::vector<bool> collided; // Bucket of more different subgraphs
+    unsigned long long subgraphs = 0; // Rooted subgraphs hashed
+    unsigned long long collisions = 0; // Rooted subgraphs hashed to the bucket of another subgraph
+};
+
+// Approximate extraction: vertex with more than maxNeighbors adjacent vertices uses only
+// maxNeighbors of them, for relabeling as well as for radial context. The sample is always
+// the same for the same seed and vertex numbers, in every degree
+struct NeighborSampling
+{
+    unsigned maxNeighbors = 0; // 0 for all adjacent vertices
+    unsigned seed = 0;
+};
+
 #endif
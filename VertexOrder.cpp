@@ -0,0 +1,140 @@
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "VertexOrder.hpp"
+
+void getAdjacencyLists(std::vector<std::vector<unsigned>> &, const Graph &);
+
+void breadthFirstSearch(std::vector<unsigned> &, std::vector<bool> &, const std::vector<std::vector<unsigned>> &, unsigned, bool);
+
+const char * vertexOrderNames[] = {"original", "degree", "bfs", "rcm"};
+
+bool parseVertexOrder(VertexOrder & order, const char * name)
+{
+    for (unsigned i = 0; i < sizeof(vertexOrderNames) / sizeof(vertexOrderNames[0]); i++)
+    {
+        if (std::strcmp(name, vertexOrderNames[i]) == 0)
+        {
+            order = (VertexOrder) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char * getVertexOrderName(VertexOrder order)
+{
+    return vertexOrderNames[order];
+}
+
+// New order of existing vertices of the graph: order[i] is the number of the vertex, which gets
+// number i. Vertex numbers missing in the graph are dropped, so the numbers become 0 to n - 1
+void getVertexOrder(std::vector<unsigned> & order, const Graph & graph, VertexOrder vertexOrder)
+{
+    order.clear();
+    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    {
+        if (graph.getVertex(i) != nullptr)
+            order.push_back(i);
+    }
+    if (vertexOrder == originalOrder)
+        return;
+    std::vector<std::vector<unsigned>> adjacent;
+    getAdjacencyLists(adjacent, graph);
+    if (vertexOrder == degreeOrder)
+    {
+        std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) { return adjacent[a].size() > adjacent[b].size(); });
+        return;
+    }
+    std::vector<unsigned> starts = order;
+    // Cuthill-McKee starts every component at a vertex of minimum degree
+    if (vertexOrder == rcmOrder)
+        std::stable_sort(starts.begin(), starts.end(), [&](unsigned a, unsigned b) { return adjacent[a].size() < adjacent[b].size(); });
+    std::vector<bool> visited(graph.getMaxVertex(), false);
+    order.clear();
+    for (unsigned i = 0; i < starts.size(); i++)
+    {
+        if (! visited[starts[i]])
+            breadthFirstSearch(order, visited, adjacent, starts[i], vertexOrder == rcmOrder);
+    }
+    if (vertexOrder == rcmOrder)
+        std::reverse(order.begin(), order.end());
+}
+
+// Graph with vertex order[i] of the graph as vertex i. The last vertex is added first, so that rows
+// of the adjacency matrix are allocated one after another
+void reorderGraph(Graph & reordered, const Graph & graph, const std::vector<unsigned> & order)
+{
+    reordered = Graph();
+    if (order.empty())
+        return;
+    std::vector<unsigned> numbers(graph.getMaxVertex());
+    for (unsigned i = 0; i < order.size(); i++)
+        numbers[order[i]] = i;
+    for (unsigned i = order.size(); i > 0; i--)
+        reordered.addVertex(i - 1, graph.getVertex(order[i - 1])->getLabel());
+    for (unsigned i = 0; i < order.size(); i++)
+    {
+        for (unsigned j = 0; j < graph.getMaxVertex(); j++)
+        {
+            if (graph.getVertex(j) != nullptr && graph.getEdge(order[i], j) != nullptr)
+                reordered.addEdge(i, numbers[j]);
+        }
+    }
+}
+
+// Largest difference of numbers of adjacent vertices
+unsigned getBandwidth(const Graph & graph)
+{
+    unsigned bandwidth = 0;
+    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    {
+        for (unsigned j = 0; j < graph.getMaxVertex(); j++)
+        {
+            if (graph.getEdge(i, j) != nullptr)
+                bandwidth = std::max(bandwidth, i > j ? i - j : j - i);
+        }
+    }
+    return bandwidth;
+}
+
+// Adjacent vertices of every vertex, edges are taken in both directions
+void getAdjacencyLists(std::vector<std::vector<unsigned>> & adjacent, const Graph & graph)
+{
+    adjacent.assign(graph.getMaxVertex(), std::vector<unsigned>());
+    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    {
+        for (unsigned j = 0; j < graph.getMaxVertex(); j++)
+        {
+            if (i != j && graph.getVertex(i) != nullptr && graph.getVertex(j) != nullptr && (graph.getEdge(i, j) != nullptr || graph.getEdge(j, i) != nullptr))
+                adjacent[i].push_back(j);
+        }
+    }
+}
+
+// Append vertices of the component of start in BFS order, adjacent vertices by increasing degree
+// if byDegree, otherwise by increasing number
+void breadthFirstSearch(std::vector<unsigned> & order, std::vector<bool> & visited, const std::vector<std::vector<unsigned>> & adjacent, unsigned start, bool byDegree)
+{
+    std::size_t next = order.size();
+    std::vector<unsigned> unvisited;
+    order.push_back(start);
+    visited[start] = true;
+    while (next < order.size())
+    {
+        unsigned vertex = order[next++];
+        unvisited.clear();
+        for (unsigned i = 0; i < adjacent[vertex].size(); i++)
+        {
+            if (! visited[adjacent[vertex][i]])
+                unvisited.push_back(adjacent[vertex][i]);
+        }
+        if (byDegree)
+            std::stable_sort(unvisited.begin(), unvisited.end(), [&](unsigned a, unsigned b) { return adjacent[a].size() < adjacent[b].size(); });
+        for (unsigned i = 0; i < unvisited.size(); i++)
+        {
+            visited[unvisited[i]] = true;
+            order.push_back(unvisited[i]);
+        }
+    }
+}
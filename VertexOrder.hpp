@@ -0,0 +1,26 @@
+#ifndef VERTEXORDER_HPP
+#define VERTEXORDER_HPP
+
+#include <vector>
+#include "Graph.hpp"
+
+// Renumbering of vertices after ingestion, so that adjacent vertices get close numbers
+enum VertexOrder
+{
+    originalOrder, // Vertices are not renumbered
+    degreeOrder, // Decreasing number of adjacent vertices
+    bfsOrder, // Breadth-first search from the lowest number of every component
+    rcmOrder // Reverse Cuthill-McKee: BFS from a vertex of minimum degree, adjacent vertices by increasing degree, reversed
+};
+
+bool parseVertexOrder(VertexOrder &, const char *);
+
+const char * getVertexOrderName(VertexOrder);
+
+void getVertexOrder(std::vector<unsigned> &, const Graph &, VertexOrder);
+
+void reorderGraph(Graph &, const Graph &, const std::vector<unsigned> &);
+
+unsigned getBandwidth(const Graph &);
+
+#endif
@@ -0,0 +1,207 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include "WLKernel.hpp"
+
+void getKernelRow(double *, const SubgraphCounts &, const SubgraphCounts &, unsigned);
+
+double getSquaredNorm(const SubgraphCounts &, unsigned);
+
+// Row of every map, counts of rooted subgraphs of all vertices and degrees
+void getSubgraphCounts(SubgraphCounts & counts, const std::vector<SubgraphMap> & maps, unsigned columns)
+{
+    counts.columns = columns;
+    counts.rowOffsets.assign(1, 0);
+    counts.subgraphs.clear();
+    counts.counts.clear();
+    std::vector<unsigned> ids;
+    for (unsigned g = 0; g < maps.size(); g++)
+    {
+        ids.clear();
+        for (unsigned v = 0; v < maps[g].rootVertices.size(); v++)
+            ids.insert(ids.end(), maps[g].rootVertices[v].cbegin(), maps[g].rootVertices[v].cend());
+        std::sort(ids.begin(), ids.end());
+        for (unsigned i = 0; i < ids.size(); i++)
+        {
+            if (i > 0 && ids[i] == ids[i - 1])
+                counts.counts.back()++;
+            else
+            {
+                counts.subgraphs.push_back(ids[i]);
+                counts.counts.push_back(1);
+            }
+        }
+        counts.rowOffsets.push_back(counts.subgraphs.size());
+    }
+}
+
+// Row of every subgraph ID with its counts in every graph, which is column of the counts
+void transposeSubgraphCounts(SubgraphCounts & transposed, const SubgraphCounts & counts)
+{
+    unsigned rows = counts.rowOffsets.size() - 1;
+    transposed.columns = rows;
+    transposed.rowOffsets.assign(counts.columns + 1, 0);
+    for (std::size_t i = 0; i < counts.subgraphs.size(); i++)
+        transposed.rowOffsets[counts.subgraphs[i] + 1]++;
+    for (unsigned c = 0; c < counts.columns; c++)
+        transposed.rowOffsets[c + 1] += transposed.rowOffsets[c];
+    transposed.subgraphs.resize(counts.subgraphs.size());
+    transposed.counts.resize(counts.counts.size());
+    std::vector<std::size_t> positions(transposed.rowOffsets.cbegin(), transposed.rowOffsets.cend() - 1);
+    for (unsigned r = 0; r < rows; r++)
+    {
+        for (std::size_t i = counts.rowOffsets[r]; i < counts.rowOffsets[r + 1]; i++)
+        {
+            std::size_t position = positions[counts.subgraphs[i]]++;
+            transposed.subgraphs[position] = r;
+            transposed.counts[position] = counts.counts[i];
+        }
+    }
+}
+
+// Line of every graph: its number as label, then subgraph ID + 1 (indexes of libsvm begin at 1) and count
+bool writeLibSVM(const std::filesystem::path & fileName, const SubgraphCounts & counts)
+{
+    std::ofstream file(fileName);
+    if (! file.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << " for writing.\n";
+        return false;
+    }
+    for (unsigned r = 0; r + 1 < counts.rowOffsets.size(); r++)
+    {
+        file << r;
+        for (std::size_t i = counts.rowOffsets[r]; i < counts.rowOffsets[r + 1]; i++)
+            file << " " << counts.subgraphs[i] + 1 << ":" << counts.counts[i];
+        file << "\n";
+    }
+    if (! file.good())
+    {
+        std::cerr << "Failed to write " << fileName << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// Rows firstRow to lastRow of the WL subtree kernel (dot products of counts of subgraphs of graphs),
+// one after another in the block. Normalized kernel is divided by norms of both graphs (cosine).
+// Threads take every threads-th row of the block
+void getKernelBlock(std::vector<double> & block, const SubgraphCounts & counts, const SubgraphCounts & transposed, unsigned firstRow, unsigned lastRow, bool normalized, unsigned threads)
+{
+    unsigned n = counts.rowOffsets.size() - 1;
+    block.assign((std::size_t) (lastRow - firstRow) * n, 0.0);
+    std::vector<double> norms;
+    if (normalized)
+    {
+        norms.resize(n);
+        for (unsigned r = 0; r < n; r++)
+            norms[r] = std::sqrt(getSquaredNorm(counts, r));
+    }
+    threads = std::max(1u, std::min(threads, lastRow - firstRow));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]()
+        {
+            for (unsigned r = firstRow + t; r < lastRow; r += threads)
+            {
+                double * row = block.data() + (std::size_t) (r - firstRow) * n;
+                getKernelRow(row, counts, transposed, r);
+                if (normalized)
+                    for (unsigned j = 0; j < n; j++)
+                        row[j] = norms[r] > 0 && norms[j] > 0 ? row[j] / (norms[r] * norms[j]) : 0;
+            }
+        });
+    }
+    for (unsigned t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+// Text file of N x N kernel, line of every graph. It's computed by blocks of blockRows rows,
+// so only one block is in memory
+bool writeKernelMatrix(const std::filesystem::path & fileName, const SubgraphCounts & counts, bool normalized, unsigned threads, unsigned blockRows)
+{
+    std::ofstream file(fileName);
+    if (! file.is_open())
+    {
+        std::cerr << "Cannot open " << fileName << " for writing.\n";
+        return false;
+    }
+    SubgraphCounts transposed;
+    transposeSubgraphCounts(transposed, counts);
+    unsigned n = counts.rowOffsets.size() - 1;
+    blockRows = std::max(1u, blockRows);
+    std::vector<double> block;
+    for (unsigned first = 0; first < n; first += blockRows)
+    {
+        unsigned last = std::min(first + blockRows, n);
+        getKernelBlock(block, counts, transposed, first, last, normalized, threads);
+        for (unsigned r = first; r < last; r++)
+        {
+            const double * row = block.data() + (std::size_t) (r - first) * n;
+            for (unsigned j = 0; j < n; j++)
+                file << (j > 0 ? " " : "") << row[j];
+            file << "\n";
+        }
+    }
+    if (! file.good())
+    {
+        std::cerr << "Failed to write " << fileName << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// Sorted IDs of subgraphs of the highest degree of all vertices. Subgraph of degree d determines its
+// subgraphs of lower degrees, so graphs of the same signature can't be told apart by WL relabeling
+// up to degree d (they have the same counts of subgraphs of every degree)
+void getGraphSignature(std::vector<unsigned> & signature, const SubgraphMap & subgraphMap, unsigned degree)
+{
+    signature.clear();
+    for (unsigned v = 0; v < subgraphMap.rootVertices.size(); v++)
+    {
+        if (! subgraphMap.rootVertices[v].empty())
+            signature.push_back(getRootSubgraph(subgraphMap, v, degree));
+    }
+    std::sort(signature.begin(), signature.end());
+}
+
+// representatives[i] is the first graph of the same signature as graph i (i itself for the first
+// graph of every group). Returns the number of graphs equivalent to an earlier one
+unsigned groupEquivalentGraphs(std::vector<unsigned> & representatives, const std::vector<SubgraphMap> & maps, unsigned degree)
+{
+    representatives.resize(maps.size());
+    std::unordered_map<std::vector<unsigned>, unsigned, SignatureHash> groups;
+    std::vector<unsigned> signature;
+    unsigned duplicates = 0;
+    for (unsigned i = 0; i < maps.size(); i++)
+    {
+        getGraphSignature(signature, maps[i], degree);
+        representatives[i] = groups.emplace(signature, i).first->second;
+        duplicates += representatives[i] != i;
+    }
+    return duplicates;
+}
+
+// Dot products of row r with all rows at once: every subgraph of row r adds its count times the
+// count in every graph containing it, taken from the transposed counts (inverted index)
+void getKernelRow(double * row, const SubgraphCounts & counts, const SubgraphCounts & transposed, unsigned r)
+{
+    for (std::size_t i = counts.rowOffsets[r]; i < counts.rowOffsets[r + 1]; i++)
+    {
+        unsigned subgraph = counts.subgraphs[i];
+        double count = counts.counts[i];
+        for (std::size_t k = transposed.rowOffsets[subgraph]; k < transposed.rowOffsets[subgraph + 1]; k++)
+            row[transposed.subgraphs[k]] += count * transposed.counts[k];
+    }
+}
+
+double getSquaredNorm(const SubgraphCounts & counts, unsigned r)
+{
+    double sum = 0;
+    for (std::size_t i = counts.rowOffsets[r]; i < counts.rowOffsets[r + 1]; i++)
+        sum += counts.counts[i] * counts.counts[i];
+    return sum;
+}
@@ -0,0 +1,34 @@
+#ifndef WLKERNEL_HPP
+#define WLKERNEL_HPP
+
+#include <vector>
+#include <cstddef>
+#include <filesystem>
+#include <unordered_map>
+#include "SubgraphMaps.hpp"
+
+// Counts of rooted subgraphs of every graph (bag of subgraphs) in compressed sparse rows: row r
+// has subgraph IDs (in increasing order) and their counts from rowOffsets[r] to rowOffsets[r + 1]
+struct SubgraphCounts
+{
+    unsigned columns = 0; // Number of subgraph IDs
+    std::vector<std::size_t> rowOffsets;
+    std::vector<unsigned> subgraphs;
+    std::vector<double> counts;
+};
+
+void getSubgraphCounts(SubgraphCounts &, const std::vector<SubgraphMap> &, unsigned);
+
+void transposeSubgraphCounts(SubgraphCounts &, const SubgraphCounts &);
+
+bool writeLibSVM(const std::filesystem::path &, const SubgraphCounts &);
+
+void getKernelBlock(std::vector<double> &, const SubgraphCounts &, const SubgraphCounts &, unsigned, unsigned, bool, unsigned);
+
+bool writeKernelMatrix(const std::filesystem::path &, const SubgraphCounts &, bool, unsigned, unsigned = 256);
+
+void getGraphSignature(std::vector<unsigned> &, const SubgraphMap &, unsigned);
+
+unsigned groupEquivalentGraphs(std::vector<unsigned> &, const std::vector<SubgraphMap> &, unsigned);
+
+#endif
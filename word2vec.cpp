@@ -1,60 +1,90 @@
-#include <iostream>
-#include <fstream>
 #include <vector>
-#include <string>
+#include <map>
 #include <random>
 #include <cmath>
 #include <utility>
 #include <set>
-#include <filesystem>
-#include <json/json.h>
+#include <queue>
+#include <cstring>
+#include <algorithm>
+#include <functional>
 #include "word2vec.hpp"
-#include "Graph.hpp"
 #include "SubgraphMaps.hpp"
+#include "Kernels.hpp"
 
 void forwardPropagation(const std::vector<unsigned> &, const std::vector<std::pair<std::vector<double>, unsigned>> &,
-                        const std::vector<std::vector<double>> &, std::vector<std::vector<double>> &, std::string);
+                        const std::vector<std::vector<double>> &, std::vector<std::vector<double>> &, std::vector<std::vector<double>> &, ExpMethod);
 
 void transpose(std::vector<std::vector<double>> &);
 
-void transpose(std::string, unsigned, unsigned);
+void matMul(std::vector<std::vector<double>> &, const std::vector<std::vector<double>> &, const std::vector<std::vector<double>> &);
 
-void matMul(std::string, const std::vector<std::vector<double>> &, const std::vector<std::vector<double>> &);
+void softmax(std::vector<std::vector<double>> &, ExpMethod);
 
-void matMul(std::string, std::string, unsigned, const std::vector<std::vector<double>> &);
+void backwardPropagation(std::vector<std::vector<double>> &, std::vector<std::vector<double>> &, std::vector<std::vector<double>> &, const std::vector<unsigned> &,
+                         const std::vector<std::vector<double>> &, const std::vector<std::vector<double>> &, const std::vector<std::vector<double>> &);
 
-void matMul(std::string, const std::vector<std::vector<double>> &, std::string, unsigned);
+unsigned getWordIndex(std::map<unsigned, unsigned> &, std::vector<std::pair<std::vector<double>, unsigned>> &, const std::vector<std::vector<double>> &, unsigned);
 
-void softmax(std::string, unsigned, unsigned);
+void trainHierarchicalSoftmax(std::vector<std::pair<std::vector<double>, unsigned>> &, const std::vector<unsigned> &, const std::vector<unsigned> &,
+                              unsigned, unsigned, double, ExpMethod);
 
-void backwardPropagation(std::string, std::string, std::string, const std::vector<unsigned> &,
-                         std::string, const std::vector<std::vector<double>> &, const std::vector<std::vector<double>> &);
+void getHuffmanPaths(const std::vector<unsigned> &, std::vector<std::vector<unsigned>> &, std::vector<std::vector<char>> &);
 
-void word2vec(Json::Value & subgraphs, RadialContext & context, const Graph & graph, unsigned degree, unsigned dimensions, unsigned epochs, double alpha, unsigned minID)
+double sigmoid(double, ExpMethod);
+
+const char * objectiveNames[] = {"softmax", "hs"};
+
+bool parseWord2VecObjective(Word2VecObjective & objective, const char * name)
 {
+    for (unsigned i = 0; i < sizeof(objectiveNames) / sizeof(objectiveNames[0]); i++)
+    {
+        if (std::strcmp(name, objectiveNames[i]) == 0)
+        {
+            objective = (Word2VecObjective) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char * getWord2VecObjectiveName(Word2VecObjective objective)
+{
+    return objectiveNames[objective];
+}
+
+// Train vector representations of the given subgraphs (words) on pairs of every word and
+// subgraphs of its radial context
+void word2vec(std::vector<std::vector<double>> & subgraphsEmbeddings, const std::vector<unsigned> & words, const RadialContext & context,
+              unsigned dimensions, unsigned epochs, double alpha, std::mt19937 & generator, Word2VecObjective objective,
+              ExpMethod method)
+{
+    // Subgraph IDs are unique in the whole vocabulary (for all graphs in dataset), but in word2vec
+    // we need word IDs from 0, so every subgraph gets its index in the vocabulary of this call
+    std::map<unsigned, unsigned> wordIndexes;
     std::vector<unsigned> X, Y;
     std::vector<std::pair<std::vector<double>, unsigned>> wordEmbeddings;
-    for (unsigned i = 0; i < graph.getMaxVertex(); i++)
+    for (unsigned i = 0; i < words.size(); i++)
     {
-        if (graph.getVertex(i) != nullptr)
+        unsigned wordIndex = getWordIndex(wordIndexes, wordEmbeddings, subgraphsEmbeddings, words[i]);
+        RadialContext::const_iterator wordContext = context.find(words[i]);
+        if (wordContext == context.cend())
+            continue;
+        for (std::multiset<unsigned>::const_iterator it = wordContext->second.cbegin(); it != wordContext->second.cend(); it++)
         {
-            for (unsigned j = 0; j <= degree; j++)
-            {
-                unsigned wordID = subgraphs["rootVertices"][i]["degrees"][j]["subgraphID"].asUInt();
-                for (std::multiset<unsigned>::iterator it = context[wordID].cbegin(); it != context[wordID].cend(); it++)
-                {
-                    X.push_back(wordID - minID);
-                    Y.push_back(*it - minID);
-                }
-                std::pair<std::vector<double>, unsigned> temp;
-                for (unsigned k = 0; k < dimensions; k++)
-                    temp.first.push_back(subgraphs["rootVertices"][i]["degrees"][j]["subgraphEmbedding"][k].asDouble());
-                temp.second = wordID;
-                wordEmbeddings.push_back(temp);
-            }
+            X.push_back(wordIndex);
+            Y.push_back(getWordIndex(wordIndexes, wordEmbeddings, subgraphsEmbeddings, *it));
         }
     }
-    std::random_device dev;
+    if (X.empty())
+        return;
+    if (objective == hierarchicalSoftmax)
+    {
+        trainHierarchicalSoftmax(wordEmbeddings, X, Y, dimensions, epochs, alpha, method);
+        for (unsigned i = 0; i < wordEmbeddings.size(); i++)
+            subgraphsEmbeddings[wordEmbeddings[i].second] = wordEmbeddings[i].first;
+        return;
+    }
     std::uniform_real_distribution<double> unidist(-1.0L, 1.0L);
     std::vector<std::vector<double>> denseLayerMatrix;
     for (unsigned i = 0; i < wordEmbeddings.size(); i++)
@@ -62,78 +92,139 @@ void word2vec(Json::Value & subgraphs, RadialContext & context, const Graph & gr
         denseLayerMatrix.push_back(std::vector<double>());
         for (unsigned j = 0; j < dimensions; j++)
         {
-            denseLayerMatrix[i].push_back(unidist(dev));
+            denseLayerMatrix[i].push_back(unidist(generator));
         }
     }
-    std::string softmaxOutput = "softmax.dat", dL_dZ = "dL_dZ.dat", dL_dDenseLayerMatrix = "dL_dDenseLayerMatrix.dat", dL_dWordVector = "dL_dWordVector.dat";
+    std::vector<std::vector<double>> softmaxOutput, dL_dZ, dL_dDenseLayerMatrix, dL_dWordVector;
+    const Kernels & kernels = getKernels(dimensions);
     for (unsigned e = 0; e < epochs; e++)
     {
-        std::cout << "\tword2vec: epoch number " << e << std::endl;
         std::vector<std::vector<double>> wordVector;
-        forwardPropagation(X, wordEmbeddings, denseLayerMatrix, wordVector, softmaxOutput);
+        forwardPropagation(X, wordEmbeddings, denseLayerMatrix, wordVector, softmaxOutput, method);
         backwardPropagation(dL_dZ, dL_dDenseLayerMatrix, dL_dWordVector, Y, softmaxOutput, denseLayerMatrix, wordVector);
-        transpose(dL_dWordVector, denseLayerMatrix[0].size(), wordVector[0].size());
-        double currentValue;
-        std::ifstream dL_dWordVectorFile(dL_dWordVector, std::ios::binary);
+        transpose(dL_dWordVector);
         for (unsigned i = 0; i < X.size(); i++)
-        {
-            for (unsigned j = 0; j < wordEmbeddings[0].first.size(); j++)
-            {
-                dL_dWordVectorFile.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-                wordEmbeddings[X[i]].first[j] -= alpha * currentValue;
-            }
-        }
-        dL_dWordVectorFile.close();
-        std::ifstream dL_dDenseLayerMatrixFile(dL_dDenseLayerMatrix, std::ios::binary);
+            kernels.axpy(-alpha, dL_dWordVector[i].data(), wordEmbeddings[X[i]].first.data(), dimensions);
         for (unsigned i = 0; i < denseLayerMatrix.size(); i++)
-        {
-            for (unsigned j = 0; j < denseLayerMatrix[0].size(); j++)
-            {
-                dL_dDenseLayerMatrixFile.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-                denseLayerMatrix[i][j] -= alpha * currentValue;
-            }
-        }
-        dL_dDenseLayerMatrixFile.close();
+            kernels.axpy(-alpha, dL_dDenseLayerMatrix[i].data(), denseLayerMatrix[i].data(), dimensions);
     }
-    std::filesystem::remove(std::filesystem::path(softmaxOutput));
-    std::filesystem::remove(std::filesystem::path(dL_dZ));
-    std::filesystem::remove(std::filesystem::path(dL_dDenseLayerMatrix));
-    std::filesystem::remove(std::filesystem::path(dL_dWordVector));
     for (unsigned i = 0; i < wordEmbeddings.size(); i++)
+        subgraphsEmbeddings[wordEmbeddings[i].second] = wordEmbeddings[i].first;
+}
+
+// Stochastic gradient descent pair by pair in the order of the pairs, so training is deterministic.
+// Huffman tree is made of the words of the call, which are in context, by their counts in the pairs,
+// vectors of its inner nodes start at zero and are only of this call, as the dense layer of softmax
+void trainHierarchicalSoftmax(std::vector<std::pair<std::vector<double>, unsigned>> & wordEmbeddings, const std::vector<unsigned> & X,
+                              const std::vector<unsigned> & Y, unsigned dimensions, unsigned epochs, double alpha, ExpMethod method)
+{
+    std::vector<unsigned> leaves(wordEmbeddings.size(), 0), counts;
+    for (unsigned i = 0; i < Y.size(); i++)
+        leaves[Y[i]]++;
+    for (unsigned i = 0; i < leaves.size(); i++)
     {
-        unsigned wordID = wordEmbeddings[i].second;
-        unsigned j, k;
-        bool found = false;
-        for (j = 0; j < subgraphs["rootVertices"].size(); j++)
+        if (leaves[i] == 0)
+            continue;
+        counts.push_back(leaves[i]);
+        leaves[i] = counts.size() - 1;
+    }
+    std::vector<std::vector<unsigned>> points;
+    std::vector<std::vector<char>> codes;
+    getHuffmanPaths(counts, points, codes);
+    if (counts.size() < 2)
+        return;
+    std::vector<std::vector<double>> innerVectors(counts.size() - 1, std::vector<double>(dimensions, 0.0));
+    std::vector<double> error(dimensions);
+    const Kernels & kernels = getKernels(dimensions);
+    for (unsigned e = 0; e < epochs; e++)
+    {
+        for (unsigned i = 0; i < X.size(); i++)
         {
-            for (k = 0; k < subgraphs["rootVertices"][j]["degrees"].size(); k++)
+            double * word = wordEmbeddings[X[i]].first.data();
+            unsigned leaf = leaves[Y[i]];
+            std::fill(error.begin(), error.end(), 0.0);
+            for (unsigned k = 0; k < points[leaf].size(); k++)
             {
-                if (subgraphs["rootVertices"][j]["degrees"][k]["subgraphID"].asUInt() == wordID)
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (found)
-            {
-                break;
+                // Gradient of log likelihood of the branch taken at the inner node
+                double * inner = innerVectors[points[leaf][k]].data();
+                double g = (1.0 - codes[leaf][k] - sigmoid(kernels.dot(word, inner, dimensions), method)) * alpha;
+                kernels.axpy(g, inner, error.data(), dimensions);
+                kernels.axpy(g, word, inner, dimensions);
             }
+            kernels.axpy(1.0, error.data(), word, dimensions);
         }
-        for (unsigned l = 0; l < dimensions; l++)
+    }
+}
+
+// Huffman tree of words of the counts, inner node i is made by the i-th merge (root is the last one),
+// ties are merged in the order of nodes, so the tree is deterministic. Path of every word is the inner
+// nodes from the root down to it (points) and the branch taken at every one of them (codes)
+void getHuffmanPaths(const std::vector<unsigned> & counts, std::vector<std::vector<unsigned>> & points, std::vector<std::vector<char>> & codes)
+{
+    unsigned words = counts.size();
+    points.assign(words, std::vector<unsigned>());
+    codes.assign(words, std::vector<char>());
+    if (words < 2)
+        return;
+    // Nodes below words are the words, node words + i is inner node i
+    typedef std::pair<unsigned long long, unsigned> Node;
+    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+    std::vector<unsigned> parents(2 * words - 1);
+    std::vector<char> branches(2 * words - 1, 0);
+    for (unsigned i = 0; i < words; i++)
+        queue.emplace(counts[i], i);
+    for (unsigned node = words; node < 2 * words - 1; node++)
+    {
+        Node first = queue.top();
+        queue.pop();
+        Node second = queue.top();
+        queue.pop();
+        parents[first.second] = node;
+        parents[second.second] = node;
+        branches[second.second] = 1;
+        queue.emplace(first.first + second.first, node);
+    }
+    for (unsigned i = 0; i < words; i++)
+    {
+        for (unsigned node = i; node != 2 * words - 2; node = parents[node])
         {
-            subgraphs["rootVertices"][j]["degrees"][k]["subgraphEmbedding"][l] = wordEmbeddings[i].first[l];
+            points[i].push_back(parents[node] - words);
+            codes[i].push_back(branches[node]);
         }
+        std::reverse(points[i].begin(), points[i].end());
+        std::reverse(codes[i].begin(), codes[i].end());
     }
 }
 
+// Logistic function by exp of the method (Kernels.hpp), so it saturates below expCutoff
+double sigmoid(double x, ExpMethod method)
+{
+    double e = -std::fabs(x);
+    expNegative(&e, 1, method);
+    return x >= 0 ? 1.0 / (1.0 + e) : e / (1.0 + e);
+}
+
+unsigned getWordIndex(std::map<unsigned, unsigned> & wordIndexes, std::vector<std::pair<std::vector<double>, unsigned>> & wordEmbeddings,
+                      const std::vector<std::vector<double>> & subgraphsEmbeddings, unsigned wordID)
+{
+    std::map<unsigned, unsigned>::iterator it = wordIndexes.find(wordID);
+    if (it != wordIndexes.end())
+        return it->second;
+    unsigned wordIndex = wordEmbeddings.size();
+    wordIndexes[wordID] = wordIndex;
+    wordEmbeddings.push_back(std::make_pair(subgraphsEmbeddings[wordID], wordID));
+    return wordIndex;
+}
+
 void forwardPropagation(const std::vector<unsigned> & X, const std::vector<std::pair<std::vector<double>, unsigned>> & wordEmbeddings,
-                        const std::vector<std::vector<double>> & denseLayerMatrix, std::vector<std::vector<double>> & wordVector, std::string Z)
+                        const std::vector<std::vector<double>> & denseLayerMatrix, std::vector<std::vector<double>> & wordVector, std::vector<std::vector<double>> & Z,
+                        ExpMethod method)
 {
     for (unsigned i = 0; i < X.size(); i++)
         wordVector.push_back(wordEmbeddings[X[i]].first);
     transpose(wordVector);
     matMul(Z, denseLayerMatrix, wordVector);
-    softmax(Z, denseLayerMatrix.size(), wordVector[0].size());
+    softmax(Z, method);
 }
 
 void transpose(std::vector<std::vector<double>> & v)
@@ -150,184 +241,62 @@ void transpose(std::vector<std::vector<double>> & v)
     v = result;
 }
 
-void transpose(std::string v, unsigned rows, unsigned cols)
+void matMul(std::vector<std::vector<double>> & result, const std::vector<std::vector<double>> & m1, const std::vector<std::vector<double>> & m2)
 {
-    std::ifstream input(v, std::ios::binary);
-    std::vector<std::vector<double>> result;
-    double currentValue;
-    for (unsigned i = 0; i < cols; i++)
-    {
-        result.push_back(std::vector<double>());
-        for (unsigned j = 0; j < rows; j++)
-        {
-            input.seekg(j * cols * sizeof(double) + i * sizeof(double), std::ios::beg);
-            input.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            result[i].push_back(currentValue);
-        }
-    }
-    input.close();
-    std::ofstream output(v, std::ios::binary);
-    for (unsigned i = 0; i < cols; i++)
-    {
-        for (unsigned j = 0; j < rows; j++)
-        {
-            output.write(reinterpret_cast<char *>(&result[i][j]), sizeof(double));
-        }
-    }
-    output.close();
-}
-
-void matMul(std::string result, const std::vector<std::vector<double>> & m1, const std::vector<std::vector<double>> & m2)
-{
-    if (m1[0].size() != m2.size())
-        std::exit(EXIT_FAILURE);
-    double resultElement;
-    std::ofstream output(result, std::ios::binary);
+    const Kernels & kernels = getKernels();
+    result.assign(m1.size(), std::vector<double>(m2[0].size(), 0.0L));
     for (unsigned i = 0; i < m1.size(); i++)
     {
-        for (unsigned j = 0; j < m2[0].size(); j++)
-        {
-            resultElement = 0.0L;
-            for (unsigned k = 0; k < m2.size(); k++)
-                resultElement += m1[i][k] * m2[k][j];
-            output.write(reinterpret_cast<char *>(&resultElement), sizeof(resultElement));
-        }
+        for (unsigned k = 0; k < m2.size(); k++)
+            kernels.axpy(m1[i][k], m2[k].data(), result[i].data(), m2[0].size());
     }
-    output.close();
 }
 
-void matMul(std::string result, std::string m1, unsigned m1Rows, const std::vector<std::vector<double>> & m2)
+// Softmax of every column of the matrix. Maximum of columns is subtracted row by row, so that exp
+// is evaluated on contiguous rows (look to the expNegative in Kernels.hpp)
+void softmax(std::vector<std::vector<double>> & v, ExpMethod method)
 {
-    double resultElement, m1Element;
-    std::ifstream m1File(m1, std::ios::binary);
-    std::ofstream output(result, std::ios::binary);
-    for (unsigned i = 0; i < m1Rows; i++)
+    unsigned rows = v.size(), cols = v[0].size();
+    std::vector<double> maxima(v[0]), sums(cols, 0.0L);
+    for (unsigned j = 1; j < rows; j++)
     {
-        for (unsigned j = 0; j < m2[0].size(); j++)
+        for (unsigned i = 0; i < cols; i++)
         {
-            resultElement = 0.0L;
-            m1File.seekg(i * m2.size() * sizeof(double), std::ios::beg);
-            for (unsigned k = 0; k < m2.size(); k++)
-            {
-                m1File.read(reinterpret_cast<char *>(&m1Element), sizeof(double));
-                resultElement += m1Element * m2[k][j];
-            }
-            output.write(reinterpret_cast<char *>(&resultElement), sizeof(resultElement));
+            if (maxima[i] < v[j][i])
+                maxima[i] = v[j][i];
         }
     }
-    m1File.close();
-    output.close();
-}
-
-void matMul(std::string result, const std::vector<std::vector<double>> & m1, std::string m2, unsigned m2Cols)
-{
-    double resultElement, m2Element;
-    std::ifstream m2File(m2, std::ios::binary);
-    std::ofstream output(result, std::ios::binary);
-    for (unsigned i = 0; i < m1.size(); i++)
+    for (unsigned j = 0; j < rows; j++)
     {
-        for (unsigned j = 0; j < m2Cols; j++)
-        {
-            resultElement = 0.0L;
-            m2File.seekg(j * sizeof(double), std::ios::beg);
-            for (unsigned k = 0; k < m2.size(); k++)
-            {
-                m2File.read(reinterpret_cast<char *>(&m2Element), sizeof(double));
-                resultElement += m1[i][k] * m2Element;
-                m2File.seekg(m2Cols * sizeof(double));
-            }
-            output.write(reinterpret_cast<char *>(&resultElement), sizeof(resultElement));
-        }
+        for (unsigned i = 0; i < cols; i++)
+            v[j][i] -= maxima[i];
+        expNegative(v[j].data(), cols, method);
+        for (unsigned i = 0; i < cols; i++)
+            sums[i] += v[j][i];
     }
-    m2File.close();
-    output.close();
-}
-
-void softmax(std::string v, unsigned rows, unsigned cols)
-{
-    std::fstream file(v, std::ios::in | std::ios::ate | std::ios::binary);
-    double currentValue;
-    for (unsigned i = 0; i < cols; i++)
+    for (unsigned j = 0; j < rows; j++)
     {
-        file.seekg(i * sizeof(double), std::ios::beg);
-        file.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-        double param = currentValue;
-        for (unsigned j = 1; j < rows; j++)
-        {
-            file.seekg(j * cols * sizeof(double) + i * sizeof(double), std::ios::beg);
-            file.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            if (param < currentValue)
-            {
-                param = currentValue;
-            }
-        }
-        double sum = 0.0L;
-        for (unsigned j = 0; j < rows; j++)
-        {
-            file.seekg(j * cols * sizeof(double) + i * sizeof(double), std::ios::beg);
-            file.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            if (currentValue - param < -7.0L)
-            {
-                continue;
-            }
-            else
-            {
-                sum += std::exp(currentValue - param);
-            }
-        }
-        for (unsigned j = 0; j < rows; j++)
-        {
-            file.seekg(j * cols * sizeof(double) + i * sizeof(double), std::ios::beg);
-            file.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            file.seekp(j * cols * sizeof(double) + i * sizeof(double), std::ios::beg);
-            if (currentValue - param < -7.0L)
-            {
-                currentValue = 0.0L;
-                file.write(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            }
-            else
-            {
-                currentValue = std::exp(currentValue - param) / sum;
-                file.write(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            }
-        }
+        for (unsigned i = 0; i < cols; i++)
+            v[j][i] /= sums[i];
     }
-    file.close();
 }
 
-void backwardPropagation(std::string dL_dZ, std::string dL_dDenseLayerMatrix, std::string dL_dWordVector,
-                         const std::vector<unsigned> & Y, std::string softmaxOutput, const std::vector<std::vector<double>> & denseLayerMatrix,
+void backwardPropagation(std::vector<std::vector<double>> & dL_dZ, std::vector<std::vector<double>> & dL_dDenseLayerMatrix, std::vector<std::vector<double>> & dL_dWordVector,
+                         const std::vector<unsigned> & Y, const std::vector<std::vector<double>> & softmaxOutput, const std::vector<std::vector<double>> & denseLayerMatrix,
                          const std::vector<std::vector<double>> & wordVector)
 {
-    std::fstream softmaxFile(softmaxOutput, std::ios::in | std::ios::binary);
-    std::fstream dL_dZFile(dL_dZ, std::ios::ate | std::ios::binary);
-    double currentValue;
-    for (unsigned i = 0; i < denseLayerMatrix.size(); i++)
-    {
-        for (unsigned j = 0; j < wordVector[0].size(); j++)
-        {
-            softmaxFile.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            currentValue -= Y[j];
-            dL_dZFile.write(reinterpret_cast<char *>(&currentValue), sizeof(double));
-        }
-    }
-    softmaxFile.close();
-    dL_dZFile.close();
+    // Derivative of cross entropy loss with respect to the softmax input, expected outputs are one-hot vectors,
+    // so it's softmax - onehot(Y[j]) for every pair j
+    dL_dZ = softmaxOutput;
+    for (unsigned j = 0; j < wordVector[0].size(); j++)
+        dL_dZ[Y[j]][j] -= 1.0L;
     std::vector<std::vector<double>> tempWordVector = wordVector;
     transpose(tempWordVector);
-    matMul(dL_dDenseLayerMatrix, dL_dZ, denseLayerMatrix.size(), tempWordVector);
-    std::fstream dL_dDenseLayerMatrixFile(dL_dDenseLayerMatrix, std::ios::in | std::ios::ate | std::ios::binary);
+    matMul(dL_dDenseLayerMatrix, dL_dZ, tempWordVector);
+    const Kernels & kernels = getKernels(tempWordVector[0].size());
     for (unsigned i = 0; i < denseLayerMatrix.size(); i++)
-    {
-        for (unsigned j = 0; j < tempWordVector[0].size(); j++)
-        {
-            dL_dDenseLayerMatrixFile.read(reinterpret_cast<char *>(&currentValue), sizeof(double));
-            currentValue *= 1.0L / tempWordVector.size();
-            dL_dDenseLayerMatrixFile.write(reinterpret_cast<char *>(&currentValue), sizeof(double));
-        }
-    }
-    dL_dDenseLayerMatrixFile.close();
+        kernels.scaledAdd(1.0L / tempWordVector.size(), dL_dDenseLayerMatrix[i].data(), 0.0L, dL_dDenseLayerMatrix[i].data(), tempWordVector[0].size());
     std::vector<std::vector<double>> tempDenseLayerMatrix = denseLayerMatrix;
     transpose(tempDenseLayerMatrix);
-    matMul(dL_dWordVector, tempDenseLayerMatrix, dL_dZ, wordVector[0].size());
+    matMul(dL_dWordVector, tempDenseLayerMatrix, dL_dZ);
 }
@@ -2,10 +2,24 @@
 #define WORD2VEC_HPP
 
 #include <vector>
-#include <json/json.h>
-#include "Graph.hpp"
+#include <random>
 #include "SubgraphMaps.hpp"
+#include "Kernels.hpp"
 
-void word2vec(Json::Value &, RadialContext &, const Graph &, unsigned, unsigned, unsigned, double, unsigned);
+// Output layer of word2vec: softmax over the whole vocabulary of the call, or hierarchical softmax
+// over a Huffman tree of the counts of words in the radial context (cost of a pair is the length of
+// the path of its context word, about log of the vocabulary, and no samples are drawn)
+enum Word2VecObjective
+{
+    fullSoftmax,
+    hierarchicalSoftmax
+};
+
+bool parseWord2VecObjective(Word2VecObjective &, const char *);
+
+const char * getWord2VecObjectiveName(Word2VecObjective);
+
+void word2vec(std::vector<std::vector<double>> &, const std::vector<unsigned> &, const RadialContext &, unsigned, unsigned, double, std::mt19937 &,
+              Word2VecObjective = fullSoftmax, ExpMethod = exactExp);
 
 #endif